@@ -36,6 +36,34 @@ popd >/dev/null
 
 popd >/dev/null
 
+# ==============================================================================
+# -- Get and compile Google Benchmark ------------------------------------------
+# ==============================================================================
+
+# Get benchmark source
+if [[ ! -d "benchmark-source" ]]; then
+  echo "Retrieving benchmark..."
+  git clone --depth=1 -b v1.2.0 https://github.com/google/benchmark.git benchmark-source
+else
+  echo "Folder benchmark-source already exists, skipping git clone..."
+fi
+
+pushd benchmark-source >/dev/null
+
+cmake -H. -B./build \
+    -DCMAKE_C_COMPILER=${C_COMPILER} -DCMAKE_CXX_COMPILER=${COMPILER} \
+    -DCMAKE_BUILD_TYPE=Release \
+    -DBENCHMARK_ENABLE_TESTING=OFF \
+    -DCMAKE_INSTALL_PREFIX="../benchmark-install" \
+    -G "Ninja"
+
+pushd build >/dev/null
+ninja
+ninja install
+popd >/dev/null
+
+popd >/dev/null
+
 # ==============================================================================
 # -- ...and we are done --------------------------------------------------------
 # ==============================================================================
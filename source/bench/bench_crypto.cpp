@@ -0,0 +1,171 @@
+#include "crypto/chunker.h"
+#include "crypto/crypto.h"
+#include "crypto/output.h"
+#include "crypto/password_digest.h"
+#include "crypto/random.h"
+#include "crypto/secure_string.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+static std::vector<crypto::byte> make_data(std::size_t size) {
+  std::vector<crypto::byte> data(size);
+  for (auto i = 0u; i < size; ++i) {
+    data[i] = static_cast<crypto::byte>(i * 131u + 7u);
+  }
+  return data;
+}
+
+// -- Digests ------------------------------------------------------------------
+
+template <typename DIGEST>
+static void crypto_digest(benchmark::State &state) {
+  const auto data = make_data(static_cast<std::size_t>(state.range(0)));
+  DIGEST digest;
+  while (state.KeepRunning()) {
+    crypto::digest(crypto::buffer_view::make_const(data), digest);
+    benchmark::DoNotOptimize(digest.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(crypto_digest, crypto::sha256_digest)
+    ->RangeMultiplier(64)->Range(16, 1 << 30)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(crypto_digest, crypto::sha512_digest)
+    ->RangeMultiplier(64)->Range(16, 1 << 30)->Unit(benchmark::kMicrosecond);
+
+// -- Encoding -----------------------------------------------------------------
+
+static void crypto_to_hex_string(benchmark::State &state) {
+  const auto data = make_data(static_cast<std::size_t>(state.range(0)));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(crypto::to_hex_string(crypto::buffer_view::make_const(data)));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(crypto_to_hex_string)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+// -- Zeroize ------------------------------------------------------------------
+
+static void crypto_zeroize(benchmark::State &state) {
+  auto data = make_data(static_cast<std::size_t>(state.range(0)));
+  while (state.KeepRunning()) {
+    crypto::zeroize(crypto::buffer_view::make_mutable(data));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(crypto_zeroize)->RangeMultiplier(16)->Range(16, 1 << 24);
+
+// -- Secure string ------------------------------------------------------------
+
+static void crypto_secure_string_make(benchmark::State &state) {
+  const std::string text(static_cast<std::size_t>(state.range(0)), 'x');
+  while (state.KeepRunning()) {
+    auto string = crypto::secure_string::unsafe_make(text);
+    benchmark::DoNotOptimize(string.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(crypto_secure_string_make)->Arg(16)->Arg(256)->Arg(4096);
+
+static void crypto_secure_string_clean_buffer_and_make(benchmark::State &state) {
+  std::string text(static_cast<std::size_t>(state.range(0)), 'x');
+  while (state.KeepRunning()) {
+    auto string = crypto::secure_string::clean_buffer_and_make(crypto::buffer_view::make_mutable(text));
+    benchmark::DoNotOptimize(string.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(crypto_secure_string_clean_buffer_and_make)->Arg(16)->Arg(256)->Arg(4096);
+
+static void crypto_secure_string_concat(benchmark::State &state) {
+  const std::string text(static_cast<std::size_t>(state.range(0)), 'x');
+  const auto lhs = crypto::secure_string::unsafe_make(text);
+  const auto rhs = crypto::secure_string::unsafe_make(text);
+  while (state.KeepRunning()) {
+    auto string = lhs + rhs;
+    benchmark::DoNotOptimize(string.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(crypto_secure_string_concat)->Arg(16)->Arg(256)->Arg(4096);
+
+// -- Password digest ----------------------------------------------------------
+
+template <typename DIGEST>
+static void crypto_password_digest_compare(benchmark::State &state) {
+  const auto password = crypto::secure_string::unsafe_make("correct horse battery staple");
+  const auto other = crypto::secure_string::unsafe_make("correct horse battery stapler");
+  const crypto::password_digest<DIGEST> digest(password);
+  const crypto::password_digest<DIGEST> other_digest(other);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(digest == other_digest);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(crypto_password_digest_compare, crypto::sha256_digest);
+BENCHMARK_TEMPLATE(crypto_password_digest_compare, crypto::sha512_digest);
+
+/// Compares against a plain password, which digests it first.
+template <typename DIGEST>
+static void crypto_password_digest_check(benchmark::State &state) {
+  const auto password = crypto::secure_string::unsafe_make("correct horse battery staple");
+  const crypto::password_digest<DIGEST> digest(password);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(digest == password);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(crypto_password_digest_check, crypto::sha256_digest);
+BENCHMARK_TEMPLATE(crypto_password_digest_check, crypto::sha512_digest);
+
+// -- Chunking -----------------------------------------------------------------
+
+static std::vector<crypto::byte> make_random_data(std::size_t size) {
+  crypto::xoshiro256starstar rng(42u);
+  std::vector<crypto::byte> data(size);
+  rng.uniform_n(crypto::array_view::make_mutable(data), crypto::byte(0u), crypto::byte(255u));
+  return data;
+}
+
+static void crypto_chunker(benchmark::State &state) {
+  const auto data = make_random_data(64u << 20);
+  const crypto::chunker chunker;
+  const auto threads = static_cast<unsigned>(state.range(0));
+  while (state.KeepRunning()) {
+    auto chunks = chunker(crypto::buffer_view::make_const(data), threads);
+    benchmark::DoNotOptimize(chunks.data());
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+}
+
+BENCHMARK(crypto_chunker)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void crypto_chunk_stream(benchmark::State &state) {
+  const auto data = make_random_data(64u << 20);
+  const auto piece = static_cast<std::size_t>(state.range(0));
+  std::vector<crypto::chunk> chunks;
+  while (state.KeepRunning()) {
+    crypto::chunk_stream stream;
+    chunks.clear();
+    for (std::size_t position = 0u; position < data.size(); position += piece) {
+      stream.update(crypto::buffer_view::make_const(data.data() + position, piece), chunks);
+    }
+    stream.finish(chunks);
+    benchmark::DoNotOptimize(chunks.data());
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(data.size()));
+}
+
+BENCHMARK(crypto_chunk_stream)->Arg(4096)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,159 @@
+#include "crypto/random.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <forward_list>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// Every distribution and sampling utility of random_engine_adaptor on every
+// engine of test_random.cpp, registered at startup as
+// "distribution_<name><engine>".
+
+template <typename ENGINE, typename SAMPLE>
+static void register_distribution(const std::string &engine, const std::string &name, SAMPLE sample) {
+  const auto full_name = "distribution_" + name + "<" + engine + ">";
+  benchmark::RegisterBenchmark(full_name.c_str(), [sample](benchmark::State &state) {
+    ENGINE rng;
+    double sum = 0.0;
+    while (state.KeepRunning()) {
+      sum += static_cast<double>(sample(rng));
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+  });
+}
+
+/// Batch version, @a fill processes a vector of state.range(0) elements per
+/// iteration, initialized to 0, 1, 2...
+template <typename ENGINE, typename T, typename FILL>
+static void register_batch(const std::string &engine, const std::string &name, FILL fill) {
+  const auto full_name = "distribution_" + name + "<" + engine + ">";
+  benchmark::RegisterBenchmark(full_name.c_str(), [fill](benchmark::State &state) {
+    ENGINE rng;
+    std::vector<T> values(static_cast<std::size_t>(state.range(0)));
+    std::iota(values.begin(), values.end(), T(0));
+    while (state.KeepRunning()) {
+      fill(rng, values);
+      benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  })->Arg(4096);
+}
+
+template <typename ENGINE>
+static void register_distributions(const std::string &engine) {
+  static const std::vector<double> weights = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0};
+  static const std::vector<double> intervals = {0.0, 1.0, 2.0, 4.0, 8.0, 16.0, 32.0, 64.0, 128.0};
+  static const std::vector<double> population = []() {
+    std::vector<double> result(4096u);
+    std::iota(result.begin(), result.end(), 0.0);
+    return result;
+  }();
+  static const std::forward_list<double> population_list(population.begin(), population.end());
+
+  // -- Uniform ----------------------------------------------------------------
+  register_distribution<ENGINE>(engine, "uniform_int", [](ENGINE &rng) { return rng.template uniform<int>(0, 999); });
+  register_distribution<ENGINE>(engine, "uniform_double", [](ENGINE &rng) { return rng.template uniform<double>(); });
+  register_distribution<ENGINE>(engine, "fast_uniform_int", [](ENGINE &rng) { return rng.template fast_uniform<int>(0, 999); });
+  register_distribution<ENGINE>(engine, "fast_uniform_double", [](ENGINE &rng) { return rng.template fast_uniform<double>(); });
+  register_distribution<ENGINE>(engine, "uniform_bool", [](ENGINE &rng) { return rng.uniform_bool(); });
+  register_distribution<ENGINE>(engine, "uniform_bool_weighted", [](ENGINE &rng) { return rng.uniform_bool(0.3); });
+  register_batch<ENGINE, int>(engine, "uniform_n_int", [](ENGINE &rng, std::vector<int> &values) {
+    rng.uniform_n(crypto::array_view::make_mutable(values), 0, 999);
+  });
+  register_batch<ENGINE, double>(engine, "uniform_n_double", [](ENGINE &rng, std::vector<double> &values) {
+    rng.uniform_n(crypto::array_view::make_mutable(values));
+  });
+
+  // -- Bernoulli --------------------------------------------------------------
+  register_distribution<ENGINE>(engine, "bernoulli", [](ENGINE &rng) { return rng.bernoulli(0.3); });
+  register_distribution<ENGINE>(engine, "binomial", [](ENGINE &rng) { return rng.binomial(100, 0.3); });
+  register_distribution<ENGINE>(engine, "negative_binomial", [](ENGINE &rng) { return rng.negative_binomial(5, 0.3); });
+  register_distribution<ENGINE>(engine, "geometric", [](ENGINE &rng) { return rng.geometric(0.3); });
+
+  // -- Poisson ----------------------------------------------------------------
+  register_distribution<ENGINE>(engine, "poisson", [](ENGINE &rng) { return rng.poisson(40.0); });
+  register_distribution<ENGINE>(engine, "exponential", [](ENGINE &rng) { return rng.exponential(2.0); });
+  register_distribution<ENGINE>(engine, "gamma", [](ENGINE &rng) { return rng.gamma(3.0, 1.0); });
+  register_distribution<ENGINE>(engine, "weibull", [](ENGINE &rng) { return rng.weibull(2.0, 1.0); });
+  register_distribution<ENGINE>(engine, "extreme_value", [](ENGINE &rng) { return rng.extreme_value(0.0, 1.0); });
+  register_batch<ENGINE, double>(engine, "exponential_n", [](ENGINE &rng, std::vector<double> &values) {
+    rng.exponential_n(crypto::array_view::make_mutable(values), 2.0);
+  });
+
+  // -- Normal -----------------------------------------------------------------
+  register_distribution<ENGINE>(engine, "normal", [](ENGINE &rng) { return rng.normal(0.0, 1.0); });
+  register_distribution<ENGINE>(engine, "lognormal", [](ENGINE &rng) { return rng.lognormal(0.0, 1.0); });
+  register_distribution<ENGINE>(engine, "chi_squared", [](ENGINE &rng) { return rng.chi_squared(4.0); });
+  register_distribution<ENGINE>(engine, "cauchy", [](ENGINE &rng) { return rng.cauchy(0.0, 1.0); });
+  register_distribution<ENGINE>(engine, "fisher_f", [](ENGINE &rng) { return rng.fisher_f(3.0, 5.0); });
+  register_distribution<ENGINE>(engine, "student_t", [](ENGINE &rng) { return rng.student_t(5.0); });
+  register_batch<ENGINE, double>(engine, "normal_n", [](ENGINE &rng, std::vector<double> &values) {
+    rng.normal_n(crypto::array_view::make_mutable(values), 0.0, 1.0);
+  });
+
+  // -- Sampling ---------------------------------------------------------------
+  register_distribution<ENGINE>(engine, "discrete", [](ENGINE &rng) {
+    return rng.discrete(weights.begin(), weights.end());
+  });
+  register_distribution<ENGINE>(engine, "piecewise_constant", [](ENGINE &rng) {
+    return rng.piecewise_constant(intervals.begin(), intervals.end(), weights.begin());
+  });
+  register_distribution<ENGINE>(engine, "piecewise_linear", [](ENGINE &rng) {
+    return rng.piecewise_linear(intervals.begin(), intervals.end(), intervals.begin());
+  });
+  register_distribution<ENGINE>(engine, "inverse_cdf_normal", [](ENGINE &rng) {
+    return rng.inverse_cdf(crypto::normal_quantile);
+  });
+  register_batch<ENGINE, double>(engine, "inverse_cdf_normal_n", [](ENGINE &rng, std::vector<double> &values) {
+    rng.inverse_cdf_n(crypto::array_view::make_mutable(values), crypto::normal_quantile);
+  });
+
+  // -- Containers -------------------------------------------------------------
+  register_distribution<ENGINE>(engine, "choice", [](ENGINE &rng) { return rng.choice(population); });
+  register_distribution<ENGINE>(engine, "choice_forward", [](ENGINE &rng) { return rng.choice(population_list); });
+  register_batch<ENGINE, double>(engine, "shuffle", [](ENGINE &rng, std::vector<double> &values) {
+    rng.shuffle(values);
+  });
+  register_batch<ENGINE, double>(engine, "parallel_shuffle", [](ENGINE &rng, std::vector<double> &values) {
+    rng.parallel_shuffle(values, 2u);
+  });
+  register_batch<ENGINE, double>(engine, "sample", [](ENGINE &rng, std::vector<double> &values) {
+    benchmark::DoNotOptimize(rng.sample(64u, values));
+  });
+  register_batch<ENGINE, double>(engine, "reservoir_sample", [](ENGINE &rng, std::vector<double> &values) {
+    benchmark::DoNotOptimize(rng.reservoir_sample(values, 64u));
+  });
+  register_batch<ENGINE, double>(engine, "weighted_reservoir_sample", [](ENGINE &rng, std::vector<double> &values) {
+    benchmark::DoNotOptimize(rng.weighted_reservoir_sample(values.begin(), values.end(), population.begin(), 64u));
+  });
+  register_batch<ENGINE, std::uint64_t>(engine, "random_permutation", [](ENGINE &rng, std::vector<std::uint64_t> &values) {
+    rng.permutation(values.size()).evaluate(0u, crypto::array_view::make_mutable(values));
+  });
+}
+
+static const bool distributions_registered = []() {
+  register_distributions<crypto::default_random_engine>("crypto::default_random_engine");
+  register_distributions<crypto::mt19937>("crypto::mt19937");
+  register_distributions<crypto::xoshiro256starstar>("crypto::xoshiro256starstar");
+  register_distributions<crypto::xoroshiro128plus>("crypto::xoroshiro128plus");
+  register_distributions<crypto::pcg64>("crypto::pcg64");
+  register_distributions<crypto::chacha8>("crypto::chacha8");
+  register_distributions<crypto::chacha12>("crypto::chacha12");
+  register_distributions<crypto::chacha20>("crypto::chacha20");
+  register_distributions<crypto::random_engine_adaptor<std::default_random_engine>>("std::default_random_engine");
+  register_distributions<crypto::random_engine_adaptor<std::minstd_rand0>>("std::minstd_rand0");
+  register_distributions<crypto::random_engine_adaptor<std::minstd_rand>>("std::minstd_rand");
+  register_distributions<crypto::random_engine_adaptor<std::mt19937>>("std::mt19937");
+  register_distributions<crypto::random_engine_adaptor<std::mt19937_64>>("std::mt19937_64");
+  register_distributions<crypto::random_engine_adaptor<std::ranlux24_base>>("std::ranlux24_base");
+  register_distributions<crypto::random_engine_adaptor<std::ranlux48_base>>("std::ranlux48_base");
+  register_distributions<crypto::random_engine_adaptor<std::ranlux24>>("std::ranlux24");
+  register_distributions<crypto::random_engine_adaptor<std::ranlux48>>("std::ranlux48");
+  register_distributions<crypto::random_engine_adaptor<std::knuth_b>>("std::knuth_b");
+  return true;
+}();
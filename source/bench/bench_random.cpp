@@ -0,0 +1,702 @@
+#include "crypto/random.h"
+#include "crypto/token_generator.h"
+
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// -- Raw engine output --------------------------------------------------------
+
+template <typename ENGINE>
+static void random_engine(benchmark::State &state) {
+  ENGINE engine;
+  typename ENGINE::result_type sum = 0u;
+  while (state.KeepRunning()) {
+    sum += engine();
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * sizeof(typename ENGINE::result_type));
+}
+
+BENCHMARK_TEMPLATE(random_engine, std::default_random_engine);
+BENCHMARK_TEMPLATE(random_engine, std::mt19937);
+BENCHMARK_TEMPLATE(random_engine, std::mt19937_64);
+BENCHMARK_TEMPLATE(random_engine, crypto::default_random_engine);
+BENCHMARK_TEMPLATE(random_engine, crypto::mt19937);
+BENCHMARK_TEMPLATE(random_engine, crypto::xoshiro256starstar);
+BENCHMARK_TEMPLATE(random_engine, crypto::xoroshiro128plus);
+BENCHMARK_TEMPLATE(random_engine, crypto::pcg64);
+BENCHMARK_TEMPLATE(random_engine, crypto::chacha8);
+BENCHMARK_TEMPLATE(random_engine, crypto::chacha12);
+BENCHMARK_TEMPLATE(random_engine, crypto::chacha20);
+BENCHMARK_TEMPLATE(random_engine, crypto::philox4x32);
+BENCHMARK_TEMPLATE(random_engine, crypto::threefry4x64);
+BENCHMARK_TEMPLATE(random_engine, crypto::sfmt19937_engine);
+BENCHMARK_TEMPLATE(random_engine, crypto::dsfmt19937_engine);
+BENCHMARK_TEMPLATE(random_engine, crypto::sfmt19937);
+
+// -- Mersenne Twister family --------------------------------------------------
+
+template <typename ENGINE>
+static void random_mt_words(benchmark::State &state) {
+  ENGINE engine;
+  std::vector<typename ENGINE::result_type> values(4096u);
+  while (state.KeepRunning()) {
+    for (auto &value : values)
+      value = engine();
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetBytesProcessed(state.iterations() * values.size() * sizeof(values[0u]));
+}
+
+BENCHMARK_TEMPLATE(random_mt_words, std::mt19937);
+BENCHMARK_TEMPLATE(random_mt_words, std::mt19937_64);
+
+static void random_sfmt_generate(benchmark::State &state) {
+  crypto::sfmt19937_engine engine;
+  std::vector<std::uint32_t> values(4096u);
+  while (state.KeepRunning()) {
+    engine.generate(values.data(), values.data() + values.size());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetBytesProcessed(state.iterations() * values.size() * sizeof(values[0u]));
+}
+
+BENCHMARK(random_sfmt_generate);
+
+static void random_mt_doubles(benchmark::State &state) {
+  std::mt19937_64 engine;
+  std::uniform_real_distribution<double> dist;
+  std::vector<double> values(4096u);
+  while (state.KeepRunning()) {
+    for (auto &value : values)
+      value = dist(engine);
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+BENCHMARK(random_mt_doubles);
+
+static void random_dsfmt_doubles(benchmark::State &state) {
+  crypto::dsfmt19937_engine engine;
+  std::vector<double> values(4096u);
+  while (state.KeepRunning()) {
+    engine.generate_doubles(values.data(), values.data() + values.size());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+BENCHMARK(random_dsfmt_doubles);
+
+// -- Uniform doubles ----------------------------------------------------------
+
+template <typename ENGINE>
+static void random_uniform_double(benchmark::State &state) {
+  ENGINE rng;
+  double sum = 0.0;
+  while (state.KeepRunning()) {
+    sum += rng.template uniform<double>();
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(random_uniform_double, crypto::default_random_engine);
+BENCHMARK_TEMPLATE(random_uniform_double, crypto::mt19937);
+BENCHMARK_TEMPLATE(random_uniform_double, crypto::xoshiro256starstar);
+BENCHMARK_TEMPLATE(random_uniform_double, crypto::xoroshiro128plus);
+BENCHMARK_TEMPLATE(random_uniform_double, crypto::pcg64);
+BENCHMARK_TEMPLATE(random_uniform_double, crypto::chacha8);
+BENCHMARK_TEMPLATE(random_uniform_double, crypto::chacha20);
+BENCHMARK_TEMPLATE(random_uniform_double, crypto::philox4x32);
+BENCHMARK_TEMPLATE(random_uniform_double, crypto::threefry4x64);
+
+// -- Jumping ------------------------------------------------------------------
+
+template <typename ENGINE>
+static void random_jump(benchmark::State &state) {
+  ENGINE engine;
+  while (state.KeepRunning()) {
+    engine.jump();
+  }
+  benchmark::DoNotOptimize(engine);
+}
+
+BENCHMARK_TEMPLATE(random_jump, crypto::xoshiro256starstar_engine);
+BENCHMARK_TEMPLATE(random_jump, crypto::xoroshiro128plus_engine);
+BENCHMARK_TEMPLATE(random_jump, crypto::pcg64_engine);
+
+template <typename ENGINE>
+static void random_jump_ahead(benchmark::State &state) {
+  ENGINE engine;
+  while (state.KeepRunning()) {
+    crypto::jump_ahead(engine, 1ull << 40);
+  }
+  benchmark::DoNotOptimize(engine);
+}
+
+BENCHMARK_TEMPLATE(random_jump_ahead, std::minstd_rand0);
+BENCHMARK_TEMPLATE(random_jump_ahead, std::mt19937)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(random_jump_ahead, std::mt19937_64)->Unit(benchmark::kMicrosecond);
+
+// -- Short-lived engines ------------------------------------------------------
+
+template <typename ENGINE>
+static void random_construct_and_draw(benchmark::State &state) {
+  double sum = 0.0;
+  while (state.KeepRunning()) {
+    ENGINE rng;
+    sum += rng.template uniform<double>();
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(random_construct_and_draw, crypto::default_random_engine);
+BENCHMARK_TEMPLATE(random_construct_and_draw, crypto::mt19937);
+
+static void random_thread_rng(benchmark::State &state) {
+  double sum = 0.0;
+  while (state.KeepRunning()) {
+    sum += crypto::thread_rng().uniform<double>();
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(random_thread_rng);
+
+// -- Per-call vs prepared distributions ---------------------------------------
+
+#define CRYPTO_BENCH_DISTRIBUTION(name, ...) \
+  static void random_per_call_##name(benchmark::State &state) { \
+    crypto::xoshiro256starstar rng; \
+    double sum = 0.0; \
+    while (state.KeepRunning()) { \
+      sum += rng.name(__VA_ARGS__); \
+    } \
+    benchmark::DoNotOptimize(sum); \
+    state.SetItemsProcessed(state.iterations()); \
+  } \
+  BENCHMARK(random_per_call_##name); \
+  static void random_prepared_##name(benchmark::State &state) { \
+    crypto::xoshiro256starstar rng; \
+    auto dist = rng.make_##name(__VA_ARGS__); \
+    double sum = 0.0; \
+    while (state.KeepRunning()) { \
+      sum += dist(); \
+    } \
+    benchmark::DoNotOptimize(sum); \
+    state.SetItemsProcessed(state.iterations()); \
+  } \
+  BENCHMARK(random_prepared_##name);
+
+CRYPTO_BENCH_DISTRIBUTION(normal, 0.0, 1.0)
+CRYPTO_BENCH_DISTRIBUTION(gamma, 3.0, 1.0)
+CRYPTO_BENCH_DISTRIBUTION(binomial, 100, 0.3)
+CRYPTO_BENCH_DISTRIBUTION(poisson, 40.0)
+
+#undef CRYPTO_BENCH_DISTRIBUTION
+
+// -- Discrete sampling --------------------------------------------------------
+
+static std::vector<double> make_weights(std::size_t size) {
+  crypto::xoshiro256starstar rng(size);
+  std::vector<double> weights(size);
+  for (auto &weight : weights) {
+    weight = rng.uniform<double>();
+  }
+  return weights;
+}
+
+static void random_discrete_per_call(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  const auto weights = make_weights(static_cast<std::size_t>(state.range(0)));
+  int sum = 0;
+  while (state.KeepRunning()) {
+    sum += rng.discrete(weights.begin(), weights.end());
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(random_discrete_per_call)->Arg(16)->Arg(1024)->Arg(100000);
+
+static void random_discrete_std(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  const auto weights = make_weights(static_cast<std::size_t>(state.range(0)));
+  std::discrete_distribution<int> dist(weights.begin(), weights.end());
+  int sum = 0;
+  while (state.KeepRunning()) {
+    sum += dist(rng);
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(random_discrete_std)->Arg(16)->Arg(1024)->Arg(100000);
+
+static void random_discrete_alias(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  const auto weights = make_weights(static_cast<std::size_t>(state.range(0)));
+  auto dist = rng.make_discrete(weights.begin(), weights.end());
+  int sum = 0;
+  while (state.KeepRunning()) {
+    sum += dist();
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(random_discrete_alias)->Arg(16)->Arg(1024)->Arg(100000);
+
+static void random_piecewise_linear_std(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  const auto weights = make_weights(static_cast<std::size_t>(state.range(0)) + 1u);
+  std::vector<double> intervals(weights.size());
+  std::iota(intervals.begin(), intervals.end(), 0.0);
+  std::piecewise_linear_distribution<double> dist(intervals.begin(), intervals.end(), weights.begin());
+  double sum = 0.0;
+  while (state.KeepRunning()) {
+    sum += dist(rng);
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(random_piecewise_linear_std)->Arg(16)->Arg(100000);
+
+static void random_piecewise_linear_guide(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  const auto weights = make_weights(static_cast<std::size_t>(state.range(0)) + 1u);
+  std::vector<double> intervals(weights.size());
+  std::iota(intervals.begin(), intervals.end(), 0.0);
+  auto dist = rng.make_piecewise_linear(intervals.begin(), intervals.end(), weights.begin());
+  double sum = 0.0;
+  while (state.KeepRunning()) {
+    sum += dist();
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(random_piecewise_linear_guide)->Arg(16)->Arg(100000);
+
+// -- Batch uniform ------------------------------------------------------------
+
+template <typename ENGINE, typename T>
+static void random_uniform_per_call(benchmark::State &state) {
+  ENGINE rng;
+  std::vector<T> values(static_cast<std::size_t>(state.range(0)));
+  while (state.KeepRunning()) {
+    for (auto &value : values)
+      value = rng.template uniform<T>(T(0), T(1000));
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename ENGINE, typename T>
+static void random_uniform_fast(benchmark::State &state) {
+  ENGINE rng;
+  std::vector<T> values(static_cast<std::size_t>(state.range(0)));
+  while (state.KeepRunning()) {
+    for (auto &value : values)
+      value = rng.template fast_uniform<T>(T(0), T(1000));
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename ENGINE, typename T>
+static void random_uniform_n(benchmark::State &state) {
+  ENGINE rng;
+  std::vector<T> values(static_cast<std::size_t>(state.range(0)));
+  while (state.KeepRunning()) {
+    rng.uniform_n(crypto::array_view::make_mutable(values), T(0), T(1000));
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+#define CRYPTO_BENCH_UNIFORM(engine, type) \
+  BENCHMARK_TEMPLATE(random_uniform_per_call, engine, type)->Arg(4096); \
+  BENCHMARK_TEMPLATE(random_uniform_fast, engine, type)->Arg(4096); \
+  BENCHMARK_TEMPLATE(random_uniform_n, engine, type)->Arg(4096);
+
+CRYPTO_BENCH_UNIFORM(crypto::xoshiro256starstar, int)
+CRYPTO_BENCH_UNIFORM(crypto::xoshiro256starstar, double)
+CRYPTO_BENCH_UNIFORM(crypto::chacha8, int)
+CRYPTO_BENCH_UNIFORM(crypto::chacha8, double)
+CRYPTO_BENCH_UNIFORM(crypto::chacha8, float)
+CRYPTO_BENCH_UNIFORM(crypto::mt19937, int)
+CRYPTO_BENCH_UNIFORM(crypto::sfmt19937, int)
+CRYPTO_BENCH_UNIFORM(crypto::dsfmt19937, double)
+
+#undef CRYPTO_BENCH_UNIFORM
+
+// -- Ziggurat -----------------------------------------------------------------
+
+template <typename DISTRIBUTION>
+static void random_normal_family(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  DISTRIBUTION dist;
+  double sum = 0.0;
+  while (state.KeepRunning()) {
+    sum += dist(rng);
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(random_normal_family, std::normal_distribution<double>);
+BENCHMARK_TEMPLATE(random_normal_family, crypto::normal_sampler<double>);
+BENCHMARK_TEMPLATE(random_normal_family, std::exponential_distribution<double>);
+BENCHMARK_TEMPLATE(random_normal_family, crypto::exponential_sampler<double>);
+BENCHMARK_TEMPLATE(random_normal_family, std::lognormal_distribution<double>);
+BENCHMARK_TEMPLATE(random_normal_family, crypto::lognormal_sampler<double>);
+BENCHMARK_TEMPLATE(random_normal_family, std::gamma_distribution<double>);
+BENCHMARK_TEMPLATE(random_normal_family, crypto::gamma_sampler<double>);
+BENCHMARK_TEMPLATE(random_normal_family, std::student_t_distribution<double>);
+BENCHMARK_TEMPLATE(random_normal_family, crypto::student_t_sampler<double>);
+
+template <typename ENGINE>
+static void random_normal_n(benchmark::State &state) {
+  ENGINE rng;
+  std::vector<double> values(static_cast<std::size_t>(state.range(0)));
+  while (state.KeepRunning()) {
+    rng.normal_n(crypto::array_view::make_mutable(values));
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(random_normal_n, crypto::xoshiro256starstar)->Arg(4096);
+BENCHMARK_TEMPLATE(random_normal_n, crypto::chacha8)->Arg(4096);
+
+template <typename ENGINE>
+static void random_exponential_n(benchmark::State &state) {
+  ENGINE rng;
+  std::vector<double> values(static_cast<std::size_t>(state.range(0)));
+  while (state.KeepRunning()) {
+    rng.exponential_n(crypto::array_view::make_mutable(values));
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(random_exponential_n, crypto::xoshiro256starstar)->Arg(4096);
+
+// -- Quasi-random -------------------------------------------------------------
+
+template <typename ENGINE>
+static void random_quasi_doubles(benchmark::State &state) {
+  ENGINE engine(static_cast<std::size_t>(state.range(1)));
+  std::vector<double> values(static_cast<std::size_t>(state.range(0)));
+  while (state.KeepRunning()) {
+    engine.generate_doubles(values.data(), values.data() + values.size());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(random_quasi_doubles, crypto::sobol_engine)->Args({4096, 16});
+BENCHMARK_TEMPLATE(random_quasi_doubles, crypto::halton_engine)->Args({4096, 16});
+
+static void random_quasi_seek(benchmark::State &state) {
+  crypto::sobol_engine engine(static_cast<std::size_t>(state.range(0)));
+  std::uint64_t position = 0u;
+  while (state.KeepRunning()) {
+    engine.seek(position);
+    position += 1000003u;
+    benchmark::DoNotOptimize(engine());
+  }
+}
+
+BENCHMARK(random_quasi_seek)->Arg(16);
+
+template <typename ENGINE>
+static void random_inverse_cdf_normal_n(benchmark::State &state) {
+  ENGINE rng(1u);
+  std::vector<double> values(static_cast<std::size_t>(state.range(0)));
+  while (state.KeepRunning()) {
+    rng.inverse_cdf_n(crypto::array_view::make_mutable(values), crypto::normal_quantile);
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(random_inverse_cdf_normal_n, crypto::xoshiro256starstar)->Arg(4096);
+BENCHMARK_TEMPLATE(random_inverse_cdf_normal_n, crypto::sobol)->Arg(4096);
+
+// -- Parallel shuffle ---------------------------------------------------------
+
+static void random_shuffle_std(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  std::vector<std::uint64_t> values(static_cast<std::size_t>(state.range(0)));
+  std::iota(values.begin(), values.end(), 0u);
+  while (state.KeepRunning()) {
+    rng.shuffle(values);
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(random_shuffle_std)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
+
+static void random_shuffle_parallel(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  std::vector<std::uint64_t> values(static_cast<std::size_t>(state.range(0)));
+  std::iota(values.begin(), values.end(), 0u);
+  const auto threads = static_cast<unsigned>(state.range(1));
+  while (state.KeepRunning()) {
+    rng.parallel_shuffle(values, threads);
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(random_shuffle_parallel)
+    ->Args({1 << 24, 1})
+    ->Args({1 << 24, 4})
+    ->Unit(benchmark::kMillisecond);
+
+static void random_permutation_single(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  const auto permutation = rng.permutation(10000000000u);
+  std::uint64_t i = 0u;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(permutation(i++));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(random_permutation_single);
+
+static void random_permutation_evaluate(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  const auto permutation = rng.permutation(10000000000u);
+  std::vector<std::uint64_t> output(static_cast<std::size_t>(state.range(0)));
+  std::uint64_t first = 0u;
+  while (state.KeepRunning()) {
+    permutation.evaluate(first, crypto::array_view::make_mutable(output));
+    benchmark::DoNotOptimize(output.data());
+    first += output.size();
+    if (first > permutation.size() - output.size()) {
+      first = 0u;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(random_permutation_evaluate)->Arg(4096);
+
+// -- Sampling -----------------------------------------------------------------
+
+static void random_sample_randutils(benchmark::State &state) {
+  randutils::random_generator<crypto::xoshiro256starstar_engine> rng;
+  std::vector<std::uint64_t> values(static_cast<std::size_t>(state.range(0)));
+  std::iota(values.begin(), values.end(), 0u);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(rng.sample(state.range(1), values));
+  }
+}
+
+BENCHMARK(random_sample_randutils)->Args({1 << 22, 1000})->Unit(benchmark::kMicrosecond);
+
+static void random_sample(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  std::vector<std::uint64_t> values(static_cast<std::size_t>(state.range(0)));
+  std::iota(values.begin(), values.end(), 0u);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(rng.sample(static_cast<std::uint64_t>(state.range(1)), values));
+  }
+}
+
+BENCHMARK(random_sample)->Args({1 << 22, 1000})->Unit(benchmark::kMicrosecond);
+
+static void random_reservoir_sample(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  std::vector<std::uint64_t> values(static_cast<std::size_t>(state.range(0)));
+  std::iota(values.begin(), values.end(), 0u);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(rng.reservoir_sample(values, static_cast<std::size_t>(state.range(1))));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(random_reservoir_sample)->Args({1 << 22, 1000})->Unit(benchmark::kMicrosecond);
+
+static void random_weighted_reservoir_sample(benchmark::State &state) {
+  crypto::xoshiro256starstar rng;
+  std::vector<std::uint64_t> values(static_cast<std::size_t>(state.range(0)));
+  std::iota(values.begin(), values.end(), 0u);
+  std::vector<double> weights(values.size());
+  rng.uniform_n(crypto::array_view::make_mutable(weights), 0.0, 10.0);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(rng.weighted_reservoir_sample(
+        values.begin(), values.end(), weights.begin(), static_cast<std::size_t>(state.range(1))));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(random_weighted_reservoir_sample)->Args({1 << 22, 1000})->Unit(benchmark::kMicrosecond);
+
+// -- Parallel generate --------------------------------------------------------
+
+template <typename ENGINE>
+static void random_parallel_generate(benchmark::State &state) {
+  std::vector<double> values(static_cast<std::size_t>(state.range(0)));
+  const auto threads = static_cast<unsigned>(state.range(1));
+  while (state.KeepRunning()) {
+    crypto::parallel_generate<ENGINE>(values, std::normal_distribution<double>(), 42u, threads);
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(random_parallel_generate, crypto::philox4x32_engine)
+    ->Args({1 << 20, 1})
+    ->Args({1 << 20, 4})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(random_parallel_generate, crypto::threefry4x64_engine)
+    ->Args({1 << 20, 1})
+    ->Unit(benchmark::kMillisecond);
+
+// -- Seed sequences -----------------------------------------------------------
+
+static void random_seed_auto(benchmark::State &state) {
+  std::vector<crypto::xoshiro256starstar_engine> engines(1000u);
+  while (state.KeepRunning()) {
+    for (auto &engine : engines) {
+      randutils::auto_seed_256 seed;
+      engine.seed(seed);
+    }
+    benchmark::DoNotOptimize(engines.data());
+  }
+  state.SetItemsProcessed(state.iterations() * engines.size());
+}
+
+BENCHMARK(random_seed_auto);
+
+static void random_seed_spawn(benchmark::State &state) {
+  randutils::auto_seed_256 parent;
+  std::vector<crypto::xoshiro256starstar_engine> engines(1000u);
+  while (state.KeepRunning()) {
+    parent.seed_engines(engines.begin(), engines.end());
+    benchmark::DoNotOptimize(engines.data());
+  }
+  state.SetItemsProcessed(state.iterations() * engines.size());
+}
+
+BENCHMARK(random_seed_spawn);
+
+// -- Engine state -------------------------------------------------------------
+
+template <typename ENGINE>
+static void random_state_save_text(benchmark::State &state) {
+  std::vector<ENGINE> engines(1000u);
+  std::ostringstream out;
+  while (state.KeepRunning()) {
+    out.str(std::string());
+    for (auto &engine : engines) {
+      out << engine;
+    }
+    benchmark::DoNotOptimize(out.tellp());
+  }
+  state.SetItemsProcessed(state.iterations() * engines.size());
+}
+
+BENCHMARK_TEMPLATE(random_state_save_text, std::mt19937);
+BENCHMARK_TEMPLATE(random_state_save_text, std::minstd_rand);
+
+template <typename ENGINE>
+static void random_state_save(benchmark::State &state) {
+  std::vector<ENGINE> engines(1000u);
+  std::vector<crypto::byte> buffer(engines.size() * crypto::engine_state_size(engines.front()));
+  while (state.KeepRunning()) {
+    std::size_t offset = 0u;
+    for (auto &engine : engines) {
+      offset += crypto::save_engine_state(
+          engine,
+          crypto::mutable_buffer_view(buffer.data() + offset, buffer.size() - offset));
+    }
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetItemsProcessed(state.iterations() * engines.size());
+}
+
+BENCHMARK_TEMPLATE(random_state_save, std::mt19937);
+BENCHMARK_TEMPLATE(random_state_save, std::minstd_rand);
+BENCHMARK_TEMPLATE(random_state_save, crypto::xoshiro256starstar_engine);
+
+// -- Tokens -------------------------------------------------------------------
+
+static void random_token_per_char(benchmark::State &state) {
+  const std::string alphabet = crypto::token_generator::base64url().alphabet();
+  crypto::chacha20 rng;
+  while (state.KeepRunning()) {
+    std::string token;
+    for (auto i = 0u; i < 32u; ++i) {
+      token += alphabet[rng.uniform<std::size_t>(0u, alphabet.size() - 1u)];
+    }
+    auto result = crypto::secure_string::unsafe_make(token);
+    benchmark::DoNotOptimize(result.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(random_token_per_char);
+
+static void random_token(benchmark::State &state) {
+  const auto generator = crypto::token_generator::base64url();
+  while (state.KeepRunning()) {
+    auto token = generator(32u);
+    benchmark::DoNotOptimize(token.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(random_token);
+
+static void random_token_batch(benchmark::State &state) {
+  const auto generator = crypto::token_generator::base64url();
+  while (state.KeepRunning()) {
+    auto tokens = generator(1000u, 32u);
+    benchmark::DoNotOptimize(tokens.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 1000u);
+}
+
+BENCHMARK(random_token_batch);
+
+static void random_token_alphanumeric(benchmark::State &state) {
+  const auto generator = crypto::token_generator::alphanumeric();
+  auto token = crypto::secure_string::make_zeroed(1u << 16);
+  while (state.KeepRunning()) {
+    generator.fill(token);
+    benchmark::DoNotOptimize(token.data());
+  }
+  state.SetBytesProcessed(state.iterations() * token.size());
+}
+
+BENCHMARK(random_token_alphanumeric);
+
+static void random_token_hex(benchmark::State &state) {
+  const auto generator = crypto::token_generator::hex();
+  auto token = crypto::secure_string::make_zeroed(1u << 16);
+  while (state.KeepRunning()) {
+    generator.fill(token);
+    benchmark::DoNotOptimize(token.data());
+  }
+  state.SetBytesProcessed(state.iterations() * token.size());
+}
+
+BENCHMARK(random_token_hex);
@@ -0,0 +1,185 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "crypto/chacha_engine.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define CRYPTO_CHACHA_AVX2 1
+#  include <immintrin.h>
+#endif
+
+namespace crypto {
+namespace detail {
+
+  static inline std::uint32_t rotl32(std::uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+  }
+
+#define CRYPTO_CHACHA_QUARTER_ROUND(a, b, c, d) \
+    a += b; d ^= a; d = rotl32(d, 16); \
+    c += d; b ^= c; b = rotl32(b, 12); \
+    a += b; d ^= a; d = rotl32(d, 8);  \
+    c += d; b ^= c; b = rotl32(b, 7);
+
+  static void chacha_block_scalar(
+      const std::uint32_t *input,
+      std::uint32_t *output,
+      unsigned rounds) {
+    std::uint32_t x[16u];
+    std::memcpy(x, input, sizeof(x));
+    for (auto i = 0u; i < rounds; i += 2u) {
+      CRYPTO_CHACHA_QUARTER_ROUND(x[0], x[4], x[ 8], x[12])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[1], x[5], x[ 9], x[13])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[2], x[6], x[10], x[14])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[3], x[7], x[11], x[15])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[0], x[5], x[10], x[15])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[1], x[6], x[11], x[12])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[2], x[7], x[ 8], x[13])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[3], x[4], x[ 9], x[14])
+    }
+    for (auto i = 0u; i < 16u; ++i) {
+      output[i] = x[i] + input[i];
+    }
+  }
+
+#undef CRYPTO_CHACHA_QUARTER_ROUND
+
+  static inline void increment_counter(std::uint32_t *input) {
+    if (++input[12u] == 0u) {
+      ++input[13u];
+    }
+  }
+
+#ifdef CRYPTO_CHACHA_AVX2
+
+  /// Computes eight blocks at once, lane i of every register holding the
+  /// state of block i.
+  __attribute__((target("avx2")))
+  static void chacha_8blocks_avx2(const std::uint32_t *input, std::uint32_t *output, unsigned rounds) {
+    const __m256i rot16 = _mm256_setr_epi8(
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(
+        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+
+    __m256i in[16u];
+    for (auto i = 0u; i < 16u; ++i) {
+      in[i] = _mm256_set1_epi32(static_cast<int>(input[i]));
+    }
+    // 64-bit counter per lane, with carry into the high word.
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i low = _mm256_add_epi32(in[12u], lanes);
+    const __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    const __m256i carry = _mm256_cmpgt_epi32(
+        _mm256_xor_si256(in[12u], sign),
+        _mm256_xor_si256(low, sign));
+    in[12u] = low;
+    in[13u] = _mm256_sub_epi32(in[13u], carry);
+
+    __m256i x[16u];
+    for (auto i = 0u; i < 16u; ++i) {
+      x[i] = in[i];
+    }
+
+#define CRYPTO_CHACHA_ROTL(v, n) \
+    _mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - n))
+#define CRYPTO_CHACHA_QUARTER_ROUND(a, b, c, d) \
+    a = _mm256_add_epi32(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot16); \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = CRYPTO_CHACHA_ROTL(b, 12); \
+    a = _mm256_add_epi32(a, b); d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rot8); \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = CRYPTO_CHACHA_ROTL(b, 7);
+
+    for (auto i = 0u; i < rounds; i += 2u) {
+      CRYPTO_CHACHA_QUARTER_ROUND(x[0], x[4], x[ 8], x[12])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[1], x[5], x[ 9], x[13])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[2], x[6], x[10], x[14])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[3], x[7], x[11], x[15])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[0], x[5], x[10], x[15])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[1], x[6], x[11], x[12])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[2], x[7], x[ 8], x[13])
+      CRYPTO_CHACHA_QUARTER_ROUND(x[3], x[4], x[ 9], x[14])
+    }
+
+#undef CRYPTO_CHACHA_QUARTER_ROUND
+#undef CRYPTO_CHACHA_ROTL
+
+    for (auto i = 0u; i < 16u; ++i) {
+      x[i] = _mm256_add_epi32(x[i], in[i]);
+    }
+
+    // Transpose the two 8x8 word matrices so every block is contiguous.
+    for (auto half = 0u; half < 2u; ++half) {
+      __m256i *r = &x[8u * half];
+      const __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+      const __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+      const __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+      const __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+      const __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+      const __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+      const __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+      const __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+      const __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+      const __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+      const __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+      const __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+      const __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+      const __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+      const __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+      const __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+      // Row b of the transposed matrix holds words [8 * half, 8 * half + 8)
+      // of block b.
+      const __m256i rows[8u] = {
+        _mm256_permute2x128_si256(u0, u4, 0x20),
+        _mm256_permute2x128_si256(u1, u5, 0x20),
+        _mm256_permute2x128_si256(u2, u6, 0x20),
+        _mm256_permute2x128_si256(u3, u7, 0x20),
+        _mm256_permute2x128_si256(u0, u4, 0x31),
+        _mm256_permute2x128_si256(u1, u5, 0x31),
+        _mm256_permute2x128_si256(u2, u6, 0x31),
+        _mm256_permute2x128_si256(u3, u7, 0x31)
+      };
+      for (auto b = 0u; b < 8u; ++b) {
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(output + 16u * b + 8u * half),
+            rows[b]);
+      }
+    }
+  }
+
+#endif // CRYPTO_CHACHA_AVX2
+
+  void chacha_blocks(
+      const std::uint32_t *input,
+      std::uint32_t *output,
+      std::size_t blocks,
+      unsigned rounds) {
+    std::uint32_t state[16u];
+    std::memcpy(state, input, sizeof(state));
+#ifdef CRYPTO_CHACHA_AVX2
+    if (cpu_has_avx2()) {
+      for (; blocks >= 8u; blocks -= 8u, output += 8u * 16u) {
+        chacha_8blocks_avx2(state, output, rounds);
+        for (auto i = 0u; i < 8u; ++i) {
+          increment_counter(state);
+        }
+      }
+      if (blocks > 1u) {
+        // Cheaper to compute eight blocks and drop the extra ones.
+        std::uint32_t tail[8u * 16u];
+        chacha_8blocks_avx2(state, tail, rounds);
+        std::memcpy(output, tail, blocks * 16u * sizeof(std::uint32_t));
+        return;
+      }
+    }
+#endif // CRYPTO_CHACHA_AVX2
+    for (; blocks > 0u; --blocks, output += 16u) {
+      chacha_block_scalar(state, output, rounds);
+      increment_counter(state);
+    }
+  }
+
+} // namespace detail
+} // namespace crypto
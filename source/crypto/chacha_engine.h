@@ -0,0 +1,247 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/random_bits.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace crypto {
+
+namespace detail {
+
+  /// Computes @a blocks consecutive ChaCha blocks of @a rounds rounds into
+  /// @a output (16 words per block), starting at the 64-bit block counter
+  /// stored in words 12 and 13 of @a input. Uses AVX2 when the CPU supports
+  /// it.
+  void chacha_blocks(
+      const std::uint32_t *input,
+      std::uint32_t *output,
+      std::size_t blocks,
+      unsigned rounds);
+
+} // namespace detail
+
+  /// A random number engine based on the ChaCha stream cipher with @a ROUNDS
+  /// rounds. Satisfies the RandomNumberEngine requirements, so it can be used
+  /// as the RANDOM_ENGINE of random_engine_adaptor.
+  ///
+  /// The engine is keyed with 256 bits and a 64-bit stream id, and addresses
+  /// its output with a 64-bit block counter, hence @a discard and @a seek run
+  /// in constant time. Blocks are generated several at once.
+  template <unsigned ROUNDS>
+  class chacha_engine {
+    static_assert(ROUNDS > 0u && ROUNDS % 2u == 0u, "invalid number of rounds");
+  public:
+
+    using result_type = std::uint32_t;
+
+    using key_type = std::array<std::uint32_t, 8u>;
+
+    static constexpr unsigned rounds = ROUNDS;
+
+    /// Number of words in a ChaCha block.
+    static constexpr std::size_t block_size = 16u;
+
+    /// Number of blocks generated at once.
+    static constexpr std::size_t buffer_blocks = 8u;
+
+    static constexpr result_type default_seed = 0u;
+
+    static constexpr result_type min() {
+      return 0u;
+    }
+
+    static constexpr result_type max() {
+      return 0xffffffffu;
+    }
+
+    chacha_engine() : chacha_engine(default_seed) {}
+
+    explicit chacha_engine(result_type value) {
+      seed(value);
+    }
+
+    template <
+        typename SeedSeq,
+        typename = std::enable_if_t<
+            !std::is_convertible<SeedSeq, result_type>::value &&
+            !std::is_same<std::decay_t<SeedSeq>, chacha_engine>::value>>
+    explicit chacha_engine(SeedSeq &seq) {
+      seed(seq);
+    }
+
+    explicit chacha_engine(const key_type &key, std::uint64_t stream = 0u) {
+      set_key(key, stream);
+    }
+
+    /// @name Seeding
+    /// @{
+
+    void seed(result_type value = default_seed) {
+      std::uint64_t x = value;
+      key_type key;
+      for (auto i = 0u; i < key.size(); i += 2u) {
+        auto z = detail::splitmix64(x);
+        key[i] = static_cast<std::uint32_t>(z);
+        key[i + 1u] = static_cast<std::uint32_t>(z >> 32);
+      }
+      set_key(key);
+    }
+
+    template <
+        typename SeedSeq,
+        typename = std::enable_if_t<!std::is_convertible<SeedSeq, result_type>::value>>
+    void seed(SeedSeq &seq) {
+      std::array<std::uint32_t, 10u> words;
+      seq.generate(words.begin(), words.end());
+      key_type key;
+      std::copy_n(words.begin(), key.size(), key.begin());
+      set_key(key, words[8u] | (std::uint64_t(words[9u]) << 32));
+    }
+
+    /// Sets the key and the stream id, and rewinds the engine to the
+    /// beginning of the stream.
+    void set_key(const key_type &key, std::uint64_t stream = 0u) {
+      _input[0u] = 0x61707865u; // "expand 32-byte k"
+      _input[1u] = 0x3320646eu;
+      _input[2u] = 0x79622d32u;
+      _input[3u] = 0x6b206574u;
+      std::copy(key.begin(), key.end(), &_input[4u]);
+      _input[14u] = static_cast<std::uint32_t>(stream);
+      _input[15u] = static_cast<std::uint32_t>(stream >> 32);
+      set_counter(0u);
+    }
+
+    key_type key() const {
+      key_type key;
+      std::copy_n(&_input[4u], key.size(), key.begin());
+      return key;
+    }
+
+    /// Selects one of the 2^64 independent streams available for the current
+    /// key, and rewinds the engine to the beginning of it.
+    void set_stream(std::uint64_t stream) {
+      set_key(key(), stream);
+    }
+
+    std::uint64_t stream() const {
+      return _input[14u] | (std::uint64_t(_input[15u]) << 32);
+    }
+
+    /// @}
+    /// @name Generation
+    /// @{
+
+    result_type operator()() {
+      if (_index == buffer_size) {
+        refill();
+      }
+      return _buffer[_index++];
+    }
+
+    /// Fills [first, last) with the next values of the stream. Equivalent to
+    /// calling operator() for every element, but whole blocks are written
+    /// directly to the output.
+    void generate(result_type *first, result_type *last) {
+      auto count = static_cast<std::size_t>(last - first);
+      auto available = std::min(count, buffer_size - _index);
+      std::memcpy(first, &_buffer[_index], available * sizeof(result_type));
+      _index += available;
+      first += available;
+      count -= available;
+      const auto blocks = count / block_size;
+      if (blocks > 0u) {
+        detail::chacha_blocks(_input.data(), first, blocks, ROUNDS);
+        set_counter(counter() + blocks);
+        first += blocks * block_size;
+        count -= blocks * block_size;
+      }
+      if (count > 0u) {
+        refill();
+        std::memcpy(first, _buffer.data(), count * sizeof(result_type));
+        _index = count;
+      }
+    }
+
+    /// @}
+    /// @name Random access
+    /// @{
+
+    /// Advances the engine by @a z values in constant time.
+    void discard(unsigned long long z) {
+      seek(position() + z);
+    }
+
+    /// Positions the engine so that the next value returned is the
+    /// @a position-th value of the current stream.
+    void seek(std::uint64_t position) {
+      set_counter(position / block_size);
+      const auto offset = static_cast<std::size_t>(position % block_size);
+      if (offset > 0u) {
+        refill();
+        _index = offset;
+      }
+    }
+
+    /// Index in the current stream of the next value to be returned.
+    std::uint64_t position() const {
+      return counter() * block_size - (buffer_size - _index);
+    }
+
+    /// @}
+
+    friend bool operator==(const chacha_engine &lhs, const chacha_engine &rhs) {
+      return
+          std::equal(&lhs._input[0u], &lhs._input[12u], &rhs._input[0u]) &&
+          (lhs.stream() == rhs.stream()) &&
+          (lhs.position() == rhs.position());
+    }
+
+    friend bool operator!=(const chacha_engine &lhs, const chacha_engine &rhs) {
+      return !(lhs == rhs);
+    }
+
+  private:
+
+    static constexpr std::size_t buffer_size = block_size * buffer_blocks;
+
+    std::uint64_t counter() const {
+      return _input[12u] | (std::uint64_t(_input[13u]) << 32);
+    }
+
+    /// Sets the counter of the next block to generate and empties the buffer.
+    void set_counter(std::uint64_t counter) {
+      _input[12u] = static_cast<std::uint32_t>(counter);
+      _input[13u] = static_cast<std::uint32_t>(counter >> 32);
+      _index = buffer_size;
+    }
+
+    void refill() {
+      detail::chacha_blocks(_input.data(), _buffer.data(), buffer_blocks, ROUNDS);
+      set_counter(counter() + buffer_blocks);
+      _index = 0u;
+    }
+
+    std::array<std::uint32_t, block_size> _input;
+
+    std::size_t _index;
+
+    alignas(32) std::array<result_type, buffer_size> _buffer;
+  };
+
+  using chacha8_engine = chacha_engine<8u>;
+
+  using chacha12_engine = chacha_engine<12u>;
+
+  using chacha20_engine = chacha_engine<20u>;
+
+} // namespace crypto
@@ -0,0 +1,221 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "crypto/chunker.h"
+
+#include "crypto/detail/parallel.h"
+#include "crypto/random_bits.h"
+#include "crypto/sha256_context.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace crypto {
+
+namespace detail {
+
+  namespace {
+
+    /// Random value of every byte added to the gear hash, and the values
+    /// shifted one bit for rolling two bytes at once. Fixed, boundaries of
+    /// existing data would move if it changed.
+    struct gear_tables {
+      std::array<std::uint64_t, 256u> gear;
+      std::array<std::uint64_t, 256u> shifted;
+    };
+
+    const gear_tables &get_gear_tables() {
+      static const auto tables = []() {
+        gear_tables result;
+        std::uint64_t state = 0x6765617274616231u;
+        for (auto b = 0u; b < 256u; ++b) {
+          result.gear[b] = splitmix64(state);
+          result.shifted[b] = result.gear[b] << 1;
+        }
+        return result;
+      }();
+      return tables;
+    }
+
+    /// Rolls the gear hash over [data + i, data + end) until its bits in
+    /// @a mask are zero, two bytes per step: the hash after the first byte
+    /// is only computed shifted, which loses its top bit, so masks must not
+    /// include bit 63. Returns whether a boundary was found, leaving @a i
+    /// after it.
+    bool roll(
+        const gear_tables &tables,
+        const byte *data,
+        std::size_t &i,
+        std::size_t end,
+        std::uint64_t &hash,
+        std::uint64_t mask) {
+      const auto mask_shifted = mask << 1;
+      for (; i + 2u <= end; i += 2u) {
+        const auto first = (hash << 2) + tables.shifted[data[i]];
+        if ((first & mask_shifted) == 0u) {
+          i += 1u;
+          return true;
+        }
+        hash = first + tables.gear[data[i + 1u]];
+        if ((hash & mask) == 0u) {
+          i += 2u;
+          return true;
+        }
+      }
+      if (i < end) {
+        hash = (hash << 1) + tables.gear[data[i++]];
+        return (hash & mask) == 0u;
+      }
+      return false;
+    }
+
+  } // namespace
+
+} // namespace detail
+
+  chunker::chunker(std::size_t average_size, std::size_t min_size, std::size_t max_size)
+    : _average_size(average_size),
+      _min_size(min_size),
+      _max_size(max_size) {
+    if (min_size < 64u || min_size > average_size || average_size > max_size || max_size > (1u << 30)) {
+      throw std::invalid_argument("chunk sizes must satisfy 64 <= min <= average <= max <= 2^30");
+    }
+    if ((average_size & (average_size - 1u)) != 0u) {
+      throw std::invalid_argument("average chunk size must be a power of two");
+    }
+    std::size_t bits = 0u;
+    while ((std::size_t(1u) << bits) < average_size) {
+      ++bits;
+    }
+    // The high bits of the hash depend on the most bytes; bit 63 is left out,
+    // see roll().
+    _mask_small = (~std::uint64_t(0u) << (64u - (bits + 2u))) >> 1;
+    _mask_large = (~std::uint64_t(0u) << (64u - (bits - 2u))) >> 1;
+  }
+
+  std::size_t chunker::scan(scan_state &state, const byte *data, std::size_t size, bool &boundary) const {
+    const auto &tables = detail::get_gear_tables();
+    const auto start = state.length;
+    auto hash = state.hash;
+    boundary = false;
+    std::size_t i = 0u;
+    if (start < _min_size) {
+      i = std::min(size, _min_size - start);
+    }
+    if (start + i < _average_size) {
+      boundary = detail::roll(tables, data, i, std::min(size, _average_size - start), hash, _mask_small);
+    }
+    if (!boundary) {
+      boundary = detail::roll(tables, data, i, std::min(size, _max_size - start), hash, _mask_large);
+      boundary = boundary || (start + i == _max_size);
+    }
+    if (boundary) {
+      state = scan_state{};
+    } else {
+      state.length = start + i;
+      state.hash = hash;
+    }
+    return i;
+  }
+
+  void chunker::chunk_range(
+      detail::sha256_context &context,
+      const_buffer_view data,
+      std::size_t begin,
+      std::size_t stop,
+      std::vector<chunk> &output) const {
+    // Left with bytes of an unfinished chunk if a previous call threw.
+    context.reset();
+    for (auto position = begin; position < stop;) {
+      scan_state state;
+      bool boundary;
+      const auto *first = data.data() + position;
+      const auto length = scan(state, first, data.size() - position, boundary);
+      context.update(first, length);
+      output.push_back(chunk{position, length, context.finish()});
+      position += length;
+    }
+  }
+
+  std::vector<chunk> chunker::operator()(const_buffer_view data, unsigned threads) const {
+    std::vector<chunk> result;
+    const auto size = data.size();
+    threads = std::max(threads, 1u);
+    // Several segments per thread balance the load, and segments of many
+    // chunks make the chunks chunked again when joining them negligible.
+    const auto segment = std::max<std::size_t>(size / (4u * threads) + 1u, 64u * _max_size);
+    const auto segments = (size + segment - 1u) / segment;
+    detail::sha256_context context;
+    if (threads == 1u || segments <= 1u) {
+      chunk_range(context, data, 0u, size, result);
+      return result;
+    }
+    std::vector<std::vector<chunk>> parts(segments);
+    detail::run_parallel(segments, threads, [&](std::size_t s) {
+      // One context per worker thread, reused for all its segments.
+      thread_local detail::sha256_context worker_context;
+      chunk_range(worker_context, data, s * segment, std::min(size, (s + 1u) * segment), parts[s]);
+    });
+    result = std::move(parts[0u]);
+    for (auto s = 1u; s < segments; ++s) {
+      const auto &part = parts[s];
+      const auto stop = std::min(size, (s + 1u) * segment);
+      // The segment was chunked as if a chunk started at its beginning;
+      // chunk again from the end of the previous one until a boundary of the
+      // segment is met, from there on they are the same.
+      for (auto position = result.back().offset + result.back().length; position < stop;) {
+        const auto match = std::lower_bound(part.begin(), part.end(), position,
+            [](const chunk &c, std::uint64_t offset) { return c.offset < offset; });
+        if ((match != part.end()) && (match->offset == position)) {
+          result.insert(result.end(), match, part.end());
+          break;
+        }
+        chunk_range(context, data, position, position + 1u, result);
+        position = result.back().offset + result.back().length;
+      }
+    }
+    return result;
+  }
+
+  class chunk_stream::digest_context : public detail::sha256_context {};
+
+  chunk_stream::chunk_stream(const chunker &chunker)
+    : _chunker(chunker),
+      _context(std::make_unique<digest_context>()) {}
+
+  chunk_stream::chunk_stream(chunk_stream &&) = default;
+
+  chunk_stream &chunk_stream::operator=(chunk_stream &&) = default;
+
+  chunk_stream::~chunk_stream() = default;
+
+  void chunk_stream::update(const_buffer_view data, std::vector<chunk> &output) {
+    const auto *first = data.data();
+    for (auto size = data.size(); size > 0u;) {
+      const auto start = _state.length;
+      bool boundary;
+      const auto length = _chunker.scan(_state, first, size, boundary);
+      _context->update(first, length);
+      _position += length;
+      if (boundary) {
+        output.push_back(chunk{_position - start - length, start + length, _context->finish()});
+      }
+      first += length;
+      size -= length;
+    }
+  }
+
+  void chunk_stream::finish(std::vector<chunk> &output) {
+    if (_state.length > 0u) {
+      output.push_back(chunk{_position - _state.length, _state.length, _context->finish()});
+    } else {
+      _context->finish();
+    }
+    _state = chunker::scan_state{};
+    _position = 0u;
+  }
+
+} // namespace crypto
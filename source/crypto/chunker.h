@@ -0,0 +1,164 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/crypto.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace crypto {
+
+namespace detail {
+
+  class sha256_context;
+
+} // namespace detail
+
+  /// A content-defined chunk of a stream and its SHA-256 digest.
+  struct chunk {
+    /// Position of the chunk in the stream.
+    std::uint64_t offset;
+    std::size_t length;
+    sha256_digest digest;
+  };
+
+  inline bool operator==(const chunk &lhs, const chunk &rhs) {
+    return (lhs.offset == rhs.offset) && (lhs.length == rhs.length) && (lhs.digest == rhs.digest);
+  }
+
+  inline bool operator!=(const chunk &lhs, const chunk &rhs) {
+    return !(lhs == rhs);
+  }
+
+  /// Splits data into content-defined chunks for deduplication, with FastCDC
+  /// (Xia et al., "FastCDC: a Fast and Efficient Content-Defined Chunking
+  /// Approach for Data Deduplication", 2016): boundaries are placed where a
+  /// gear rolling hash of the last bytes matches a mask, so an insertion or
+  /// deletion only changes the chunks around it. The first @a min_size bytes
+  /// of a chunk are skipped, and normalized chunking uses a stricter mask
+  /// before @a average_size bytes and a looser one after, keeping chunk sizes
+  /// close to the average.
+  ///
+  /// Every chunk is digested with SHA-256 right after its boundary is found,
+  /// while its bytes are still in cache, so the data is only read once from
+  /// memory.
+  ///
+  /// Boundaries only depend on the data and the sizes: the gear table is
+  /// fixed, and parallel and streaming chunking return the same chunks as
+  /// sequential chunking of the whole data.
+  class chunker {
+  public:
+
+    /// Throws std::invalid_argument unless 64 <= @a min_size <=
+    /// @a average_size <= @a max_size <= 2^30 and @a average_size is a power
+    /// of two.
+    explicit chunker(
+        std::size_t average_size = 8192u,
+        std::size_t min_size = 2048u,
+        std::size_t max_size = 65536u);
+
+    std::size_t average_size() const {
+      return _average_size;
+    }
+
+    std::size_t min_size() const {
+      return _min_size;
+    }
+
+    std::size_t max_size() const {
+      return _max_size;
+    }
+
+    /// Chunks of @a data on up to @a threads threads. Large buffers are split
+    /// into segments chunked independently; boundary sequences
+    /// resynchronize within a few chunks after a segment start, and the
+    /// chunks before that are chunked again when the segments are joined.
+    std::vector<chunk> operator()(
+        const_buffer_view data,
+        unsigned threads = std::thread::hardware_concurrency()) const;
+
+  private:
+
+    friend class chunk_stream;
+
+    /// Position in the current chunk and rolling hash of a scan.
+    struct scan_state {
+      std::size_t length = 0u;
+      std::uint64_t hash = 0u;
+    };
+
+    /// Advances @a state over [@a data, @a data + @a size) and returns the
+    /// number of bytes consumed, up to and including the end of the chunk if
+    /// a boundary is found (then @a state is reset), or @a size otherwise.
+    std::size_t scan(scan_state &state, const byte *data, std::size_t size, bool &boundary) const;
+
+    /// Appends the chunks of @a data starting at [begin, stop) to
+    /// @a output, the first one at @a begin, digested with @a context.
+    void chunk_range(
+        detail::sha256_context &context,
+        const_buffer_view data,
+        std::size_t begin,
+        std::size_t stop,
+        std::vector<chunk> &output) const;
+
+    std::size_t _average_size;
+
+    std::size_t _min_size;
+
+    std::size_t _max_size;
+
+    /// Mask used before average_size bytes, two bits more than log2 of the
+    /// average.
+    std::uint64_t _mask_small;
+
+    /// Mask used after average_size bytes, two bits fewer.
+    std::uint64_t _mask_large;
+  };
+
+  /// Chunks a stream fed in pieces of any size, returning the same chunks as
+  /// chunker would return for the concatenation of the pieces. Bytes are
+  /// hashed as they are fed, nothing is buffered.
+  class chunk_stream {
+  public:
+
+    explicit chunk_stream(const chunker &chunker = crypto::chunker());
+
+    chunk_stream(chunk_stream &&);
+
+    chunk_stream &operator=(chunk_stream &&);
+
+    ~chunk_stream();
+
+    /// Feeds @a data, appending the chunks it completes to @a output.
+    void update(const_buffer_view data, std::vector<chunk> &output);
+
+    /// Appends the last chunk, if the stream did not end at a boundary, to
+    /// @a output and restarts the stream.
+    void finish(std::vector<chunk> &output);
+
+    /// Bytes fed since the stream started.
+    std::uint64_t position() const {
+      return _position;
+    }
+
+  private:
+
+    class digest_context;
+
+    chunker _chunker;
+
+    chunker::scan_state _state;
+
+    std::uint64_t _position = 0u;
+
+    std::unique_ptr<digest_context> _context;
+  };
+
+} // namespace crypto
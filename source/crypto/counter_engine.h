@@ -0,0 +1,332 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/random_bits.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace crypto {
+
+namespace detail {
+
+  /// Philox4x32 block function of Salmon, Moraes, Dror and Shaw,
+  /// "Parallel random numbers: as easy as 1, 2, 3" (2011).
+  template <unsigned ROUNDS>
+  struct philox4x32_generator {
+    using word_type = std::uint32_t;
+    using key_type = std::array<std::uint32_t, 2u>;
+    using block_type = std::array<std::uint32_t, 4u>;
+
+    static block_type block(block_type x, key_type key) {
+      for (auto round = 0u; round < ROUNDS; ++round) {
+        if (round > 0u) {
+          key[0u] += 0x9e3779b9u;
+          key[1u] += 0xbb67ae85u;
+        }
+        const std::uint64_t p0 = std::uint64_t(0xd2511f53u) * x[0u];
+        const std::uint64_t p1 = std::uint64_t(0xcd9e8d57u) * x[2u];
+        x = {{
+          static_cast<std::uint32_t>(p1 >> 32) ^ x[1u] ^ key[0u],
+          static_cast<std::uint32_t>(p1),
+          static_cast<std::uint32_t>(p0 >> 32) ^ x[3u] ^ key[1u],
+          static_cast<std::uint32_t>(p0)
+        }};
+      }
+      return x;
+    }
+
+    /// The 128-bit counter holds the block index in the low and the stream
+    /// in the high 64 bits.
+    static block_type counter(std::uint64_t index, std::uint64_t stream) {
+      return {{
+        static_cast<std::uint32_t>(index),
+        static_cast<std::uint32_t>(index >> 32),
+        static_cast<std::uint32_t>(stream),
+        static_cast<std::uint32_t>(stream >> 32)
+      }};
+    }
+  };
+
+  /// Threefry4x64 block function, the Threefish-256 block cipher without
+  /// tweak and with a configurable number of rounds (Salmon et al., 2011).
+  template <unsigned ROUNDS>
+  struct threefry4x64_generator {
+    using word_type = std::uint64_t;
+    using key_type = std::array<std::uint64_t, 4u>;
+    using block_type = std::array<std::uint64_t, 4u>;
+
+    static_assert(ROUNDS % 4u == 0u, "invalid number of rounds");
+
+    static block_type block(block_type x, const key_type &key) {
+      std::array<std::uint64_t, 5u> ks;
+      ks[4u] = 0x1bd11bdaa9fc1a22u;
+      for (auto i = 0u; i < 4u; ++i) {
+        ks[i] = key[i];
+        ks[4u] ^= key[i];
+        x[i] += key[i];
+      }
+      for (auto s = 1u; s <= ROUNDS / 4u; ++s) {
+        if (s % 2u == 1u) {
+          four_rounds<14u, 16u, 52u, 57u, 23u, 40u, 5u, 37u>(x);
+        } else {
+          four_rounds<25u, 33u, 46u, 12u, 58u, 22u, 32u, 32u>(x);
+        }
+        for (auto i = 0u; i < 4u; ++i) {
+          x[i] += ks[(s + i) % 5u];
+        }
+        x[3u] += s;
+      }
+      return x;
+    }
+
+    template <unsigned R00, unsigned R01, unsigned R10, unsigned R11,
+              unsigned R20, unsigned R21, unsigned R30, unsigned R31>
+    static void four_rounds(block_type &x) {
+      x[0u] += x[1u]; x[1u] = rotl64(x[1u], R00); x[1u] ^= x[0u];
+      x[2u] += x[3u]; x[3u] = rotl64(x[3u], R01); x[3u] ^= x[2u];
+      x[0u] += x[3u]; x[3u] = rotl64(x[3u], R10); x[3u] ^= x[0u];
+      x[2u] += x[1u]; x[1u] = rotl64(x[1u], R11); x[1u] ^= x[2u];
+      x[0u] += x[1u]; x[1u] = rotl64(x[1u], R20); x[1u] ^= x[0u];
+      x[2u] += x[3u]; x[3u] = rotl64(x[3u], R21); x[3u] ^= x[2u];
+      x[0u] += x[3u]; x[3u] = rotl64(x[3u], R30); x[3u] ^= x[0u];
+      x[2u] += x[1u]; x[1u] = rotl64(x[1u], R31); x[1u] ^= x[2u];
+    }
+
+    /// The 256-bit counter holds the block index in the first and the stream
+    /// in the second word.
+    static block_type counter(std::uint64_t index, std::uint64_t stream) {
+      return {{index, stream, 0u, 0u}};
+    }
+  };
+
+} // namespace detail
+
+  /// A counter-based random number engine (Salmon et al., 2011). Every block
+  /// of output is a pure function of the key, the stream and the index of
+  /// the block, so any value of the stream can be computed directly with
+  /// at(), and @a discard and @a seek run in constant time. Satisfies the
+  /// RandomNumberEngine requirements, so it can be used as the RANDOM_ENGINE
+  /// of random_engine_adaptor.
+  ///
+  /// Produces the same blocks as the Random123 reference implementation for
+  /// the counter {index, stream}.
+  template <typename GENERATOR>
+  class counter_engine {
+  public:
+
+    using result_type = typename GENERATOR::word_type;
+
+    using key_type = typename GENERATOR::key_type;
+
+    /// Number of words in a block.
+    static constexpr std::size_t block_size = 4u;
+
+    static constexpr result_type default_seed = 0u;
+
+    static constexpr result_type min() {
+      return 0u;
+    }
+
+    static constexpr result_type max() {
+      return ~result_type(0u);
+    }
+
+    counter_engine() : counter_engine(default_seed) {}
+
+    explicit counter_engine(result_type value) {
+      seed(value);
+    }
+
+    template <
+        typename SeedSeq,
+        typename = std::enable_if_t<
+            !std::is_convertible<SeedSeq, result_type>::value &&
+            !std::is_same<std::decay_t<SeedSeq>, counter_engine>::value>>
+    explicit counter_engine(SeedSeq &seq) {
+      seed(seq);
+    }
+
+    explicit counter_engine(const key_type &key, std::uint64_t stream = 0u) {
+      set_key(key, stream);
+    }
+
+    /// @name Seeding
+    /// @{
+
+    /// Expands @a value into the key with SplitMix64.
+    void seed(result_type value = default_seed) {
+      std::uint64_t x = value;
+      std::array<std::uint32_t, key_words> words;
+      for (auto i = 0u; i < key_words; i += 2u) {
+        const auto z = detail::splitmix64(x);
+        words[i] = static_cast<std::uint32_t>(z);
+        words[i + 1u] = static_cast<std::uint32_t>(z >> 32);
+      }
+      set_key(make_key(words.data()));
+    }
+
+    template <
+        typename SeedSeq,
+        typename = std::enable_if_t<!std::is_convertible<SeedSeq, result_type>::value>>
+    void seed(SeedSeq &seq) {
+      std::array<std::uint32_t, key_words + 2u> words;
+      seq.generate(words.begin(), words.end());
+      set_key(
+          make_key(words.data()),
+          words[key_words] | (std::uint64_t(words[key_words + 1u]) << 32));
+    }
+
+    /// Sets the key and the stream id, and rewinds the engine to the
+    /// beginning of the stream.
+    void set_key(const key_type &key, std::uint64_t stream = 0u) {
+      _key = key;
+      _stream = stream;
+      set_counter(0u);
+    }
+
+    const key_type &key() const {
+      return _key;
+    }
+
+    /// Selects one of the 2^64 independent streams available for the current
+    /// key, and rewinds the engine to the beginning of it.
+    void set_stream(std::uint64_t stream) {
+      _stream = stream;
+      set_counter(0u);
+    }
+
+    std::uint64_t stream() const {
+      return _stream;
+    }
+
+    /// @}
+    /// @name Generation
+    /// @{
+
+    result_type operator()() {
+      if (_index == buffer_size) {
+        refill();
+      }
+      return _buffer[_index++];
+    }
+
+    /// Fills [first, last) with the next values of the stream.
+    void generate(result_type *first, result_type *last) {
+      for (; first != last && _index != buffer_size; ++first) {
+        *first = _buffer[_index++];
+      }
+      for (; last - first >= static_cast<std::ptrdiff_t>(block_size); first += block_size) {
+        const auto block = compute(_counter++);
+        std::copy(block.begin(), block.end(), first);
+      }
+      if (first != last) {
+        refill();
+        for (; first != last; ++first) {
+          *first = _buffer[_index++];
+        }
+      }
+    }
+
+    /// The @a position-th value of the current stream. Does not modify the
+    /// state of the engine.
+    result_type at(std::uint64_t position) const {
+      return compute(position / block_size)[position % block_size];
+    }
+
+    /// @}
+    /// @name Random access
+    /// @{
+
+    /// Advances the engine by @a z values in constant time.
+    void discard(unsigned long long z) {
+      seek(position() + z);
+    }
+
+    /// Positions the engine so that the next value returned is the
+    /// @a position-th value of the current stream.
+    void seek(std::uint64_t position) {
+      set_counter(position / block_size);
+      const auto offset = static_cast<std::size_t>(position % block_size);
+      if (offset > 0u) {
+        refill();
+        _index = offset;
+      }
+    }
+
+    /// Index in the current stream of the next value to be returned.
+    std::uint64_t position() const {
+      return _counter * block_size - (buffer_size - _index);
+    }
+
+    /// @}
+
+    friend bool operator==(const counter_engine &lhs, const counter_engine &rhs) {
+      return
+          (lhs._key == rhs._key) &&
+          (lhs._stream == rhs._stream) &&
+          (lhs.position() == rhs.position());
+    }
+
+    friend bool operator!=(const counter_engine &lhs, const counter_engine &rhs) {
+      return !(lhs == rhs);
+    }
+
+  private:
+
+    static constexpr std::size_t buffer_size = block_size;
+
+    /// Size of the key in 32-bit words.
+    static constexpr std::size_t key_words = sizeof(key_type) / sizeof(std::uint32_t);
+
+    static key_type make_key(const std::uint32_t *words) {
+      key_type key;
+      for (auto &word : key) {
+        word = 0u;
+        for (auto i = 0u; i < sizeof(result_type) / sizeof(std::uint32_t); ++i) {
+          word |= static_cast<result_type>(static_cast<result_type>(*words++) << (32u * i));
+        }
+      }
+      return key;
+    }
+
+    typename GENERATOR::block_type compute(std::uint64_t index) const {
+      return GENERATOR::block(GENERATOR::counter(index, _stream), _key);
+    }
+
+    /// Sets the index of the next block to generate and empties the buffer.
+    void set_counter(std::uint64_t counter) {
+      _counter = counter;
+      _index = buffer_size;
+    }
+
+    void refill() {
+      _buffer = compute(_counter++);
+      _index = 0u;
+    }
+
+    key_type _key;
+
+    std::uint64_t _stream;
+
+    std::uint64_t _counter;
+
+    std::size_t _index;
+
+    typename GENERATOR::block_type _buffer;
+  };
+
+  /// Philox4x32-10, 32-bit output, 64-bit key.
+  using philox4x32_engine = counter_engine<detail::philox4x32_generator<10u>>;
+
+  /// Threefry4x64-20, 64-bit output, 256-bit key.
+  using threefry4x64_engine = counter_engine<detail::threefry4x64_generator<20u>>;
+
+} // namespace crypto
@@ -5,14 +5,24 @@
 
 #include "crypto/crypto.h"
 
+#include "crypto/sha256_context.h"
+#include "crypto/stats.h"
+#include "crypto/trace.h"
+
+#include <algorithm>
+#include <climits>
 #include <stdexcept>
 
 #include <openssl/evp.h>
+#include <openssl/rand.h>
 
 namespace crypto {
 
   template <typename D, size_t SIZE>
   static void do_digest(const_buffer_view buffer, std::array<byte, SIZE> &digest, D &&alg) {
+    CRYPTO_STATS_CALL(digest, buffer.size());
+    CRYPTO_TRACE2(digest_entry, trace::digest_algorithm(SIZE), buffer.size());
+
     if (static_cast<int>(digest.size()) != EVP_MD_size(alg)) {
       throw std::runtime_error("invalid digest size");
     }
@@ -21,6 +31,7 @@ namespace crypto {
     if (mdctx == nullptr) {
       throw std::runtime_error("openssl failed to create digest context");
     }
+    CRYPTO_STATS_EVP_CONTEXT(digest);
 
     if (1 != EVP_DigestInit_ex(mdctx, alg, nullptr)) {
       throw std::runtime_error("error generating digest sha256");
@@ -36,6 +47,7 @@ namespace crypto {
     }
 
     EVP_MD_CTX_destroy(mdctx);
+    CRYPTO_TRACE2(digest_return, trace::digest_algorithm(SIZE), buffer.size());
   }
 
   void digest(const_buffer_view buffer, sha256_digest &digest) {
@@ -47,7 +59,61 @@ namespace crypto {
   }
 
   void zeroize(mutable_buffer_view buffer) {
+    CRYPTO_STATS_CALL(zeroize, buffer.size());
+    CRYPTO_TRACE1(zeroize_entry, buffer.size());
     OPENSSL_cleanse(buffer.data(), buffer.size());
+    CRYPTO_TRACE1(zeroize_return, buffer.size());
   }
 
+  void random_bytes(mutable_buffer_view buffer) {
+    CRYPTO_STATS_CALL(random_bytes, buffer.size());
+    auto *data = buffer.data();
+    for (auto size = buffer.size(); size > 0u;) {
+      const auto n = std::min<std::size_t>(size, INT_MAX);
+      if (1 != RAND_bytes(data, static_cast<int>(n))) {
+        throw std::runtime_error("openssl failed to generate random bytes");
+      }
+      data += n;
+      size -= n;
+    }
+  }
+
+namespace detail {
+
+  sha256_context::sha256_context() : _context(EVP_MD_CTX_create()) {
+    if (_context == nullptr) {
+      throw std::runtime_error("openssl failed to create digest context");
+    }
+    CRYPTO_STATS_EVP_CONTEXT(digest);
+    init();
+  }
+
+  sha256_context::~sha256_context() {
+    EVP_MD_CTX_destroy(_context);
+  }
+
+  void sha256_context::update(const byte *data, std::size_t size) {
+    if (1 != EVP_DigestUpdate(_context, data, size)) {
+      throw std::runtime_error("error generating digest sha256");
+    }
+  }
+
+  sha256_digest sha256_context::finish() {
+    sha256_digest digest;
+    auto length = 0u;
+    if (1 != EVP_DigestFinal_ex(_context, digest.data(), &length)) {
+      throw std::runtime_error("error generating digest sha256");
+    }
+    init();
+    return digest;
+  }
+
+  void sha256_context::init() {
+    if (1 != EVP_DigestInit_ex(_context, EVP_sha256(), nullptr)) {
+      throw std::runtime_error("error generating digest sha256");
+    }
+  }
+
+} // namespace detail
+
 } // namespace crypto
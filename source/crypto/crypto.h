@@ -22,4 +22,8 @@ namespace crypto {
 
   void zeroize(mutable_buffer_view buffer);
 
+  /// Fills @a buffer with bytes from OpenSSL's cryptographically secure
+  /// random generator.
+  void random_bytes(mutable_buffer_view buffer);
+
 } // namespace crypto
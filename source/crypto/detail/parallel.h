@@ -0,0 +1,46 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace crypto {
+namespace detail {
+
+  /// Calls @a task(i) for every i in [0, @a count), spread over up to
+  /// @a threads threads (the calling thread included).
+  template <typename TASK>
+  void run_parallel(std::size_t count, unsigned threads, TASK &&task) {
+    const auto workers = static_cast<std::size_t>(std::min<std::size_t>(threads, count));
+    if (workers <= 1u) {
+      for (std::size_t i = 0u; i < count; ++i) {
+        task(i);
+      }
+      return;
+    }
+    std::atomic<std::size_t> next{0u};
+    auto work = [&]() {
+      for (auto i = next++; i < count; i = next++) {
+        task(i);
+      }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1u);
+    for (std::size_t i = 1u; i < workers; ++i) {
+      pool.emplace_back(work);
+    }
+    work();
+    for (auto &thread : pool) {
+      thread.join();
+    }
+  }
+
+} // namespace detail
+} // namespace crypto
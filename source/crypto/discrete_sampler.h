@@ -0,0 +1,492 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/array_view.h"
+#include "crypto/random_bits.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace crypto {
+
+namespace detail {
+
+  /// Uniform value on [0, 1) of type @a RealType; converting the double
+  /// may round up to 1 for float.
+  template <typename RealType>
+  inline RealType to_unit_real(std::uint64_t bits) {
+    return std::min(
+        static_cast<RealType>(to_unit_double(bits)),
+        std::nextafter(RealType(1), RealType(0)));
+  }
+
+  /// Boundaries of @a count intervals of equal length covering [xmin, xmax),
+  /// or of a single one if @a count is zero.
+  template <typename RealType>
+  inline std::vector<RealType> uniform_boundaries(std::size_t count, RealType xmin, RealType xmax) {
+    const auto n = std::max<std::size_t>(count, 1u);
+    const auto delta = (xmax - xmin) / static_cast<RealType>(n);
+    std::vector<RealType> boundaries(n + 1u);
+    for (std::size_t i = 0u; i < n; ++i) {
+      boundaries[i] = xmin + static_cast<RealType>(i) * delta;
+    }
+    boundaries[n] = xmax;
+    return boundaries;
+  }
+
+  /// Cumulative distribution with a guide table (Chen and Asau, 1974).
+  /// Finds the interval containing a value of the cumulative distribution in
+  /// expected constant time.
+  template <typename RealType>
+  class guide_table {
+  public:
+
+    guide_table() = default;
+
+    /// @a masses is the probability mass of each interval, not necessarily
+    /// normalized.
+    explicit guide_table(const std::vector<RealType> &masses)
+      : _cdf(masses.size() + 1u, RealType(0)),
+        _guide(std::max<std::size_t>(masses.size(), 1u)) {
+      for (auto i = 0u; i < masses.size(); ++i) {
+        if (!(masses[i] >= RealType(0))) {
+          throw std::invalid_argument("negative or invalid weight");
+        }
+        _cdf[i + 1u] = _cdf[i] + masses[i];
+      }
+      if (!(_cdf.back() > RealType(0))) {
+        throw std::invalid_argument("all weights are zero");
+      }
+      // Intervals of zero mass at the end are never returned, even if u *
+      // total() rounds up to total().
+      _last = masses.size() - 1u;
+      while (!(masses[_last] > RealType(0))) {
+        --_last;
+      }
+      const auto n = _guide.size();
+      std::size_t i = 0u;
+      for (auto j = 0u; j < n; ++j) {
+        const auto value = total() * static_cast<RealType>(j) / static_cast<RealType>(n);
+        while (_cdf[i + 1u] <= value && i < _last) {
+          ++i;
+        }
+        _guide[j] = i;
+      }
+    }
+
+    RealType total() const {
+      return _cdf.back();
+    }
+
+    /// Number of intervals.
+    std::size_t size() const {
+      return _cdf.size() - 1u;
+    }
+
+    RealType cdf(std::size_t i) const {
+      return _cdf[i];
+    }
+
+    /// Returns the interval i with cdf(i) <= @a u * total() < cdf(i + 1),
+    /// with @a u in [0, 1), or the last interval of positive mass if
+    /// u * total() rounds to total(). The mapping is monotonic in @a u.
+    std::size_t find(RealType u) const {
+      const auto n = _guide.size();
+      auto j = static_cast<std::size_t>(u * static_cast<RealType>(n));
+      auto i = _guide[std::min(j, n - 1u)];
+      const auto value = u * total();
+      while (_cdf[i + 1u] <= value && i < _last) {
+        ++i;
+      }
+      return i;
+    }
+
+  private:
+
+    std::vector<RealType> _cdf;
+
+    std::vector<std::size_t> _guide;
+
+    /// Last interval of positive mass.
+    std::size_t _last = 0u;
+  };
+
+} // namespace detail
+
+  /// Samples integers on [0, n) with probabilities proportional to the n
+  /// given weights. Builds a Walker/Vose alias table once, in O(n), after which
+  /// every sample takes constant time, a single 64-bit draw and no
+  /// allocation.
+  ///
+  /// Replacement for std::discrete_distribution when many values are drawn
+  /// from the same weights (it does not produce the same values).
+  template <typename IntType = int>
+  class discrete_sampler {
+  public:
+
+    using result_type = IntType;
+
+    discrete_sampler() : discrete_sampler({1.0}) {}
+
+    template <typename InputIt>
+    discrete_sampler(InputIt first, InputIt last) {
+      build(std::vector<double>(first, last));
+    }
+
+    discrete_sampler(std::initializer_list<double> weights) {
+      build(std::vector<double>(weights));
+    }
+
+    /// Weights fw(xmin + (i + 0.5) (xmax - xmin) / count) for i in [0,
+    /// count), or a single weight if @a count is zero, like
+    /// std::discrete_distribution.
+    template <typename UnaryOperation>
+    discrete_sampler(std::size_t count, double xmin, double xmax, UnaryOperation fw) {
+      const auto n = std::max<std::size_t>(count, 1u);
+      const auto delta = (xmax - xmin) / static_cast<double>(n);
+      std::vector<double> weights(n);
+      for (std::size_t i = 0u; i < n; ++i) {
+        weights[i] = static_cast<double>(fw(xmin + (static_cast<double>(i) + 0.5) * delta));
+      }
+      build(std::move(weights));
+    }
+
+    /// Number of possible values.
+    std::size_t size() const {
+      return _threshold.size();
+    }
+
+    result_type min() const {
+      return 0;
+    }
+
+    result_type max() const {
+      return static_cast<result_type>(size() - 1u);
+    }
+
+    /// Normalized probability of each value.
+    std::vector<double> probabilities() const {
+      return _probabilities;
+    }
+
+    void reset() {}
+
+    template <typename URBG>
+    result_type operator()(URBG &engine) const {
+      return sample(detail::random_u64(engine));
+    }
+
+    template <typename URBG>
+    void generate(URBG &engine, mutable_array_view<result_type> output) const {
+      for (auto &value : output) {
+        value = sample(detail::random_u64(engine));
+      }
+    }
+
+  private:
+
+    /// The high bits of bits * n select the column, the low bits decide
+    /// between the column and its alias.
+    result_type sample(std::uint64_t bits) const {
+      const std::uint64_t n = _threshold.size();
+      const auto column = detail::mulhi64(bits, n);
+      const auto fraction = bits * n;
+      return static_cast<result_type>(
+          fraction < _threshold[column] ? column : _alias[column]);
+    }
+
+    void build(std::vector<double> weights) {
+      const auto n = weights.size();
+      if (n == 0u) {
+        weights.push_back(1.0);
+        return build(std::move(weights));
+      }
+      if (n - 1u > static_cast<std::size_t>(std::numeric_limits<result_type>::max())) {
+        throw std::invalid_argument("too many weights for result type");
+      }
+      double total = 0.0;
+      for (auto weight : weights) {
+        if (!(weight >= 0.0)) {
+          throw std::invalid_argument("negative or invalid weight");
+        }
+        total += weight;
+      }
+      if (!(total > 0.0)) {
+        throw std::invalid_argument("all weights are zero");
+      }
+
+      _probabilities.resize(n);
+      std::vector<double> scaled(n);
+      std::vector<std::size_t> small;
+      std::vector<std::size_t> large;
+      for (auto i = 0u; i < n; ++i) {
+        _probabilities[i] = weights[i] / total;
+        scaled[i] = _probabilities[i] * static_cast<double>(n);
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+      }
+
+      _threshold.assign(n, std::numeric_limits<std::uint64_t>::max());
+      _alias.resize(n);
+      for (auto i = 0u; i < n; ++i) {
+        _alias[i] = i;
+      }
+      while (!small.empty() && !large.empty()) {
+        const auto s = small.back();
+        small.pop_back();
+        const auto l = large.back();
+        _threshold[s] = to_threshold(scaled[s]);
+        _alias[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+          large.pop_back();
+          small.push_back(l);
+        }
+      }
+      // Whatever remains has probability one up to rounding errors.
+    }
+
+    static std::uint64_t to_threshold(double p) {
+      constexpr double two_64 = 18446744073709551616.0;
+      return p >= 1.0 ?
+          std::numeric_limits<std::uint64_t>::max() :
+          static_cast<std::uint64_t>(p * two_64);
+    }
+
+    std::vector<std::uint64_t> _threshold;
+
+    std::vector<std::size_t> _alias;
+
+    std::vector<double> _probabilities;
+  };
+
+  /// Piecewise constant distribution sampled by inversion with a guide table,
+  /// in expected constant time. Takes the same parameters as
+  /// std::piecewise_constant_distribution: n + 1 interval boundaries and the
+  /// n weights of the intervals.
+  ///
+  /// Inversion keeps the order of the uniform values, so it can also be fed
+  /// quasi-random numbers.
+  template <typename RealType = double>
+  class piecewise_constant_sampler {
+  public:
+
+    using result_type = RealType;
+
+    /// A single interval [0, 1).
+    piecewise_constant_sampler() {
+      build({RealType(0), RealType(1)}, {RealType(1)});
+    }
+
+    template <typename InputItB, typename InputItW>
+    piecewise_constant_sampler(InputItB first_b, InputItB last_b, InputItW first_w) {
+      std::vector<RealType> intervals(first_b, last_b);
+      std::vector<RealType> weights;
+      for (auto i = 1u; i < intervals.size(); ++i, ++first_w) {
+        weights.push_back(static_cast<RealType>(*first_w));
+      }
+      build(std::move(intervals), weights);
+    }
+
+    /// Boundaries @a bl, and the weight of every interval fw at its middle.
+    /// Less than two boundaries make a single interval [0, 1), like
+    /// std::piecewise_constant_distribution.
+    template <typename UnaryOperation>
+    piecewise_constant_sampler(std::initializer_list<RealType> bl, UnaryOperation fw) {
+      if (bl.size() < 2u) {
+        build({RealType(0), RealType(1)}, {RealType(1)});
+      } else {
+        build_from_function(std::vector<RealType>(bl), fw);
+      }
+    }
+
+    /// @a nw intervals of equal length covering [xmin, xmax), or a single
+    /// one if @a nw is zero, weighted by fw at their middle.
+    template <typename UnaryOperation>
+    piecewise_constant_sampler(std::size_t nw, RealType xmin, RealType xmax, UnaryOperation fw) {
+      build_from_function(detail::uniform_boundaries(nw, xmin, xmax), fw);
+    }
+
+    result_type min() const {
+      return _intervals.front();
+    }
+
+    result_type max() const {
+      return _intervals.back();
+    }
+
+    void reset() {}
+
+    template <typename URBG>
+    result_type operator()(URBG &engine) const {
+      return quantile(detail::to_unit_real<RealType>(detail::random_u64(engine)));
+    }
+
+    template <typename URBG>
+    void generate(URBG &engine, mutable_array_view<result_type> output) const {
+      for (auto &value : output) {
+        value = (*this)(engine);
+      }
+    }
+
+    /// Inverse of the cumulative distribution function, @a u in [0, 1).
+    result_type quantile(RealType u) const {
+      const auto i = _table.find(u);
+      const auto mass = u * _table.total() - _table.cdf(i);
+      const auto x = _intervals[i] + mass / _densities[i];
+      return std::min(x, _intervals[i + 1u]);
+    }
+
+  private:
+
+    template <typename UnaryOperation>
+    void build_from_function(std::vector<RealType> intervals, UnaryOperation fw) {
+      std::vector<RealType> weights;
+      for (auto i = 1u; i < intervals.size(); ++i) {
+        weights.push_back(static_cast<RealType>(fw(RealType(0.5) * (intervals[i - 1u] + intervals[i]))));
+      }
+      build(std::move(intervals), weights);
+    }
+
+    void build(std::vector<RealType> intervals, const std::vector<RealType> &masses) {
+      if (intervals.size() < 2u) {
+        throw std::invalid_argument("at least two interval boundaries required");
+      }
+      _intervals = std::move(intervals);
+      for (auto i = 0u; i < masses.size(); ++i) {
+        _densities.push_back(masses[i] / (_intervals[i + 1u] - _intervals[i]));
+      }
+      _table = detail::guide_table<RealType>(masses);
+    }
+
+    std::vector<RealType> _intervals;
+
+    std::vector<RealType> _densities;
+
+    detail::guide_table<RealType> _table;
+  };
+
+  /// Piecewise linear distribution sampled by inversion with a guide table,
+  /// in expected constant time. Takes the same parameters as
+  /// std::piecewise_linear_distribution: n + 1 interval boundaries and the
+  /// n + 1 densities at them.
+  template <typename RealType = double>
+  class piecewise_linear_sampler {
+  public:
+
+    using result_type = RealType;
+
+    /// Uniform on [0, 1).
+    piecewise_linear_sampler() {
+      build({RealType(0), RealType(1)}, {RealType(1), RealType(1)});
+    }
+
+    template <typename InputItB, typename InputItW>
+    piecewise_linear_sampler(InputItB first_b, InputItB last_b, InputItW first_w) {
+      std::vector<RealType> intervals(first_b, last_b);
+      std::vector<RealType> densities;
+      for (auto i = 0u; i < intervals.size(); ++i, ++first_w) {
+        densities.push_back(static_cast<RealType>(*first_w));
+      }
+      build(std::move(intervals), std::move(densities));
+    }
+
+    /// Boundaries @a bl, and the density fw at each of them. Less than two
+    /// boundaries make a uniform distribution on [0, 1), like
+    /// std::piecewise_linear_distribution.
+    template <typename UnaryOperation>
+    piecewise_linear_sampler(std::initializer_list<RealType> bl, UnaryOperation fw) {
+      if (bl.size() < 2u) {
+        build({RealType(0), RealType(1)}, {RealType(1), RealType(1)});
+      } else {
+        build_from_function(std::vector<RealType>(bl), fw);
+      }
+    }
+
+    /// @a nw intervals of equal length covering [xmin, xmax), or a single
+    /// one if @a nw is zero, with density fw at the boundaries.
+    template <typename UnaryOperation>
+    piecewise_linear_sampler(std::size_t nw, RealType xmin, RealType xmax, UnaryOperation fw) {
+      build_from_function(detail::uniform_boundaries(nw, xmin, xmax), fw);
+    }
+
+    result_type min() const {
+      return _intervals.front();
+    }
+
+    result_type max() const {
+      return _intervals.back();
+    }
+
+    void reset() {}
+
+    template <typename URBG>
+    result_type operator()(URBG &engine) const {
+      return quantile(detail::to_unit_real<RealType>(detail::random_u64(engine)));
+    }
+
+    template <typename URBG>
+    void generate(URBG &engine, mutable_array_view<result_type> output) const {
+      for (auto &value : output) {
+        value = (*this)(engine);
+      }
+    }
+
+    /// Inverse of the cumulative distribution function, @a u in [0, 1).
+    result_type quantile(RealType u) const {
+      const auto i = _table.find(u);
+      const auto mass = u * _table.total() - _table.cdf(i);
+      const auto length = _intervals[i + 1u] - _intervals[i];
+      const auto w0 = _densities[i];
+      const auto slope = (_densities[i + 1u] - w0) / length;
+      // Solves w0 x + slope x^2 / 2 = mass, in a form that is stable for
+      // slope close to zero.
+      const auto root = std::sqrt(std::max(RealType(0), w0 * w0 + RealType(2) * slope * mass));
+      const auto denominator = w0 + root;
+      const auto x = denominator > RealType(0) ? RealType(2) * mass / denominator : RealType(0);
+      return std::min(_intervals[i] + x, _intervals[i + 1u]);
+    }
+
+  private:
+
+    template <typename UnaryOperation>
+    void build_from_function(std::vector<RealType> intervals, UnaryOperation fw) {
+      std::vector<RealType> densities;
+      for (auto x : intervals) {
+        densities.push_back(static_cast<RealType>(fw(x)));
+      }
+      build(std::move(intervals), std::move(densities));
+    }
+
+    void build(std::vector<RealType> intervals, std::vector<RealType> densities) {
+      if (intervals.size() < 2u) {
+        throw std::invalid_argument("at least two interval boundaries required");
+      }
+      _intervals = std::move(intervals);
+      _densities = std::move(densities);
+      std::vector<RealType> masses(_intervals.size() - 1u);
+      for (auto i = 0u; i < masses.size(); ++i) {
+        const auto length = _intervals[i + 1u] - _intervals[i];
+        masses[i] = RealType(0.5) * (_densities[i] + _densities[i + 1u]) * length;
+      }
+      _table = detail::guide_table<RealType>(masses);
+    }
+
+    std::vector<RealType> _intervals;
+
+    std::vector<RealType> _densities;
+
+    detail::guide_table<RealType> _table;
+  };
+
+} // namespace crypto
@@ -0,0 +1,328 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/engine_state.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace crypto {
+
+namespace detail {
+
+  /// Polynomials over GF(2), bit i of word i / 64 holding the coefficient of
+  /// t^i.
+  using gf2_polynomial = std::vector<std::uint64_t>;
+
+  static inline bool get_bit(const gf2_polynomial &p, std::size_t i) {
+    return ((p[i / 64u] >> (i % 64u)) & 1u) != 0u;
+  }
+
+  static inline void flip_bit(gf2_polynomial &p, std::size_t i) {
+    p[i / 64u] ^= std::uint64_t(1u) << (i % 64u);
+  }
+
+  static inline bool parity(std::uint64_t x) {
+    x ^= x >> 32;
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return (x & 1u) != 0u;
+  }
+
+  /// @a dst ^= @a src * t^@a shift, ignoring the bits beyond the size of
+  /// @a dst.
+  static inline void xor_shifted(gf2_polynomial &dst, const gf2_polynomial &src, std::size_t shift) {
+    const auto words = shift / 64u;
+    const auto bits = shift % 64u;
+    for (auto i = 0u; i < src.size() && i + words < dst.size(); ++i) {
+      dst[i + words] ^= src[i] << bits;
+      if (bits > 0u && i + words + 1u < dst.size()) {
+        dst[i + words + 1u] ^= src[i] >> (64u - bits);
+      }
+    }
+  }
+
+  /// Minimal polynomial of the linear recurrence generating @a bits, with
+  /// the Berlekamp-Massey algorithm. Returns the characteristic polynomial
+  /// phi(t) = t^L + c(1) t^(L-1) + ... + c(L) of the recurrence
+  /// s(i) = c(1) s(i-1) + ... + c(L) s(i-L).
+  static inline gf2_polynomial berlekamp_massey(const std::vector<bool> &bits) {
+    const auto size = bits.size();
+    const auto words = size / 64u + 2u;
+    // The sequence reversed, so that s(i - j) for j = 0, 1, ... are
+    // consecutive bits starting at size - 1 - i.
+    gf2_polynomial reversed(words, 0u);
+    for (auto i = 0u; i < size; ++i) {
+      if (bits[i]) {
+        flip_bit(reversed, size - 1u - i);
+      }
+    }
+    gf2_polynomial c(words, 0u);
+    gf2_polynomial b(words, 0u);
+    c[0u] = b[0u] = 1u;
+    std::size_t length = 0u;
+    std::size_t shift = 1u;
+    for (auto i = 0u; i < size; ++i) {
+      // Discrepancy, sum of c(j) s(i - j) for j in [0, length].
+      const auto offset = size - 1u - i;
+      std::uint64_t sum = 0u;
+      for (auto w = 0u; w <= length / 64u; ++w) {
+        const auto bit = offset + 64u * w;
+        auto window = reversed[bit / 64u] >> (bit % 64u);
+        if (bit % 64u > 0u) {
+          window |= reversed[bit / 64u + 1u] << (64u - bit % 64u);
+        }
+        sum ^= c[w] & window;
+      }
+      if (parity(sum)) {
+        if (2u * length <= i) {
+          auto previous = c;
+          xor_shifted(c, b, shift);
+          length = i + 1u - length;
+          b = std::move(previous);
+          shift = 1u;
+        } else {
+          xor_shifted(c, b, shift);
+          ++shift;
+        }
+      } else {
+        ++shift;
+      }
+    }
+    gf2_polynomial phi(length / 64u + 1u, 0u);
+    for (auto j = 0u; j <= length; ++j) {
+      if (get_bit(c, j)) {
+        flip_bit(phi, length - j);
+      }
+    }
+    return phi;
+  }
+
+  /// Arithmetic modulo a polynomial phi of degree d.
+  class gf2_modulus {
+  public:
+
+    explicit gf2_modulus(const gf2_polynomial &phi) {
+      _degree = phi.size() * 64u;
+      while (_degree-- > 0u && !get_bit(phi, _degree)) {}
+      _words = _degree / 64u + 1u;
+      // phi * t^k for every k in [0, 64), to reduce with aligned words.
+      for (auto k = 0u; k < 64u; ++k) {
+        _shifted[k].assign(_words + 1u, 0u);
+        xor_shifted(_shifted[k], phi, k);
+      }
+    }
+
+    std::size_t degree() const {
+      return _degree;
+    }
+
+    /// t^@a n mod phi.
+    gf2_polynomial power_of_t(std::uint64_t n) const {
+      gf2_polynomial result(_words, 0u);
+      result[0u] = 1u;
+      for (auto bit = 64u; bit-- > 0u;) {
+        square(result);
+        if ((n >> bit) & 1u) {
+          multiply_by_t(result);
+        }
+      }
+      return result;
+    }
+
+  private:
+
+    void square(gf2_polynomial &p) const {
+      // The square of a polynomial over GF(2) spreads its coefficients.
+      gf2_polynomial s(2u * _words + 1u, 0u);
+      for (auto i = 0u; i < _words; ++i) {
+        s[2u * i] = spread(static_cast<std::uint32_t>(p[i]));
+        s[2u * i + 1u] = spread(static_cast<std::uint32_t>(p[i] >> 32));
+      }
+      reduce(s);
+      s.resize(_words);
+      p = std::move(s);
+    }
+
+    void multiply_by_t(gf2_polynomial &p) const {
+      p.push_back(0u);
+      for (auto i = p.size() - 1u; i > 0u; --i) {
+        p[i] = (p[i] << 1) | (p[i - 1u] >> 63);
+      }
+      p[0u] <<= 1;
+      reduce(p);
+      p.resize(_words);
+    }
+
+    /// Reduces @a p in place, clearing every coefficient above the degree.
+    void reduce(gf2_polynomial &p) const {
+      for (auto i = p.size() * 64u; i-- > _degree;) {
+        if (get_bit(p, i)) {
+          const auto shift = i - _degree;
+          const auto &phi = _shifted[shift % 64u];
+          const auto offset = shift / 64u;
+          for (auto w = 0u; w < phi.size() && w + offset < p.size(); ++w) {
+            p[w + offset] ^= phi[w];
+          }
+        }
+      }
+    }
+
+    static std::uint64_t spread(std::uint32_t value) {
+      std::uint64_t x = value;
+      x = (x | (x << 16)) & 0x0000ffff0000ffffu;
+      x = (x | (x << 8)) & 0x00ff00ff00ff00ffu;
+      x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0fu;
+      x = (x | (x << 2)) & 0x3333333333333333u;
+      x = (x | (x << 1)) & 0x5555555555555555u;
+      return x;
+    }
+
+    std::size_t _degree;
+
+    std::size_t _words;
+
+    gf2_polynomial _shifted[64u];
+  };
+
+  /// Jumps of a Mersenne Twister engine, with the polynomial method of
+  /// Haramoto, Matsumoto, Nishimura, Panneton and L'Ecuyer, "Efficient Jump
+  /// Ahead for F2-Linear Random Number Generators" (2008). If phi is the
+  /// characteristic polynomial of the transition F, F^n = p(F) for
+  /// p(t) = t^n mod phi, that is evaluated on the state with Horner's rule
+  /// in O(deg(phi)) steps of the recurrence.
+  template <typename ENGINE>
+  struct mersenne_twister_jump;
+
+  template <
+      typename UIntType, std::size_t W, std::size_t N, std::size_t M, std::size_t R,
+      UIntType A, std::size_t U, UIntType D, std::size_t S, UIntType B,
+      std::size_t T, UIntType C, std::size_t L, UIntType F>
+  struct mersenne_twister_jump<std::mersenne_twister_engine<UIntType, W, N, M, R, A, U, D, S, B, T, C, L, F>> {
+    using engine_type = std::mersenne_twister_engine<UIntType, W, N, M, R, A, U, D, S, B, T, C, L, F>;
+
+    using state = engine_state<engine_type>;
+
+    /// Shorter jumps are cheaper with discard().
+    static constexpr std::uint64_t min_jump = 1u << 20;
+
+    static void jump(engine_type &engine, std::uint64_t n) {
+      if (n < min_jump) {
+        engine.discard(n);
+        return;
+      }
+      // Consecutive jumps usually have the same length.
+      thread_local std::uint64_t last_n = 0u;
+      thread_local gf2_polynomial last_p;
+      if (last_n != n || last_p.empty()) {
+        last_p = modulus().power_of_t(n);
+        last_n = n;
+      }
+      const auto &p = last_p;
+
+      const auto x = state::state(engine);
+      std::vector<UIntType> acc(N, 0u);
+      std::size_t start = 0u;
+      for (auto i = modulus().degree() + 1u; i-- > 0u;) {
+        // acc = F(acc)
+        const auto next = [&](std::size_t j) {
+          return j < N ? j : j - N;
+        };
+        const auto y = (acc[start] & state::upper_mask) | (acc[next(start + 1u)] & state::lower_mask);
+        acc[start] = acc[next(start + M)] ^ (y >> 1) ^ ((y & 1u) != 0u ? A : UIntType(0u));
+        start = next(start + 1u);
+        if (get_bit(p, i)) {
+          const auto head = N - start;
+          for (auto j = 0u; j < head; ++j) {
+            acc[start + j] ^= x[j];
+          }
+          for (auto j = head; j < N; ++j) {
+            acc[j - head] ^= x[j];
+          }
+        }
+      }
+      std::vector<UIntType> result(N);
+      for (auto j = 0u; j < N; ++j) {
+        result[j] = acc[(start + j) % N];
+      }
+      state::set_state(engine, result);
+    }
+
+  private:
+
+    /// The characteristic polynomial of the engine, computed once from the
+    /// lowest bit of its output.
+    static const gf2_modulus &modulus() {
+      static const gf2_modulus result = [] {
+        constexpr auto degree = N * W - R;
+        engine_type engine;
+        std::vector<bool> bits(2u * degree + 64u);
+        for (auto i = 0u; i < bits.size(); ++i) {
+          bits[i] = (engine() & 1u) != 0u;
+        }
+        return gf2_modulus(berlekamp_massey(bits));
+      }();
+      return result;
+    }
+  };
+
+} // namespace detail
+
+  /// @name Jump ahead
+  /// @{
+
+  /// Advances @a engine by @a n values, equivalent to engine.discard(n).
+  template <typename ENGINE>
+  void jump_ahead(ENGINE &engine, unsigned long long n) {
+    engine.discard(n);
+  }
+
+  /// Advances a linear congruential engine by @a n values in O(log n) steps,
+  /// with Brown's "Random Number Generation with Arbitrary Stride" (1994).
+  template <typename UIntType, UIntType A, UIntType C, UIntType M>
+  void jump_ahead(std::linear_congruential_engine<UIntType, A, C, M> &engine, unsigned long long n) {
+    using state = detail::engine_state<std::linear_congruential_engine<UIntType, A, C, M>>;
+    const std::uint64_t m = M;
+    std::uint64_t multiplier = A % m;
+    std::uint64_t increment = C % m;
+    std::uint64_t acc_mult = 1u;
+    std::uint64_t acc_plus = 0u;
+    for (; n > 0u; n >>= 1) {
+      if (n & 1u) {
+        acc_mult = acc_mult * multiplier % m;
+        acc_plus = (acc_plus * multiplier + increment) % m;
+      }
+      increment = (multiplier + 1u) * increment % m;
+      multiplier = multiplier * multiplier % m;
+    }
+    engine.seed(static_cast<UIntType>((acc_mult * state::state(engine) + acc_plus) % m));
+  }
+
+  /// Advances a Mersenne Twister engine by @a n values in O(log n)
+  /// polynomial operations. The characteristic polynomial of the engine is
+  /// computed on the first call, and the jump polynomial of the last
+  /// distance is cached per thread, so that splitting a stream into many
+  /// substreams of the same length only pays for it once.
+  template <
+      typename UIntType, std::size_t W, std::size_t N, std::size_t M, std::size_t R,
+      UIntType A, std::size_t U, UIntType D, std::size_t S, UIntType B,
+      std::size_t T, UIntType C, std::size_t L, UIntType F>
+  void jump_ahead(
+      std::mersenne_twister_engine<UIntType, W, N, M, R, A, U, D, S, B, T, C, L, F> &engine,
+      unsigned long long n) {
+    detail::mersenne_twister_jump<
+        std::mersenne_twister_engine<UIntType, W, N, M, R, A, U, D, S, B, T, C, L, F>>::jump(engine, n);
+  }
+
+  /// @}
+
+} // namespace crypto
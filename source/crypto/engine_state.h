@@ -0,0 +1,571 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/buffer_view.h"
+#include "crypto/chacha_engine.h"
+#include "crypto/counter_engine.h"
+#include "crypto/pcg_engine.h"
+#include "crypto/sfmt_engine.h"
+#include "crypto/xoshiro_engine.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace crypto {
+
+namespace detail {
+
+  inline void store_u32(byte *output, std::uint32_t value) {
+    for (auto i = 0u; i < 4u; ++i) {
+      output[i] = static_cast<byte>(value >> (8u * i));
+    }
+  }
+
+  inline void store_u64(byte *output, std::uint64_t value) {
+    store_u32(output, static_cast<std::uint32_t>(value));
+    store_u32(output + 4u, static_cast<std::uint32_t>(value >> 32));
+  }
+
+  inline std::uint32_t load_u32(const byte *input) {
+    std::uint32_t value = 0u;
+    for (auto i = 0u; i < 4u; ++i) {
+      value |= std::uint32_t(input[i]) << (8u * i);
+    }
+    return value;
+  }
+
+  inline std::uint64_t load_u64(const byte *input) {
+    return load_u32(input) | (std::uint64_t(load_u32(input + 4u)) << 32);
+  }
+
+  /// 32-bit FNV-1a of @a values, identifying the template parameters of an
+  /// engine.
+  inline std::uint32_t parameter_fingerprint(std::initializer_list<std::uint64_t> values) {
+    std::uint32_t hash = 0x811c9dc5u;
+    for (auto value : values) {
+      for (auto i = 0u; i < 8u; ++i) {
+        hash = (hash ^ static_cast<byte>(value >> (8u * i))) * 0x01000193u;
+      }
+    }
+    return hash;
+  }
+
+  /// Seed sequence that generates the given words, used to set the state of
+  /// the standard engines through seed(seq).
+  class replay_seed_seq {
+  public:
+
+    using result_type = std::uint32_t;
+
+    explicit replay_seed_seq(std::vector<std::uint32_t> words) : _words(std::move(words)) {}
+
+    template <typename OutputIt>
+    void generate(OutputIt first, OutputIt last) const {
+      for (auto i = 0u; first != last; ++first, ++i) {
+        *first = i < _words.size() ? _words[i] : 0u;
+      }
+    }
+
+    std::size_t size() const {
+      return _words.size();
+    }
+
+  private:
+
+    std::vector<std::uint32_t> _words;
+  };
+
+  /// Binary state of @a ENGINE. Specializations provide an engine id, a
+  /// fingerprint of the template parameters the id does not cover, the size
+  /// of the payload and how to save and load it; engines without one are
+  /// stored in their text representation.
+  template <typename ENGINE>
+  struct engine_state {
+    static constexpr std::uint16_t id = 0xffffu;
+
+    /// Hash of the name of the type, which tells apart different engines
+    /// stored as text, but is only stable between builds with the same
+    /// compiler.
+    static std::uint32_t fingerprint() {
+      std::uint32_t hash = 0x811c9dc5u;
+      for (const auto *c = typeid(ENGINE).name(); *c != '\0'; ++c) {
+        hash = (hash ^ static_cast<byte>(*c)) * 0x01000193u;
+      }
+      return hash;
+    }
+
+    static std::string text(const ENGINE &engine) {
+      std::ostringstream out;
+      out << engine;
+      return out.str();
+    }
+
+    static std::size_t size(const ENGINE &engine) {
+      return text(engine).size();
+    }
+
+    static void save(const ENGINE &engine, byte *output) {
+      const auto str = text(engine);
+      std::memcpy(output, str.data(), str.size());
+    }
+
+    static bool load(ENGINE &engine, const byte *input, std::size_t size) {
+      std::istringstream in(std::string(reinterpret_cast<const char *>(input), size));
+      ENGINE result;
+      in >> result;
+      if (in.fail()) {
+        return false;
+      }
+      engine = result;
+      return true;
+    }
+  };
+
+  template <typename ENGINE, std::uint16_t ID>
+  struct xoshiro_engine_state {
+    static constexpr std::uint16_t id = ID;
+
+    static std::uint32_t fingerprint() {
+      return 0u;
+    }
+
+    static constexpr std::size_t words = std::tuple_size<typename ENGINE::state_type>::value;
+
+    static std::size_t size(const ENGINE &) {
+      return 8u * words;
+    }
+
+    static void save(const ENGINE &engine, byte *output) {
+      for (auto word : engine.state()) {
+        store_u64(output, word);
+        output += 8u;
+      }
+    }
+
+    static bool load(ENGINE &engine, const byte *input, std::size_t) {
+      typename ENGINE::state_type state;
+      for (auto &word : state) {
+        word = load_u64(input);
+        input += 8u;
+      }
+      engine.set_state(state);
+      return true;
+    }
+  };
+
+  template <>
+  struct engine_state<xoshiro256starstar_engine>
+    : xoshiro_engine_state<xoshiro256starstar_engine, 0x0001u> {};
+
+  template <>
+  struct engine_state<xoroshiro128plus_engine>
+    : xoshiro_engine_state<xoroshiro128plus_engine, 0x0002u> {};
+
+  template <>
+  struct engine_state<pcg64_engine> {
+    static constexpr std::uint16_t id = 0x0003u;
+
+    static std::uint32_t fingerprint() {
+      return 0u;
+    }
+
+    static std::size_t size(const pcg64_engine &) {
+      return 32u;
+    }
+
+    static void save(const pcg64_engine &engine, byte *output) {
+      store_u64(output, engine.state().high);
+      store_u64(output + 8u, engine.state().low);
+      store_u64(output + 16u, engine.increment().high);
+      store_u64(output + 24u, engine.increment().low);
+    }
+
+    static bool load(pcg64_engine &engine, const byte *input, std::size_t) {
+      const pcg64_engine::state_type increment{load_u64(input + 16u), load_u64(input + 24u)};
+      if ((increment.low & 1u) == 0u) {
+        return false;
+      }
+      engine.set_state({load_u64(input), load_u64(input + 8u)}, increment);
+      return true;
+    }
+  };
+
+  /// Engines addressed by key, stream and position.
+  template <typename ENGINE, std::uint16_t ID>
+  struct keyed_engine_state {
+    static constexpr std::uint16_t id = ID;
+
+    static std::uint32_t fingerprint() {
+      return 0u;
+    }
+
+    using key_type = typename ENGINE::key_type;
+
+    using word_type = typename key_type::value_type;
+
+    static constexpr std::size_t key_size = sizeof(word_type) * std::tuple_size<key_type>::value;
+
+    static std::size_t size(const ENGINE &) {
+      return key_size + 16u;
+    }
+
+    static void save(const ENGINE &engine, byte *output) {
+      for (auto word : engine.key()) {
+        for (auto i = 0u; i < sizeof(word_type); ++i) {
+          *output++ = static_cast<byte>(static_cast<std::uint64_t>(word) >> (8u * i));
+        }
+      }
+      store_u64(output, engine.stream());
+      store_u64(output + 8u, engine.position());
+    }
+
+    static bool load(ENGINE &engine, const byte *input, std::size_t) {
+      key_type key;
+      for (auto &word : key) {
+        word = 0u;
+        for (auto i = 0u; i < sizeof(word_type); ++i) {
+          word |= static_cast<word_type>(static_cast<word_type>(*input++) << (8u * i));
+        }
+      }
+      engine.set_key(key, load_u64(input));
+      engine.seek(load_u64(input + 8u));
+      return true;
+    }
+  };
+
+  template <unsigned ROUNDS>
+  struct engine_state<chacha_engine<ROUNDS>>
+    : keyed_engine_state<chacha_engine<ROUNDS>, 0x0100u + ROUNDS> {};
+
+  template <>
+  struct engine_state<philox4x32_engine>
+    : keyed_engine_state<philox4x32_engine, 0x0004u> {};
+
+  template <>
+  struct engine_state<threefry4x64_engine>
+    : keyed_engine_state<threefry4x64_engine, 0x0005u> {};
+
+  /// Engines holding a block of generated words and the index of the next
+  /// one to return.
+  template <typename ENGINE, std::uint16_t ID>
+  struct block_engine_state {
+    static constexpr std::uint16_t id = ID;
+
+    static std::uint32_t fingerprint() {
+      return 0u;
+    }
+
+    using state_type = std::remove_const_t<std::remove_reference_t<decltype(std::declval<ENGINE &>().state())>>;
+
+    using word_type = typename state_type::value_type;
+
+    static constexpr std::size_t words = std::tuple_size<state_type>::value;
+
+    static std::size_t size(const ENGINE &) {
+      return 8u + sizeof(word_type) * words;
+    }
+
+    static void save(const ENGINE &engine, byte *output) {
+      store_u64(output, engine.index());
+      output += 8u;
+      for (auto word : engine.state()) {
+        if (sizeof(word_type) == 4u) {
+          store_u32(output, static_cast<std::uint32_t>(word));
+        } else {
+          store_u64(output, static_cast<std::uint64_t>(word));
+        }
+        output += sizeof(word_type);
+      }
+    }
+
+    static bool load(ENGINE &engine, const byte *input, std::size_t) {
+      const auto index = load_u64(input);
+      if (index > ENGINE::state_size) {
+        return false;
+      }
+      input += 8u;
+      state_type state;
+      for (auto &word : state) {
+        word = static_cast<word_type>(sizeof(word_type) == 4u ? load_u32(input) : load_u64(input));
+        input += sizeof(word_type);
+      }
+      engine.set_state(state, static_cast<std::size_t>(index));
+      return true;
+    }
+  };
+
+  template <>
+  struct engine_state<sfmt19937_engine>
+    : block_engine_state<sfmt19937_engine, 0x0007u> {};
+
+  template <>
+  struct engine_state<dsfmt19937_engine>
+    : block_engine_state<dsfmt19937_engine, 0x0008u> {};
+
+  /// The state of a linear congruential engine is its last output, which is
+  /// recovered from the next one of a copy.
+  template <typename UIntType, UIntType A, UIntType C, UIntType M>
+  struct engine_state<std::linear_congruential_engine<UIntType, A, C, M>> {
+    using engine_type = std::linear_congruential_engine<UIntType, A, C, M>;
+
+    static_assert(M != 0u && M - 1u <= 0xffffffffu, "unsupported modulus");
+
+    static constexpr std::uint16_t id = 0x0006u;
+
+    static std::uint32_t fingerprint() {
+      return parameter_fingerprint({A, C, M});
+    }
+
+    /// The current state x, such that the next value is (A x + C) mod M.
+    static std::uint64_t state(const engine_type &engine) {
+      auto copy = engine;
+      const std::uint64_t next = copy();
+      const std::uint64_t m = M;
+      static const auto a_inverse = inverse();
+      return ((next + m - C % m) % m) * a_inverse % m;
+    }
+
+    static std::size_t size(const engine_type &) {
+      return 32u;
+    }
+
+    static void save(const engine_type &engine, byte *output) {
+      store_u64(output, A);
+      store_u64(output + 8u, C);
+      store_u64(output + 16u, M);
+      store_u64(output + 24u, state(engine));
+    }
+
+    static bool load(engine_type &engine, const byte *input, std::size_t) {
+      const auto x = load_u64(input + 24u);
+      if (load_u64(input) != A || load_u64(input + 8u) != C || load_u64(input + 16u) != M || x >= M) {
+        return false;
+      }
+      engine.seed(static_cast<UIntType>(x));
+      return true;
+    }
+
+  private:
+
+    /// A^-1 mod M.
+    static std::uint64_t inverse() {
+      static_assert(A % M != 0u, "multiplier must be invertible");
+      std::int64_t t = 0;
+      std::int64_t new_t = 1;
+      std::int64_t r = static_cast<std::int64_t>(M);
+      std::int64_t new_r = static_cast<std::int64_t>(A % M);
+      while (new_r != 0) {
+        const auto q = r / new_r;
+        t = t - q * new_t;
+        r = r - q * new_r;
+        std::swap(t, new_t);
+        std::swap(r, new_r);
+      }
+      if (r != 1) {
+        throw std::runtime_error("engine state is not recoverable");
+      }
+      return static_cast<std::uint64_t>(t < 0 ? t + static_cast<std::int64_t>(M) : t);
+    }
+  };
+
+  /// Mersenne Twister engines. Their state X(i - n), ..., X(i - 1) is not
+  /// accessible, so it is recovered from the next n values of a copy by
+  /// inverting the tempering and then the recurrence, and restored through
+  /// seed(seq), which the standard specifies to set these words. Only the
+  /// lowest r bits of X(i - n) are lost, which do not affect the output.
+  template <
+      typename UIntType, std::size_t W, std::size_t N, std::size_t M, std::size_t R,
+      UIntType A, std::size_t U, UIntType D, std::size_t S, UIntType B,
+      std::size_t T, UIntType C, std::size_t L, UIntType F>
+  struct engine_state<std::mersenne_twister_engine<UIntType, W, N, M, R, A, U, D, S, B, T, C, L, F>> {
+    using engine_type = std::mersenne_twister_engine<UIntType, W, N, M, R, A, U, D, S, B, T, C, L, F>;
+
+    static_assert(W == 32u || W == 64u, "unsupported word size");
+    static_assert(((A >> (W - 1u)) & 1u) == 1u, "unsupported twist matrix");
+
+    static constexpr std::uint16_t id = 0x0200u + W;
+
+    static std::uint32_t fingerprint() {
+      return parameter_fingerprint({W, N, M, R, A, U, D, S, B, T, C, L, F});
+    }
+
+    static constexpr UIntType word_mask = static_cast<UIntType>(~UIntType(0u) >> (8u * sizeof(UIntType) - W));
+
+    static constexpr UIntType lower_mask = static_cast<UIntType>((UIntType(1u) << R) - 1u);
+
+    static constexpr UIntType upper_mask = word_mask & ~lower_mask;
+
+    /// X(i - n), ..., X(i - 1).
+    static std::vector<UIntType> state(const engine_type &engine) {
+      auto copy = engine;
+      std::vector<UIntType> x(2u * N, 0u);
+      for (auto j = N; j < 2u * N; ++j) {
+        x[j] = untemper(static_cast<UIntType>(copy()));
+      }
+      for (auto j = N; j-- > 0u;) {
+        // x[j + n] = x[j + m] ^ twist(upper(x[j]) | lower(x[j + 1])).
+        const auto t = x[j + N] ^ x[j + M];
+        const bool odd = ((t >> (W - 1u)) & 1u) != 0u;
+        const auto y = static_cast<UIntType>((((odd ? t ^ A : t) << 1) | (odd ? 1u : 0u)) & word_mask);
+        x[j] = (x[j] & lower_mask) | (y & upper_mask);
+        x[j + 1u] = (x[j + 1u] & upper_mask) | (y & lower_mask);
+      }
+      x.resize(N);
+      return x;
+    }
+
+    static void set_state(engine_type &engine, const std::vector<UIntType> &x) {
+      std::vector<std::uint32_t> words;
+      words.reserve(N * W / 32u);
+      for (auto word : x) {
+        for (auto i = 0u; i < W / 32u; ++i) {
+          words.push_back(static_cast<std::uint32_t>(static_cast<std::uint64_t>(word) >> (32u * i)));
+        }
+      }
+      replay_seed_seq seq(std::move(words));
+      engine.seed(seq);
+    }
+
+    static std::size_t size(const engine_type &) {
+      return N * W / 8u;
+    }
+
+    static void save(const engine_type &engine, byte *output) {
+      for (auto word : state(engine)) {
+        if (W == 32u) {
+          store_u32(output, static_cast<std::uint32_t>(word));
+        } else {
+          store_u64(output, static_cast<std::uint64_t>(word));
+        }
+        output += W / 8u;
+      }
+    }
+
+    static bool load(engine_type &engine, const byte *input, std::size_t) {
+      std::vector<UIntType> x(N);
+      for (auto &word : x) {
+        word = static_cast<UIntType>(W == 32u ? load_u32(input) : load_u64(input));
+        input += W / 8u;
+      }
+      set_state(engine, x);
+      return true;
+    }
+
+  private:
+
+    static UIntType unshift_right(UIntType y, std::size_t shift, UIntType mask) {
+      auto x = y;
+      for (auto i = 0u; i * shift < W; ++i) {
+        x = y ^ ((x >> shift) & mask);
+      }
+      return x & word_mask;
+    }
+
+    static UIntType unshift_left(UIntType y, std::size_t shift, UIntType mask) {
+      auto x = y;
+      for (auto i = 0u; i * shift < W; ++i) {
+        x = y ^ ((x << shift) & mask);
+      }
+      return x & word_mask;
+    }
+
+    static UIntType untemper(UIntType z) {
+      auto y = unshift_right(z, L, word_mask);
+      y = unshift_left(y, T, C);
+      y = unshift_left(y, S, B);
+      return unshift_right(y, U, D);
+    }
+  };
+
+  constexpr std::uint32_t engine_state_magic = 0x474e5243u; // "CRNG"
+
+  constexpr std::uint16_t engine_state_version = 1u;
+
+  constexpr std::size_t engine_state_header_size = 16u;
+
+} // namespace detail
+
+  /// @name Engine state
+  ///
+  /// Compact binary checkpoints of the engines. A 16-byte header holding a
+  /// magic number, the format version, the engine id, the size of the
+  /// payload and a fingerprint of the engine parameters is followed by the
+  /// state of the engine, all little-endian. Engines without a binary format
+  /// are stored in their text representation.
+  /// @{
+
+  /// Size in bytes of the state of @a engine.
+  template <typename ENGINE>
+  std::size_t engine_state_size(const ENGINE &engine) {
+    return detail::engine_state_header_size + detail::engine_state<ENGINE>::size(engine);
+  }
+
+  /// Writes the state of @a engine to @a buffer, and returns the number of
+  /// bytes written. Throws std::invalid_argument if @a buffer is too small.
+  template <typename ENGINE>
+  std::size_t save_engine_state(const ENGINE &engine, mutable_buffer_view buffer) {
+    using state = detail::engine_state<ENGINE>;
+    const auto payload = state::size(engine);
+    const auto size = detail::engine_state_header_size + payload;
+    if (buffer.size() < size) {
+      throw std::invalid_argument("buffer too small for engine state");
+    }
+    auto *output = buffer.data();
+    detail::store_u32(output, detail::engine_state_magic);
+    output[4u] = static_cast<byte>(detail::engine_state_version);
+    output[5u] = static_cast<byte>(detail::engine_state_version >> 8);
+    output[6u] = static_cast<byte>(state::id);
+    output[7u] = static_cast<byte>(state::id >> 8);
+    detail::store_u32(output + 8u, static_cast<std::uint32_t>(payload));
+    detail::store_u32(output + 12u, state::fingerprint());
+    state::save(engine, output + detail::engine_state_header_size);
+    return size;
+  }
+
+  /// Restores the state written by save_engine_state. Throws
+  /// std::invalid_argument if @a buffer does not hold a valid state of an
+  /// engine of the same type, in which case @a engine is not modified.
+  template <typename ENGINE>
+  void load_engine_state(ENGINE &engine, const_buffer_view buffer) {
+    using state = detail::engine_state<ENGINE>;
+    const auto *input = buffer.data();
+    if (buffer.size() < detail::engine_state_header_size ||
+        detail::load_u32(input) != detail::engine_state_magic) {
+      throw std::invalid_argument("invalid engine state");
+    }
+    const auto version = input[4u] | (input[5u] << 8);
+    const auto id = input[6u] | (input[7u] << 8);
+    const auto payload = detail::load_u32(input + 8u);
+    const auto fingerprint = detail::load_u32(input + 12u);
+    if (version != detail::engine_state_version || id != state::id || fingerprint != state::fingerprint()) {
+      throw std::invalid_argument("engine state of a different engine or version");
+    }
+    if (buffer.size() - detail::engine_state_header_size < payload ||
+        (state::id != 0xffffu && payload != state::size(engine))) {
+      throw std::invalid_argument("invalid engine state");
+    }
+    ENGINE result = engine;
+    if (!state::load(result, input + detail::engine_state_header_size, payload)) {
+      throw std::invalid_argument("invalid engine state");
+    }
+    engine = result;
+  }
+
+  /// @}
+
+} // namespace crypto
@@ -0,0 +1,260 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "crypto/entropy.h"
+
+#include "crypto/trace.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <mutex>
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#  include <fcntl.h>
+#  include <pthread.h>
+#  include <unistd.h>
+#  define CRYPTO_ENTROPY_UNIX 1
+#endif
+
+#if defined(__linux__)
+#  include <sys/syscall.h>
+#  if defined(SYS_getrandom)
+#    define CRYPTO_ENTROPY_GETRANDOM 1
+#  endif
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#  include <cpuid.h>
+#  include <immintrin.h>
+#  define CRYPTO_ENTROPY_X86 1
+#endif
+
+namespace crypto {
+namespace detail {
+
+  namespace {
+
+    /// Words read from the kernel at once.
+    constexpr std::size_t pool_size = 1024u;
+
+    struct entropy_pool {
+      std::mutex mutex;
+      std::array<std::uint32_t, pool_size> words;
+      std::size_t index = pool_size;
+    };
+
+    entropy_pool &get_pool() {
+      static entropy_pool pool;
+      return pool;
+    }
+
+#ifdef CRYPTO_ENTROPY_UNIX
+
+    void on_fork_prepare() {
+      get_pool().mutex.lock();
+    }
+
+    void on_fork_parent() {
+      get_pool().mutex.unlock();
+    }
+
+    /// The child would serve the same words as the parent; drop them.
+    void on_fork_child() {
+      auto &pool = get_pool();
+      pool.index = pool_size;
+      pool.mutex.unlock();
+    }
+
+    bool read_all(int fd, unsigned char *output, std::size_t size) {
+      while (size > 0u) {
+        const auto result = ::read(fd, output, size);
+        if (result <= 0) {
+          if (result < 0 && errno == EINTR) {
+            continue;
+          }
+          return false;
+        }
+        output += result;
+        size -= static_cast<std::size_t>(result);
+      }
+      return true;
+    }
+
+    bool read_urandom(unsigned char *output, std::size_t size) {
+      const int fd = ::open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        return false;
+      }
+      const bool result = read_all(fd, output, size);
+      ::close(fd);
+      return result;
+    }
+
+#endif // CRYPTO_ENTROPY_UNIX
+
+#ifdef CRYPTO_ENTROPY_GETRANDOM
+
+    /// 0 if it succeeds, otherwise the error of the last call.
+    int read_getrandom(unsigned char *output, std::size_t size) {
+      while (size > 0u) {
+        const auto result = ::syscall(SYS_getrandom, output, size, 0u);
+        if (result < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return errno;
+        }
+        output += result;
+        size -= static_cast<std::size_t>(result);
+      }
+      return 0;
+    }
+
+#endif // CRYPTO_ENTROPY_GETRANDOM
+
+    bool read_kernel_entropy(unsigned char *output, std::size_t size) {
+#if defined(CRYPTO_ENTROPY_GETRANDOM)
+      // Older kernels, or seccomp filters, may not allow the syscall.
+      static bool has_getrandom = true;
+      if (has_getrandom) {
+        const int error = read_getrandom(output, size);
+        if (error == 0) {
+          return true;
+        }
+        if (error == ENOSYS || error == EPERM) {
+          has_getrandom = false;
+        }
+      }
+#endif // CRYPTO_ENTROPY_GETRANDOM
+#if defined(CRYPTO_ENTROPY_UNIX)
+      return read_urandom(output, size);
+#else
+      (void)output;
+      (void)size;
+      return false;
+#endif // CRYPTO_ENTROPY_UNIX
+    }
+
+#ifdef CRYPTO_ENTROPY_X86
+
+    enum class hardware_rng { none, rdrand, rdseed };
+
+    /// RDRAND is preferred: it is several times faster than RDSEED and, unlike
+    /// it, does not fail under load. Its output is conditioned by the same
+    /// hardware entropy source.
+    hardware_rng detect_hardware_rng() {
+      unsigned eax, ebx, ecx, edx;
+      if (__get_cpuid(1u, &eax, &ebx, &ecx, &edx) && (ecx & bit_RDRND)) {
+        return hardware_rng::rdrand;
+      }
+      if (__get_cpuid_count(7u, 0u, &eax, &ebx, &ecx, &edx) && (ebx & bit_RDSEED)) {
+        return hardware_rng::rdseed;
+      }
+      return hardware_rng::none;
+    }
+
+#if defined(__x86_64__)
+    using hardware_word = unsigned long long;
+#  define CRYPTO_RDRAND_STEP _rdrand64_step
+#  define CRYPTO_RDSEED_STEP _rdseed64_step
+#else
+    using hardware_word = unsigned int;
+#  define CRYPTO_RDRAND_STEP _rdrand32_step
+#  define CRYPTO_RDSEED_STEP _rdseed32_step
+#endif
+
+    __attribute__((target("rdrnd")))
+    bool rdrand(hardware_word &value) {
+      for (auto i = 0u; i < 8u; ++i) {
+        if (CRYPTO_RDRAND_STEP(&value)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    __attribute__((target("rdseed")))
+    bool rdseed(hardware_word &value) {
+      // RDSEED fails when the conditioner runs out of entropy; it is only an
+      // addition to the kernel entropy, so give up soon.
+      for (auto i = 0u; i < 8u; ++i) {
+        if (CRYPTO_RDSEED_STEP(&value)) {
+          return true;
+        }
+        _mm_pause();
+      }
+      return false;
+    }
+
+    /// Mixes a hardware random word into @a output, if available.
+    void add_hardware_entropy(std::uint32_t *output, std::size_t count) {
+      static const hardware_rng source = detect_hardware_rng();
+      hardware_word value = 0u;
+      if (count == 0u ||
+          source == hardware_rng::none ||
+          !(source == hardware_rng::rdrand ? rdrand(value) : rdseed(value))) {
+        return;
+      }
+      for (auto i = 0u; i < std::min(count, sizeof(value) / sizeof(std::uint32_t)); ++i) {
+        output[i] ^= static_cast<std::uint32_t>(value >> (32u * i));
+      }
+    }
+
+#else
+
+    void add_hardware_entropy(std::uint32_t *, std::size_t) {}
+
+#endif // CRYPTO_ENTROPY_X86
+
+  } // namespace
+
+  bool system_entropy(std::uint32_t *output, std::size_t count) {
+    static std::once_flag once;
+    std::call_once(once, []() {
+#ifdef CRYPTO_ENTROPY_UNIX
+      pthread_atfork(on_fork_prepare, on_fork_parent, on_fork_child);
+#endif // CRYPTO_ENTROPY_UNIX
+    });
+
+    const auto requested = count;
+    auto *first = output;
+    CRYPTO_TRACE1(system_entropy_entry, requested);
+    {
+      auto &pool = get_pool();
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      while (count > 0u) {
+        if (pool.index == pool_size) {
+          if (count >= pool_size) {
+            // Large requests skip the pool.
+            const auto bytes = count * sizeof(std::uint32_t);
+            if (!read_kernel_entropy(reinterpret_cast<unsigned char *>(output), bytes)) {
+              CRYPTO_TRACE2(system_entropy_return, requested, 0);
+              return false;
+            }
+            break;
+          }
+          if (!read_kernel_entropy(reinterpret_cast<unsigned char *>(pool.words.data()), sizeof(pool.words))) {
+            CRYPTO_TRACE2(system_entropy_return, requested, 0);
+            return false;
+          }
+          pool.index = 0u;
+        }
+        const auto n = std::min(count, pool_size - pool.index);
+        std::copy_n(&pool.words[pool.index], n, output);
+        // Never serve the same words twice.
+        std::fill_n(&pool.words[pool.index], n, 0u);
+        pool.index += n;
+        output += n;
+        count -= n;
+      }
+    }
+    add_hardware_entropy(first, requested);
+    CRYPTO_TRACE2(system_entropy_return, requested, 1);
+    return true;
+  }
+
+} // namespace detail
+} // namespace crypto
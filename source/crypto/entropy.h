@@ -0,0 +1,26 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace crypto {
+namespace detail {
+
+  /// Fills @a output with @a count words of system entropy, taken from a
+  /// per-process pool that is refilled from the kernel (getrandom() or
+  /// /dev/urandom) in large batches. When the CPU supports RDRAND (or else
+  /// RDSEED), a hardware random value is mixed into every request as well. The pool
+  /// is discarded in the child after fork(), so parent and child never share
+  /// entropy.
+  ///
+  /// Thread-safe. Returns false, leaving @a output unspecified, if no
+  /// kernel source of entropy is available.
+  bool system_entropy(std::uint32_t *output, std::size_t count);
+
+} // namespace detail
+} // namespace crypto
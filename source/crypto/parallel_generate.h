@@ -0,0 +1,94 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/counter_engine.h"
+#include "crypto/detail/parallel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <thread>
+
+namespace crypto {
+
+namespace detail {
+
+  /// Seed sequence expanding a 64-bit seed with SplitMix64.
+  class splitmix_seed_seq {
+  public:
+
+    using result_type = std::uint32_t;
+
+    explicit splitmix_seed_seq(std::uint64_t seed) : _state(seed) {}
+
+    template <typename OutputIt>
+    void generate(OutputIt first, OutputIt last) {
+      for (; first != last; ++first) {
+        *first = static_cast<result_type>(splitmix64(_state) >> 32);
+      }
+    }
+
+  private:
+
+    std::uint64_t _state;
+  };
+
+} // namespace detail
+
+  /// Fills [first, last) with values of @a distribution on up to @a threads
+  /// threads. The i-th value is drawn from stream i of a counter-based
+  /// @a ENGINE keyed with @a seed, after resetting the distribution, so it
+  /// only depends on @a seed and i: the output is the same for any number of
+  /// threads, and any part of the range can be generated on its own.
+  ///
+  /// Every value gets a stream of 2^64 values, so distributions that reject
+  /// or draw several numbers per value work as well.
+  ///
+  /// @a first_index is the index of @a first, for generating a part of a
+  /// larger range.
+  template <typename ENGINE = philox4x32_engine, typename RandomIt, typename DISTRIBUTION>
+  void parallel_generate(
+      RandomIt first,
+      RandomIt last,
+      const DISTRIBUTION &distribution,
+      std::uint64_t seed,
+      unsigned threads = std::thread::hardware_concurrency(),
+      std::uint64_t first_index = 0u) {
+    const auto size = static_cast<std::size_t>(std::distance(first, last));
+    detail::splitmix_seed_seq seq(seed);
+    const auto key = ENGINE(seq).key();
+    threads = std::max(threads, 1u);
+    // Several chunks per thread balance the load; the result does not depend
+    // on the chunks.
+    const std::size_t chunk_size = std::max<std::size_t>(size / (8u * threads), 1024u);
+    const auto chunks = (size + chunk_size - 1u) / chunk_size;
+    detail::run_parallel(chunks, threads, [&](std::size_t chunk) {
+      ENGINE engine(key);
+      auto dist = distribution;
+      const auto begin = chunk * chunk_size;
+      const auto end = std::min(begin + chunk_size, size);
+      auto it = first + static_cast<std::ptrdiff_t>(begin);
+      for (auto i = begin; i < end; ++i, ++it) {
+        engine.set_stream(first_index + i);
+        dist.reset();
+        *it = dist(engine);
+      }
+    });
+  }
+
+  template <typename ENGINE = philox4x32_engine, typename Range, typename DISTRIBUTION>
+  void parallel_generate(
+      Range &&range,
+      const DISTRIBUTION &distribution,
+      std::uint64_t seed,
+      unsigned threads = std::thread::hardware_concurrency(),
+      std::uint64_t first_index = 0u) {
+    parallel_generate<ENGINE>(std::begin(range), std::end(range), distribution, seed, threads, first_index);
+  }
+
+} // namespace crypto
@@ -0,0 +1,115 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/chacha_engine.h"
+#include "crypto/detail/parallel.h"
+#include "crypto/random_bits.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace crypto {
+namespace detail {
+
+  template <typename RandomIt, typename ENGINE>
+  static void fisher_yates(RandomIt first, std::size_t size, ENGINE &engine) {
+    for (auto i = size; i > 1u; --i) {
+      std::iter_swap(first + (i - 1u), first + bounded_u64(engine, i));
+    }
+  }
+
+  /// Shuffles [first, first + size) by scattering the elements into random
+  /// buckets of about @a bucket_size elements, and then shuffling every
+  /// bucket with Fisher-Yates (Sanders, 1998). Every element picks its bucket
+  /// independently, so the result is a uniform permutation. Apart from the
+  /// scatter, that writes sequentially to each bucket, all the accesses stay
+  /// within a bucket small enough to be cache resident. Needs a temporary
+  /// copy of the range.
+  ///
+  /// The range is split into @a threads chunks that pick buckets in
+  /// parallel. Chunk i draws from ChaCha8 stream i of @a key and bucket j
+  /// from stream threads + j, so the result does not depend on the
+  /// scheduling of the threads.
+  template <typename RandomIt>
+  static void scatter_shuffle(
+      RandomIt first,
+      std::size_t size,
+      const chacha8_engine::key_type &key,
+      unsigned threads,
+      std::size_t bucket_size) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    constexpr std::size_t max_buckets = 1u << 16;
+    const std::size_t chunks = threads;
+    const auto buckets = std::min(
+        max_buckets,
+        std::max<std::size_t>(chunks, (size + bucket_size - 1u) / bucket_size));
+    if (buckets <= 1u) {
+      chacha8_engine engine(key, chunks);
+      fisher_yates(first, size, engine);
+      return;
+    }
+    auto chunk_begin = [&](std::size_t chunk) {
+      return chunk * (size / chunks) + (chunk * (size % chunks)) / chunks;
+    };
+
+    // Pick the bucket of every element, and count them per chunk.
+    std::vector<std::uint16_t> bucket_of(size);
+    std::vector<std::size_t> offsets(chunks * buckets, 0u);
+    run_parallel(chunks, threads, [&](std::size_t chunk) {
+      chacha8_engine engine(key, chunk);
+      auto counts = offsets.begin() + static_cast<std::ptrdiff_t>(chunk * buckets);
+      const auto begin = chunk_begin(chunk);
+      const auto end = chunk_begin(chunk + 1u);
+      uniform_fill<std::uint16_t>(
+          engine, engine, bucket_of.data() + begin, end - begin,
+          0u, static_cast<std::uint16_t>(buckets - 1u));
+      for (auto i = begin; i < end; ++i) {
+        ++counts[bucket_of[i]];
+      }
+    });
+
+    // Bucket-major prefix sums, chunk i writes its part of bucket j at
+    // offsets[i * buckets + j].
+    std::vector<std::size_t> bucket_begin(buckets + 1u, 0u);
+    std::size_t total = 0u;
+    for (auto bucket = 0u; bucket < buckets; ++bucket) {
+      bucket_begin[bucket] = total;
+      for (auto chunk = 0u; chunk < chunks; ++chunk) {
+        auto &offset = offsets[chunk * buckets + bucket];
+        const auto count = offset;
+        offset = total;
+        total += count;
+      }
+    }
+    bucket_begin[buckets] = total;
+
+    std::vector<value_type> buffer(
+        std::make_move_iterator(first),
+        std::make_move_iterator(first + static_cast<std::ptrdiff_t>(size)));
+    run_parallel(chunks, threads, [&](std::size_t chunk) {
+      auto cursors = offsets.begin() + static_cast<std::ptrdiff_t>(chunk * buckets);
+      for (auto i = chunk_begin(chunk); i < chunk_begin(chunk + 1u); ++i) {
+        auto &cursor = cursors[bucket_of[i]];
+        first[static_cast<std::ptrdiff_t>(cursor++)] = std::move(buffer[i]);
+      }
+    });
+
+    run_parallel(buckets, threads, [&](std::size_t bucket) {
+      chacha8_engine engine(key, chunks + bucket);
+      const auto begin = bucket_begin[bucket];
+      fisher_yates(
+          first + static_cast<std::ptrdiff_t>(begin),
+          bucket_begin[bucket + 1u] - begin,
+          engine);
+    });
+  }
+
+} // namespace detail
+} // namespace crypto
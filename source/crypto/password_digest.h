@@ -8,6 +8,8 @@
 #include "crypto/crypto.h"
 #include "crypto/output.h"
 #include "crypto/secure_string.h"
+#include "crypto/stats.h"
+#include "crypto/trace.h"
 
 #include <memory>
 
@@ -27,8 +29,13 @@ namespace crypto {
 
     explicit password_digest(const secure_string &password)
       : _digest([&](){
+        CRYPTO_TRACE2(password_digest_create_entry,
+            trace::digest_algorithm(sizeof(digest_type)), password.size());
+        CRYPTO_STATS_ALLOCATION(password_digest, sizeof(digest_type));
         auto ptr = std::make_shared<digest_type>();
         ::crypto::digest(password.buffer(), *ptr);
+        CRYPTO_TRACE2(password_digest_create_return,
+            trace::digest_algorithm(sizeof(digest_type)), password.size());
         return ptr;
       }()) {}
 
@@ -45,8 +52,19 @@ namespace crypto {
       return !(*this == rhs);
     }
 
+    /// Digests @a password on the stack, without allocating a
+    /// password_digest.
     bool operator==(const secure_string &password) const {
-      return (*this) == password_digest(password);
+      CRYPTO_STATS_CALL(password_digest, password.size());
+      CRYPTO_TRACE2(password_digest_compare_entry,
+          trace::digest_algorithm(sizeof(digest_type)), password.size());
+      digest_type digest;
+      ::crypto::digest(password.buffer(), digest);
+      const bool equal = (*_digest == digest);
+      ::crypto::zeroize(buffer_view::make_mutable(digest.data(), digest.size()));
+      CRYPTO_TRACE2(password_digest_compare_return,
+          trace::digest_algorithm(sizeof(digest_type)), static_cast<int>(equal));
+      return equal;
     }
 
     bool operator!=(const secure_string &password) const {
@@ -0,0 +1,188 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/random_bits.h"
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+namespace crypto {
+
+  /// PCG64 (XSL RR 128/64) by Melissa E. O'Neill. A 128-bit LCG with a
+  /// permuted 64-bit output, supporting 2^127 independent streams of period
+  /// 2^128 each. Advancing the engine by any distance takes O(log n) steps.
+  ///
+  /// Produces the same values as pcg64 of the PCG reference implementations
+  /// when seeded with the same state and stream.
+  class pcg64_engine {
+  public:
+
+    using result_type = std::uint64_t;
+
+    using state_type = detail::uint128;
+
+    static constexpr result_type default_seed = 0xcafef00dd15ea5e5u;
+
+    static constexpr result_type min() {
+      return 0u;
+    }
+
+    static constexpr result_type max() {
+      return 0xffffffffffffffffu;
+    }
+
+    pcg64_engine() : pcg64_engine(default_seed) {}
+
+    explicit pcg64_engine(result_type value) {
+      seed(value);
+    }
+
+    template <
+        typename SeedSeq,
+        typename = std::enable_if_t<
+            !std::is_convertible<SeedSeq, result_type>::value &&
+            !std::is_same<std::decay_t<SeedSeq>, pcg64_engine>::value>>
+    explicit pcg64_engine(SeedSeq &seq) {
+      seed(seq);
+    }
+
+    pcg64_engine(state_type state, state_type stream) {
+      seed(state, stream);
+    }
+
+    /// @name Seeding
+    /// @{
+
+    void seed(result_type value = default_seed) {
+      seed({0u, value}, default_stream());
+    }
+
+    template <
+        typename SeedSeq,
+        typename = std::enable_if_t<!std::is_convertible<SeedSeq, result_type>::value>>
+    void seed(SeedSeq &seq) {
+      std::array<std::uint32_t, 8u> w;
+      seq.generate(w.begin(), w.end());
+      auto make = [&](auto i) {
+        return state_type{
+          w[i] | (std::uint64_t(w[i + 1u]) << 32),
+          w[i + 2u] | (std::uint64_t(w[i + 3u]) << 32)};
+      };
+      seed(make(0u), make(4u));
+    }
+
+    /// Seeds the engine as pcg64's srandom_r(state, stream) does. The top bit
+    /// of @a stream is ignored.
+    void seed(state_type state, state_type stream) {
+      _increment = {(stream.high << 1) | (stream.low >> 63), (stream.low << 1) | 1u};
+      _state = {0u, 0u};
+      step();
+      _state = _state + state;
+      step();
+    }
+
+    /// @}
+    /// @name Generation
+    /// @{
+
+    result_type operator()() {
+      step();
+      return detail::rotr64(
+          _state.high ^ _state.low,
+          static_cast<unsigned>(_state.high >> 58));
+    }
+
+    /// @}
+    /// @name Jumping
+    /// @{
+
+    /// Advances the engine by @a delta values in O(log delta) steps.
+    void advance(state_type delta) {
+      // Brown, "Random Number Generation with Arbitrary Stride" (1994).
+      state_type multiplier = pcg64_engine::multiplier();
+      state_type increment = _increment;
+      state_type acc_mult = {0u, 1u};
+      state_type acc_plus = {0u, 0u};
+      while ((delta.high | delta.low) != 0u) {
+        if (delta.low & 1u) {
+          acc_mult = acc_mult * multiplier;
+          acc_plus = acc_plus * multiplier + increment;
+        }
+        increment = (multiplier + state_type{0u, 1u}) * increment;
+        multiplier = multiplier * multiplier;
+        delta = {delta.high >> 1, (delta.low >> 1) | (delta.high << 63)};
+      }
+      _state = acc_mult * _state + acc_plus;
+    }
+
+    void discard(unsigned long long z) {
+      advance({0u, z});
+    }
+
+    /// Equivalent to 2^64 calls to operator(). Can be used to generate 2^64
+    /// non-overlapping subsequences for parallel computations.
+    void jump() {
+      advance({1u, 0u});
+    }
+
+    /// Equivalent to 2^96 calls to operator(). Can be used to generate 2^32
+    /// starting points, from each of which jump() generates 2^32
+    /// non-overlapping subsequences.
+    void long_jump() {
+      advance({std::uint64_t(1u) << 32, 0u});
+    }
+
+    /// @}
+
+    state_type state() const {
+      return _state;
+    }
+
+    state_type increment() const {
+      return _increment;
+    }
+
+    /// Sets the state and the increment as returned by state() and
+    /// increment(). Throws std::invalid_argument if @a increment is even.
+    void set_state(state_type state, state_type increment) {
+      if ((increment.low & 1u) == 0u) {
+        throw std::invalid_argument("pcg64 increment must be odd");
+      }
+      _state = state;
+      _increment = increment;
+    }
+
+    friend bool operator==(const pcg64_engine &lhs, const pcg64_engine &rhs) {
+      return (lhs._state == rhs._state) && (lhs._increment == rhs._increment);
+    }
+
+    friend bool operator!=(const pcg64_engine &lhs, const pcg64_engine &rhs) {
+      return !(lhs == rhs);
+    }
+
+  private:
+
+    static constexpr state_type multiplier() {
+      return {2549297995355413924u, 4865540595714422341u};
+    }
+
+    static constexpr state_type default_stream() {
+      return {3182068111923396502u, 9944719557299257511u};
+    }
+
+    void step() {
+      _state = _state * multiplier() + _increment;
+    }
+
+    state_type _state;
+
+    state_type _increment;
+  };
+
+} // namespace crypto
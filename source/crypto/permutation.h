@@ -0,0 +1,337 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/array_view.h"
+#include "crypto/random_bits.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace crypto {
+
+  /// Keyed pseudo-random permutation of [0, n), evaluated lazily in O(1)
+  /// time and memory per index, for visiting huge index ranges in random
+  /// order without materializing and shuffling them.
+  ///
+  /// Indices are encrypted with a Feistel network on the smallest power of
+  /// two domain covering n, and cycle walking (Black and Rogaway, 2002)
+  /// re-encrypts the values falling outside [0, n) until they fall inside.
+  /// The halves of the network have alternating widths, so that the domain
+  /// is less than 2n and cycle walking takes less than two encryptions per
+  /// index on average.
+  ///
+  /// The round function is the splitmix64 finalizer, so permutations are
+  /// statistically random but not cryptographically secure.
+  class random_permutation {
+  public:
+
+    static constexpr std::size_t rounds = 6u;
+
+    using key_type = std::array<std::uint64_t, rounds>;
+
+    class iterator;
+
+    /// Empty permutation, with no index to evaluate.
+    random_permutation() : _size(0u), _bits(domain_bits(0u)), _key{} {}
+
+    /// Throws std::invalid_argument if @a size is zero.
+    random_permutation(std::uint64_t size, const key_type &key)
+      : _size(check_size(size)),
+        _bits(domain_bits(size)),
+        _key(key) {}
+
+    /// Permutation of [0, @a size) keyed with 384 bits drawn from @a engine.
+    /// Throws std::invalid_argument if @a size is zero.
+    template <
+        typename URBG,
+        typename = std::enable_if_t<!std::is_same<std::decay_t<URBG>, key_type>::value>>
+    random_permutation(std::uint64_t size, URBG &engine) : random_permutation(size, make_key(engine)) {}
+
+    std::uint64_t size() const {
+      return _size;
+    }
+
+    const key_type &key() const {
+      return _key;
+    }
+
+    /// @name Evaluation
+    /// @{
+
+    /// Image of index @a i. Throws std::out_of_range if @a i is not less
+    /// than size(), cycle walking would never find an image for it.
+    std::uint64_t operator()(std::uint64_t i) const {
+      check_index(i);
+      do {
+        i = encrypt(i);
+      } while (i >= _size);
+      return i;
+    }
+
+    /// Index whose image is @a j. Throws std::out_of_range if @a j is not
+    /// less than size().
+    std::uint64_t inverse(std::uint64_t j) const {
+      check_index(j);
+      do {
+        j = decrypt(j);
+      } while (j >= _size);
+      return j;
+    }
+
+    /// Fills @a output with the images of @a first, @a first + 1, ... The
+    /// rounds of blocks of indices are interleaved, which is faster than
+    /// calling operator() for every index. Throws std::out_of_range if the
+    /// indices go past size().
+    void evaluate(std::uint64_t first, mutable_array_view<std::uint64_t> output) const {
+      if ((first > _size) || (output.size() > _size - first)) {
+        throw std::out_of_range("permutation indices out of range");
+      }
+      auto *data = output.data();
+      for (std::size_t i = 0u; i < output.size(); ++i) {
+        data[i] = first + i;
+      }
+      permute(data, output.size());
+    }
+
+    /// Fills @a output with the images of @a indices. Throws
+    /// std::invalid_argument if the sizes do not match, and
+    /// std::out_of_range if an index is not less than size().
+    void evaluate(const_array_view<std::uint64_t> indices, mutable_array_view<std::uint64_t> output) const {
+      if (indices.size() != output.size()) {
+        throw std::invalid_argument("permutation output size does not match the number of indices");
+      }
+      if (std::any_of(indices.begin(), indices.end(), [this](std::uint64_t i) { return i >= _size; })) {
+        throw std::out_of_range("permutation indices out of range");
+      }
+      std::copy(indices.begin(), indices.end(), output.begin());
+      permute(output.data(), output.size());
+    }
+
+    /// @}
+    /// @name Iteration
+    /// @{
+
+    /// Iterates over the images of 0, 1, ..., size() - 1.
+    iterator begin() const;
+
+    iterator end() const;
+
+    /// @}
+
+    friend bool operator==(const random_permutation &lhs, const random_permutation &rhs) {
+      return (lhs._size == rhs._size) && (lhs._key == rhs._key);
+    }
+
+    friend bool operator!=(const random_permutation &lhs, const random_permutation &rhs) {
+      return !(lhs == rhs);
+    }
+
+  private:
+
+    static std::uint64_t check_size(std::uint64_t size) {
+      if (size == 0u) {
+        throw std::invalid_argument("permutation of an empty range");
+      }
+      return size;
+    }
+
+    void check_index(std::uint64_t i) const {
+      if (i >= _size) {
+        throw std::out_of_range("permutation index out of range");
+      }
+    }
+
+    template <typename URBG>
+    static key_type make_key(URBG &engine) {
+      key_type key;
+      for (auto &word : key) {
+        word = detail::random_u64(engine);
+      }
+      return key;
+    }
+
+    /// Bits of the smallest power of two not less than @a size, at least
+    /// two so that both halves of the network are non-empty.
+    static std::size_t domain_bits(std::uint64_t size) {
+      std::size_t bits = 2u;
+      while (bits < 64u && size > 1u && ((size - 1u) >> bits) != 0u) {
+        ++bits;
+      }
+      return bits;
+    }
+
+    static std::uint64_t mask(std::size_t bits) {
+      return (std::uint64_t(1u) << bits) - 1u;
+    }
+
+    static std::uint64_t round_function(std::uint64_t x, std::uint64_t key) {
+      auto z = x + key;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+      return z ^ (z >> 31);
+    }
+
+    /// Width of the low half entering round @a r, the high half is the
+    /// rest of the bits.
+    std::size_t low_bits(std::size_t r) const {
+      return (r % 2u == 0u) ? _bits / 2u : _bits - _bits / 2u;
+    }
+
+    /// (high, low) -> (low, high ^ F(low)).
+    std::uint64_t encrypt_round(std::uint64_t x, std::size_t r) const {
+      const auto low = low_bits(r);
+      const auto high = _bits - low;
+      const auto left = x >> low;
+      const auto right = x & mask(low);
+      return (right << high) | ((left ^ round_function(right, _key[r])) & mask(high));
+    }
+
+    std::uint64_t decrypt_round(std::uint64_t x, std::size_t r) const {
+      const auto low = low_bits(r);
+      const auto high = _bits - low;
+      const auto right = x >> high;
+      const auto left = (x ^ round_function(right, _key[r])) & mask(high);
+      return (left << low) | right;
+    }
+
+    std::uint64_t encrypt(std::uint64_t x) const {
+      for (auto r = 0u; r < rounds; ++r) {
+        x = encrypt_round(x, r);
+      }
+      return x;
+    }
+
+    std::uint64_t decrypt(std::uint64_t x) const {
+      for (auto r = rounds; r-- > 0u;) {
+        x = decrypt_round(x, r);
+      }
+      return x;
+    }
+
+    void encrypt_block(std::uint64_t *data, std::size_t count) const {
+      for (auto r = 0u; r < rounds; ++r) {
+        const auto low = low_bits(r);
+        const auto high = _bits - low;
+        const auto low_mask = mask(low);
+        const auto high_mask = mask(high);
+        const auto key = _key[r];
+        for (std::size_t i = 0u; i < count; ++i) {
+          const auto x = data[i];
+          const auto right = x & low_mask;
+          data[i] = (right << high) | (((x >> low) ^ round_function(right, key)) & high_mask);
+        }
+      }
+    }
+
+    /// Replaces every index of [data, data + count) with its image,
+    /// encrypting blocks of indices at once and walking again the ones
+    /// left outside the range.
+    void permute(std::uint64_t *data, std::size_t count) const {
+      constexpr std::size_t block = 64u;
+      std::uint64_t pending[block];
+      std::size_t where[block];
+      for (std::size_t start = 0u; start < count; start += block) {
+        auto *values = data + start;
+        const auto size = (count - start < block) ? count - start : block;
+        encrypt_block(values, size);
+        std::size_t left = 0u;
+        for (auto i = 0u; i < size; ++i) {
+          if (values[i] >= _size) {
+            where[left] = i;
+            pending[left++] = values[i];
+          }
+        }
+        while (left > 0u) {
+          encrypt_block(pending, left);
+          std::size_t next = 0u;
+          for (auto i = 0u; i < left; ++i) {
+            if (pending[i] < _size) {
+              values[where[i]] = pending[i];
+            } else {
+              where[next] = where[i];
+              pending[next++] = pending[i];
+            }
+          }
+          left = next;
+        }
+      }
+    }
+
+    std::uint64_t _size;
+
+    /// Width of the domain of the Feistel network.
+    std::size_t _bits;
+
+    key_type _key;
+  };
+
+  /// Input iterator over the images of consecutive indices, computed when
+  /// dereferenced. Dereferencing end() throws std::out_of_range.
+  class random_permutation::iterator {
+  public:
+
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::uint64_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::uint64_t *;
+    using reference = std::uint64_t;
+
+    iterator() = default;
+
+    iterator(const random_permutation &permutation, std::uint64_t index)
+      : _permutation(&permutation),
+        _index(index) {}
+
+    /// Index whose image the iterator points to.
+    std::uint64_t index() const {
+      return _index;
+    }
+
+    std::uint64_t operator*() const {
+      return (*_permutation)(_index);
+    }
+
+    iterator &operator++() {
+      ++_index;
+      return *this;
+    }
+
+    iterator operator++(int) {
+      auto result = *this;
+      ++_index;
+      return result;
+    }
+
+    friend bool operator==(const iterator &lhs, const iterator &rhs) {
+      return lhs._index == rhs._index;
+    }
+
+    friend bool operator!=(const iterator &lhs, const iterator &rhs) {
+      return !(lhs == rhs);
+    }
+
+  private:
+
+    const random_permutation *_permutation = nullptr;
+
+    std::uint64_t _index = 0u;
+  };
+
+  inline random_permutation::iterator random_permutation::begin() const {
+    return iterator(*this, 0u);
+  }
+
+  inline random_permutation::iterator random_permutation::end() const {
+    return iterator(*this, _size);
+  }
+
+} // namespace crypto
@@ -0,0 +1,331 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/random_bits.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace crypto {
+
+namespace detail {
+
+  /// Primitive polynomial and initial direction numbers of a dimension of
+  /// the Sobol sequence, as a line of Joe and Kuo's tables.
+  struct sobol_parameters {
+    /// Degree s of the polynomial.
+    std::uint16_t degree;
+    /// Coefficients of the polynomial other than the first and last ones.
+    std::uint16_t a;
+    /// Initial direction numbers m(1) ... m(s).
+    std::uint16_t m[13u];
+  };
+
+  /// Parameters of @a dimension, in [1, sobol_engine::max_dimensions).
+  /// Dimension 0 uses the identity and has no parameters.
+  const sobol_parameters &sobol_direction_numbers(std::size_t dimension);
+
+  /// First @a count primes.
+  std::vector<std::uint32_t> first_primes(std::size_t count);
+
+} // namespace detail
+
+  /// Quasi-random (low-discrepancy) points of the Sobol sequence in up to
+  /// 1024 dimensions, with the direction numbers of Joe and Kuo,
+  /// "Constructing Sobol sequences with better two-dimensional projections"
+  /// (2008). Points of a quasi-random sequence fill the unit cube much more
+  /// evenly than random points, so Monte Carlo estimates converge close to
+  /// O(1/N) instead of O(1/sqrt(N)).
+  ///
+  /// Satisfies the UniformRandomBitGenerator requirements, returning the
+  /// coordinates of consecutive points one after another as 64-bit binary
+  /// fractions, so random_engine_adaptor<sobol_engine> (crypto::sobol) maps
+  /// them with uniform, fast_uniform, uniform_n and inverse_cdf. Samplers
+  /// drawing several values per sample (e.g. normal) do not keep the low
+  /// discrepancy; use inverse_cdf with a quantile function instead.
+  ///
+  /// Points are generated in Gray code order, one XOR per coordinate, and
+  /// seek() jumps to any point in O(64) operations per coordinate, e.g. for
+  /// splitting the sequence into blocks processed in parallel.
+  ///
+  /// The first point is the origin, that quantile functions map to the
+  /// lowest value they return (e.g. -8.3 for normal_quantile); randomize()
+  /// the engine or discard the first point if that is a problem.
+  class sobol_engine {
+  public:
+
+    using result_type = std::uint64_t;
+
+    static constexpr std::size_t max_dimensions = 1024u;
+
+    static constexpr result_type min() {
+      return 0u;
+    }
+
+    static constexpr result_type max() {
+      return std::numeric_limits<result_type>::max();
+    }
+
+    /// Throws std::invalid_argument if @a dimensions is zero or greater than
+    /// max_dimensions.
+    explicit sobol_engine(std::size_t dimensions = 1u);
+
+    std::size_t dimensions() const {
+      return _dimensions;
+    }
+
+    /// Restarts the sequence at its first point, the origin.
+    void seed() {
+      seek(0u);
+    }
+
+    /// Applies a random digital shift, XORing every coordinate with random
+    /// bits drawn from @a engine. The shifted points keep the
+    /// equidistribution of the sequence, and estimates computed with
+    /// independent shifts are independent, e.g. for computing error bars.
+    template <typename URBG>
+    void randomize(URBG &engine) {
+      for (auto &word : _shift) {
+        word = detail::random_u64(engine);
+      }
+    }
+
+    /// @name Generation
+    /// @{
+
+    /// Next coordinate.
+    result_type operator()() {
+      if (_coordinate == _dimensions) {
+        next_point();
+      }
+      const auto i = _coordinate++;
+      return _point[i] ^ _shift[i];
+    }
+
+    /// Fills [first, last) with the next coordinates. Equivalent to calling
+    /// operator() for every element.
+    void generate(result_type *first, result_type *last);
+
+    /// Next coordinate as a double in (0, 1), see
+    /// detail::to_open_unit_double.
+    double unit_double() {
+      return detail::to_open_unit_double((*this)());
+    }
+
+    /// Fills [first, last) with the next coordinates as doubles in (0, 1).
+    void generate_doubles(double *first, double *last);
+
+    /// @}
+    /// @name Position
+    /// @{
+
+    /// Number of coordinates returned; point n starts at position
+    /// n * dimensions().
+    std::uint64_t position() const {
+      return _index * _dimensions + _coordinate;
+    }
+
+    /// Positions the engine so that the next value returned is the
+    /// @a position-th coordinate of the sequence.
+    void seek(std::uint64_t position);
+
+    /// Advances the engine by @a z coordinates.
+    void discard(unsigned long long z) {
+      seek(position() + z);
+    }
+
+    /// @}
+
+  private:
+
+    /// Moves to point _index + 1, flipping the direction number of the
+    /// lowest zero bit of _index.
+    void next_point() {
+      std::size_t bit = 0u;
+      for (auto i = _index; (i & 1u) != 0u; i >>= 1) {
+        ++bit;
+      }
+      const auto *v = &_directions[bit * _dimensions];
+      for (auto j = 0u; j < _dimensions; ++j) {
+        _point[j] ^= v[j];
+      }
+      ++_index;
+      _coordinate = 0u;
+    }
+
+    std::size_t _dimensions;
+
+    /// Direction numbers, 64 per dimension, interleaved so that the numbers
+    /// of a bit for every dimension are consecutive.
+    std::vector<std::uint64_t> _directions;
+
+    std::vector<std::uint64_t> _point;
+
+    std::vector<std::uint64_t> _shift;
+
+    /// Index of the current point.
+    std::uint64_t _index;
+
+    /// Coordinates of the current point already returned.
+    std::size_t _coordinate;
+  };
+
+  /// Quasi-random (low-discrepancy) points of the Halton sequence, whose
+  /// i-th coordinate is the radical inverse of the point index in the i-th
+  /// prime base. Simpler than Sobol and with no limit on the number of
+  /// dimensions, but its projections degrade in high dimensions, which
+  /// randomize() mitigates with random digit permutations (scrambled
+  /// Halton).
+  ///
+  /// Same interface as sobol_engine; coordinates are returned as 64-bit
+  /// binary fractions, truncated. Digits are stepped with a counter per
+  /// coordinate, in amortized O(1) operations, and seek() jumps to any
+  /// point in O(log n) operations per coordinate.
+  class halton_engine {
+  public:
+
+    using result_type = std::uint64_t;
+
+    static constexpr result_type min() {
+      return 0u;
+    }
+
+    static constexpr result_type max() {
+      return std::numeric_limits<result_type>::max();
+    }
+
+    /// Throws std::invalid_argument if @a dimensions is zero.
+    explicit halton_engine(std::size_t dimensions = 1u);
+
+    std::size_t dimensions() const {
+      return _dimensions;
+    }
+
+    /// Base of the coordinate @a dimension, its prime.
+    std::uint32_t base(std::size_t dimension) const {
+      return _bases[dimension];
+    }
+
+    /// Restarts the sequence at its first point, the origin.
+    void seed() {
+      seek(0u);
+    }
+
+    /// Scrambles every digit with a random permutation of the digits of its
+    /// base, drawn from @a engine, with a different permutation per
+    /// dimension. Zero is kept in place so that points stay finite
+    /// expansions; the coordinate of base 2 is not affected.
+    template <typename URBG>
+    void randomize(URBG &engine) {
+      for (auto j = 0u; j < _dimensions; ++j) {
+        auto *permutation = &_permutations[_permutation_offsets[j]];
+        for (auto d = _bases[j] - 1u; d > 1u; --d) {
+          std::swap(permutation[d], permutation[1u + detail::bounded_u64(engine, d)]);
+        }
+      }
+      seek(position());
+    }
+
+    /// @name Generation
+    /// @{
+
+    /// Next coordinate.
+    result_type operator()() {
+      if (_coordinate == _dimensions) {
+        next_point();
+      }
+      return _point[_coordinate++];
+    }
+
+    /// Fills [first, last) with the next coordinates. Equivalent to calling
+    /// operator() for every element.
+    void generate(result_type *first, result_type *last);
+
+    /// Next coordinate as a double in (0, 1), see
+    /// detail::to_open_unit_double.
+    double unit_double() {
+      return detail::to_open_unit_double((*this)());
+    }
+
+    /// Fills [first, last) with the next coordinates as doubles in (0, 1).
+    void generate_doubles(double *first, double *last);
+
+    /// @}
+    /// @name Position
+    /// @{
+
+    /// Number of coordinates returned; point n starts at position
+    /// n * dimensions().
+    std::uint64_t position() const {
+      return _index * _dimensions + _coordinate;
+    }
+
+    /// Positions the engine so that the next value returned is the
+    /// @a position-th coordinate of the sequence.
+    void seek(std::uint64_t position);
+
+    /// Advances the engine by @a z coordinates.
+    void discard(unsigned long long z) {
+      seek(position() + z);
+    }
+
+    /// @}
+
+  private:
+
+    /// Increments the digits of every coordinate, updating the point with
+    /// the weights of the digits changed.
+    void next_point() {
+      for (auto j = 0u; j < _dimensions; ++j) {
+        const auto base = _bases[j];
+        auto *digits = &_digits[_digit_offsets[j]];
+        const auto *weights = &_weights[_digit_offsets[j]];
+        const auto *permutation = &_permutations[_permutation_offsets[j]];
+        auto value = _point[j];
+        std::size_t k = 0u;
+        while (digits[k] == base - 1u) {
+          // permutation[0] is 0, the digit vanishes.
+          value -= permutation[base - 1u] * weights[k];
+          digits[k++] = 0u;
+        }
+        value += (permutation[digits[k] + 1u] - std::uint64_t(permutation[digits[k]])) * weights[k];
+        ++digits[k];
+        _point[j] = value;
+      }
+      ++_index;
+      _coordinate = 0u;
+    }
+
+    std::size_t _dimensions;
+
+    std::vector<std::uint32_t> _bases;
+
+    /// Digits of the index in every base, least significant first, one more
+    /// than needed for 64-bit indices so that carries always stop.
+    std::vector<std::uint32_t> _digits;
+
+    /// Weight of every digit, 2^64 / base^(k + 1).
+    std::vector<std::uint64_t> _weights;
+
+    std::vector<std::size_t> _digit_offsets;
+
+    /// Permutation of the digits of every base, identity unless randomized.
+    std::vector<std::uint32_t> _permutations;
+
+    std::vector<std::size_t> _permutation_offsets;
+
+    std::vector<std::uint64_t> _point;
+
+    std::uint64_t _index;
+
+    std::size_t _coordinate;
+  };
+
+} // namespace crypto
@@ -5,8 +5,25 @@
 
 #pragma once
 
+#include "entropy.h"
+
+// Seeds randutils::auto_seeded from the kernel entropy pool of entropy.h, so
+// it must come before randutils.h.
+#if !defined(RANDUTILS_SYSTEM_ENTROPY)
+#  define RANDUTILS_SYSTEM_ENTROPY(output, count) ::crypto::detail::system_entropy(output, count)
+#endif
+
+#include "chacha_engine.h"
+#include "counter_engine.h"
+#include "parallel_generate.h"
+#include "pcg_engine.h"
+#include "quantile.h"
+#include "quasi_random.h"
 #include "random_engine_adaptor.h"
 #include "randutils.h"
+#include "sfmt_engine.h"
+#include "thread_rng.h"
+#include "xoshiro_engine.h"
 
 namespace crypto {
 
@@ -14,4 +31,29 @@ namespace crypto {
 
   using mt19937 = random_engine_adaptor<randutils::mt19937_rng>;
 
+  using xoshiro256starstar = random_engine_adaptor<randutils::random_generator<xoshiro256starstar_engine>>;
+
+  using xoroshiro128plus = random_engine_adaptor<randutils::random_generator<xoroshiro128plus_engine>>;
+
+  using pcg64 = random_engine_adaptor<randutils::random_generator<pcg64_engine>>;
+
+  using chacha8 = random_engine_adaptor<randutils::random_generator<chacha8_engine>>;
+
+  using chacha12 = random_engine_adaptor<randutils::random_generator<chacha12_engine>>;
+
+  using chacha20 = random_engine_adaptor<randutils::random_generator<chacha20_engine>>;
+
+  using philox4x32 = random_engine_adaptor<randutils::random_generator<philox4x32_engine>>;
+
+  using threefry4x64 = random_engine_adaptor<randutils::random_generator<threefry4x64_engine>>;
+
+  using sfmt19937 = random_engine_adaptor<randutils::random_generator<sfmt19937_engine>>;
+
+  using dsfmt19937 = random_engine_adaptor<randutils::random_generator<dsfmt19937_engine>>;
+
+  /// Quasi-random engines, constructed with the number of dimensions.
+  using sobol = random_engine_adaptor<sobol_engine>;
+
+  using halton = random_engine_adaptor<halton_engine>;
+
 } // namespace crypto
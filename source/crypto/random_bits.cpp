@@ -0,0 +1,138 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "crypto/random_bits.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define CRYPTO_RANDOM_AVX2 1
+#  include <immintrin.h>
+#endif
+
+namespace crypto {
+namespace detail {
+
+#ifdef CRYPTO_RANDOM_AVX2
+
+  bool cpu_has_avx2() {
+    static const bool value = __builtin_cpu_supports("avx2");
+    return value;
+  }
+
+  __attribute__((target("avx2")))
+  static std::size_t to_unit_doubles_avx2(const std::uint64_t *bits, double *output, std::size_t count) {
+    const __m256i exponent = _mm256_set1_epi64x(0x3ff0000000000000);
+    const __m256d one = _mm256_set1_pd(1.0);
+    std::size_t i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+      const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bits + i));
+      const __m256i mantissa = _mm256_or_si256(_mm256_srli_epi64(x, 12), exponent);
+      _mm256_storeu_pd(output + i, _mm256_sub_pd(_mm256_castsi256_pd(mantissa), one));
+    }
+    return i;
+  }
+
+  __attribute__((target("avx2")))
+  static std::size_t to_unit_floats_avx2(const std::uint32_t *bits, float *output, std::size_t count) {
+    const __m256 scale = _mm256_set1_ps(1.0f / 16777216.0f);
+    std::size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bits + i));
+      const __m256 value = _mm256_cvtepi32_ps(_mm256_srli_epi32(x, 8));
+      _mm256_storeu_ps(output + i, _mm256_mul_ps(value, scale));
+    }
+    return i;
+  }
+
+  /// Eight lanes at a time, the 32x32 products of even and odd lanes
+  /// computed separately. Stops at the first group with a lane whose low
+  /// product is below range, which may need a rejection.
+  __attribute__((target("avx2")))
+  static std::size_t bounded_u32s_avx2(
+      const std::uint32_t *bits,
+      std::uint32_t *output,
+      std::size_t count,
+      std::uint32_t range,
+      std::uint32_t offset) {
+    const __m256i base = _mm256_set1_epi32(static_cast<int>(offset));
+    const __m256i r = _mm256_set1_epi32(static_cast<int>(range));
+    const __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    const __m256i r_signed = _mm256_xor_si256(r, sign);
+    std::size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bits + i));
+      const __m256i even = _mm256_mul_epu32(x, r);
+      const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), r);
+      const __m256i high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xaa);
+      const __m256i low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+      const __m256i below = _mm256_cmpgt_epi32(r_signed, _mm256_xor_si256(low, sign));
+      if (!_mm256_testz_si256(below, below)) {
+        break;
+      }
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), _mm256_add_epi32(high, base));
+    }
+    return i;
+  }
+
+#else
+
+  bool cpu_has_avx2() {
+    return false;
+  }
+
+#endif // CRYPTO_RANDOM_AVX2
+
+  void to_unit_doubles(const std::uint64_t *bits, double *output, std::size_t count) {
+    std::size_t i = 0u;
+#ifdef CRYPTO_RANDOM_AVX2
+    if (cpu_has_avx2()) {
+      i = to_unit_doubles_avx2(bits, output, count);
+    }
+#endif // CRYPTO_RANDOM_AVX2
+    for (; i < count; ++i) {
+      output[i] = to_unit_double_fast(bits[i]);
+    }
+  }
+
+  void to_unit_floats(const std::uint32_t *bits, float *output, std::size_t count) {
+    std::size_t i = 0u;
+#ifdef CRYPTO_RANDOM_AVX2
+    if (cpu_has_avx2()) {
+      i = to_unit_floats_avx2(bits, output, count);
+    }
+#endif // CRYPTO_RANDOM_AVX2
+    for (; i < count; ++i) {
+      output[i] = to_unit_float(bits[i]);
+    }
+  }
+
+  std::size_t bounded_u32s(
+      const std::uint32_t *bits,
+      std::uint32_t *output,
+      std::size_t count,
+      std::uint32_t range,
+      std::uint32_t offset) {
+    std::size_t i = 0u;
+#ifdef CRYPTO_RANDOM_AVX2
+    if (cpu_has_avx2()) {
+      i = bounded_u32s_avx2(bits, output, count, range, offset);
+      if (i + 8u <= count) {
+        // Stopped at a group that needs checking.
+        return i;
+      }
+    }
+#endif // CRYPTO_RANDOM_AVX2
+    for (; i < count; ++i) {
+      std::uint32_t low;
+      const auto high = multiply_words(bits[i], range, low);
+      if (low < range) {
+        break;
+      }
+      output[i] = high + offset;
+    }
+    return i;
+  }
+
+} // namespace detail
+} // namespace crypto
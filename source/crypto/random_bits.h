@@ -0,0 +1,496 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <utility>
+
+namespace crypto {
+namespace detail {
+
+  /// SplitMix64 step, used to expand a single integer seed into an engine
+  /// state.
+  static inline std::uint64_t splitmix64(std::uint64_t &x) {
+    auto z = (x += 0x9e3779b97f4a7c15u);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+    return z ^ (z >> 31);
+  }
+
+  static inline std::uint64_t rotl64(std::uint64_t x, unsigned n) {
+    return (x << n) | (x >> ((64u - n) & 63u));
+  }
+
+  static inline std::uint64_t rotr64(std::uint64_t x, unsigned n) {
+    return (x >> n) | (x << ((64u - n) & 63u));
+  }
+
+  /// High 64 bits of the 128-bit product of @a a and @a b.
+  static inline std::uint64_t mulhi64(std::uint64_t a, std::uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    return static_cast<std::uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+    const std::uint64_t a_lo = a & 0xffffffffu;
+    const std::uint64_t a_hi = a >> 32;
+    const std::uint64_t b_lo = b & 0xffffffffu;
+    const std::uint64_t b_hi = b >> 32;
+    const std::uint64_t lo_lo = a_lo * b_lo;
+    const std::uint64_t hi_lo = a_hi * b_lo;
+    const std::uint64_t lo_hi = a_lo * b_hi;
+    const std::uint64_t hi_hi = a_hi * b_hi;
+    const std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffu) + lo_hi;
+    return hi_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+  }
+
+  /// Minimal unsigned 128-bit integer, enough for 128-bit LCG arithmetic.
+  struct uint128 {
+    std::uint64_t high;
+    std::uint64_t low;
+  };
+
+  static inline uint128 operator+(uint128 lhs, uint128 rhs) {
+    const std::uint64_t low = lhs.low + rhs.low;
+    return {lhs.high + rhs.high + (low < lhs.low ? 1u : 0u), low};
+  }
+
+  static inline uint128 operator-(uint128 lhs, uint128 rhs) {
+    return {lhs.high - rhs.high - (lhs.low < rhs.low ? 1u : 0u), lhs.low - rhs.low};
+  }
+
+  static inline uint128 operator*(uint128 lhs, uint128 rhs) {
+    return {
+      mulhi64(lhs.low, rhs.low) + lhs.high * rhs.low + lhs.low * rhs.high,
+      lhs.low * rhs.low
+    };
+  }
+
+  static inline bool operator==(uint128 lhs, uint128 rhs) {
+    return (lhs.high == rhs.high) && (lhs.low == rhs.low);
+  }
+
+  static inline bool operator!=(uint128 lhs, uint128 rhs) {
+    return !(lhs == rhs);
+  }
+
+  /// Draws 64 uniformly distributed bits from @a engine, calling it once or
+  /// twice for engines producing 64 or 32 full bits respectively.
+  template <typename URBG>
+  static inline std::uint64_t random_u64(URBG &engine) {
+    using result_type = typename URBG::result_type;
+    constexpr auto min = static_cast<std::uint64_t>(URBG::min());
+    constexpr auto max = static_cast<std::uint64_t>(URBG::max());
+    if (min == 0u && max == std::numeric_limits<std::uint64_t>::max()) {
+      return static_cast<std::uint64_t>(engine());
+    } else if (min == 0u && max == 0xffffffffu) {
+      const std::uint64_t high = static_cast<result_type>(engine());
+      return (high << 32) | static_cast<result_type>(engine());
+    } else {
+      return std::uniform_int_distribution<std::uint64_t>()(engine);
+    }
+  }
+
+  /// Maps 64 random bits to a double uniformly distributed on [0, 1), using
+  /// the top 53 bits.
+  static inline double to_unit_double(std::uint64_t bits) {
+    return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  /// Maps 64 random bits to a double uniformly distributed on (0, 1), the
+  /// midpoint of the interval of width 2^-53 selected by the top 53 bits.
+  /// Never 0 nor 1, for inverse CDFs unbounded at the ends.
+  static inline double to_open_unit_double(std::uint64_t bits) {
+    return (static_cast<double>(bits >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+  }
+
+  /// Draws 32 uniformly distributed bits from @a engine, calling it once
+  /// for engines producing 32 or 64 full bits (keeping the high half of the
+  /// latter).
+  template <typename URBG>
+  static inline std::uint32_t random_u32(URBG &engine) {
+    using result_type = typename URBG::result_type;
+    constexpr auto min = static_cast<std::uint64_t>(URBG::min());
+    constexpr auto max = static_cast<std::uint64_t>(URBG::max());
+    if (min == 0u && max == std::numeric_limits<std::uint64_t>::max()) {
+      return static_cast<std::uint32_t>(static_cast<std::uint64_t>(engine()) >> 32);
+    } else if (min == 0u && max == 0xffffffffu) {
+      return static_cast<std::uint32_t>(static_cast<result_type>(engine()));
+    } else {
+      return std::uniform_int_distribution<std::uint32_t>()(engine);
+    }
+  }
+
+  template <typename URBG>
+  static inline std::uint32_t random_word(URBG &engine, std::uint32_t *) {
+    return random_u32(engine);
+  }
+
+  template <typename URBG>
+  static inline std::uint64_t random_word(URBG &engine, std::uint64_t *) {
+    return random_u64(engine);
+  }
+
+  /// Returns one random bit, the top bit of a single call to @a engine when
+  /// the engine produces full words.
+  template <typename URBG>
+  static inline bool random_bit(URBG &engine) {
+    using result_type = typename URBG::result_type;
+    constexpr auto min = static_cast<std::uint64_t>(URBG::min());
+    constexpr auto max = static_cast<std::uint64_t>(URBG::max());
+    if (min == 0u && (max & (max + 1u)) == 0u) {
+      constexpr auto top = (max >> 1) + 1u;
+      return (static_cast<std::uint64_t>(static_cast<result_type>(engine())) & top) != 0u;
+    } else {
+      return std::uniform_int_distribution<int>(0, 1)(engine) == 1;
+    }
+  }
+
+  /// Full product of @a x and @a range, returns the high word and stores the
+  /// low word in @a low.
+  static inline std::uint32_t multiply_words(std::uint32_t x, std::uint32_t range, std::uint32_t &low) {
+    const auto product = std::uint64_t(x) * range;
+    low = static_cast<std::uint32_t>(product);
+    return static_cast<std::uint32_t>(product >> 32);
+  }
+
+  static inline std::uint64_t multiply_words(std::uint64_t x, std::uint64_t range, std::uint64_t &low) {
+    low = x * range;
+    return mulhi64(x, range);
+  }
+
+  /// Lemire's nearly divisionless method, maps the random word @a x to
+  /// [0, @a range), with @a range > 0. The division is only computed when
+  /// @a x falls close to the biased region, in which case @a next is called
+  /// for new words until one is accepted.
+  template <typename WORD, typename NEXT>
+  static inline WORD bounded_word(WORD x, WORD range, NEXT &&next) {
+    WORD low;
+    auto high = multiply_words(x, range, low);
+    if (low < range) {
+      const auto threshold = static_cast<WORD>(static_cast<WORD>(0u - range) % range);
+      while (low < threshold) {
+        high = multiply_words(next(), range, low);
+      }
+    }
+    return high;
+  }
+
+  /// Uniformly distributed integer on [0, @a range), @a range > 0.
+  template <typename URBG>
+  static inline std::uint64_t bounded_u64(URBG &engine, std::uint64_t range) {
+    auto next = [&]() { return random_u64(engine); };
+    return range <= 0xffffffffu ?
+        bounded_word(random_u32(engine), static_cast<std::uint32_t>(range), [&]() { return random_u32(engine); }) :
+        bounded_word(next(), range, next);
+  }
+
+  /// Maps 64 random bits to a double uniformly distributed on [0, 1) by
+  /// setting the top 52 bits as the mantissa of a double in [1, 2), a
+  /// conversion that can be done with SIMD as well.
+  static inline double to_unit_double_fast(std::uint64_t bits) {
+    const std::uint64_t value = (bits >> 12) | 0x3ff0000000000000u;
+    double result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result - 1.0;
+  }
+
+  /// Maps 32 random bits to a float uniformly distributed on [0, 1), using
+  /// the top 24 bits.
+  static inline float to_unit_float(std::uint32_t bits) {
+    return static_cast<float>(static_cast<std::int32_t>(bits >> 8)) * (1.0f / 16777216.0f);
+  }
+
+  /// @name Batch kernels
+  ///
+  /// Implemented in random_bits.cpp, use AVX2 when the CPU supports it.
+  /// @{
+
+  bool cpu_has_avx2();
+
+  /// Converts every word with to_unit_double_fast.
+  void to_unit_doubles(const std::uint64_t *bits, double *output, std::size_t count);
+
+  /// Converts every word with to_unit_float.
+  void to_unit_floats(const std::uint32_t *bits, float *output, std::size_t count);
+
+  /// Maps the leading words of @a bits to [0, @a range) as bounded_word
+  /// does, plus @a offset, stopping at the first word that may need a
+  /// rejection. Returns the number of values written.
+  std::size_t bounded_u32s(
+      const std::uint32_t *bits,
+      std::uint32_t *output,
+      std::size_t count,
+      std::uint32_t range,
+      std::uint32_t offset);
+
+  /// @}
+
+  template <typename T>
+  struct void_type {
+    using type = void;
+  };
+
+  /// Unwraps engines that hold another engine accessible through an
+  /// engine() member function (e.g. randutils::random_generator).
+  template <typename ENGINE, typename = void>
+  struct underlying_engine {
+    using type = ENGINE;
+
+    static type &get(ENGINE &engine) {
+      return engine;
+    }
+  };
+
+  template <typename ENGINE>
+  struct underlying_engine<
+      ENGINE,
+      typename void_type<decltype(std::declval<ENGINE &>().engine())>::type> {
+    using wrapped_type = std::remove_reference_t<decltype(std::declval<ENGINE &>().engine())>;
+
+    using type = typename underlying_engine<wrapped_type>::type;
+
+    static type &get(ENGINE &engine) {
+      return underlying_engine<wrapped_type>::get(engine.engine());
+    }
+  };
+
+  template <typename ENGINE, typename = void>
+  struct has_bulk_generate : std::false_type {};
+
+  template <typename ENGINE>
+  struct has_bulk_generate<
+      ENGINE,
+      decltype(void(std::declval<ENGINE &>().generate(
+          std::declval<typename ENGINE::result_type *>(),
+          std::declval<typename ENGINE::result_type *>())))>
+    : std::true_type {};
+
+  template <typename URBG, typename BULK, typename WORD>
+  static inline void random_words(URBG &engine, BULK &, WORD *output, std::size_t count, std::false_type) {
+    for (auto i = 0u; i < count; ++i) {
+      output[i] = random_word(engine, output);
+    }
+  }
+
+  /// Fills @a output with the same values as @a count calls to random_word,
+  /// using the bulk generate(first, last) of @a BULK, the engine underlying
+  /// @a engine, when it produces full 32 or 64-bit words.
+  template <typename URBG, typename BULK, typename WORD>
+  static inline void random_words(URBG &engine, BULK &bulk, WORD *output, std::size_t count, std::true_type) {
+    using result_type = typename BULK::result_type;
+    constexpr auto min = static_cast<std::uint64_t>(BULK::min());
+    constexpr auto max = static_cast<std::uint64_t>(BULK::max());
+    constexpr auto ratio = sizeof(WORD) / sizeof(std::uint32_t);
+    constexpr std::size_t chunk = 128u;
+    result_type words[ratio * chunk];
+    if (std::is_same<result_type, WORD>::value && min == 0u && max == std::numeric_limits<WORD>::max()) {
+      bulk.generate(reinterpret_cast<result_type *>(output), reinterpret_cast<result_type *>(output + count));
+    } else if (min == 0u && max == std::numeric_limits<std::uint64_t>::max()) {
+      for (std::size_t i = 0u; i < count; i += chunk) {
+        const auto n = std::min(chunk, count - i);
+        bulk.generate(words, words + n);
+        for (auto j = 0u; j < n; ++j) {
+          output[i + j] = static_cast<WORD>(static_cast<std::uint64_t>(words[j]) >> (64u - 8u * sizeof(WORD)));
+        }
+      }
+    } else if (min == 0u && max == 0xffffffffu) {
+      for (std::size_t i = 0u; i < count; i += chunk) {
+        const auto n = std::min(chunk, count - i);
+        bulk.generate(words, words + ratio * n);
+        for (auto j = 0u; j < n; ++j) {
+          WORD value = 0u;
+          for (auto k = 0u; k < ratio; ++k) {
+            value = static_cast<WORD>((std::uint64_t(value) << 16 << 16) | static_cast<std::uint32_t>(words[ratio * j + k]));
+          }
+          output[i + j] = value;
+        }
+      }
+    } else {
+      random_words(engine, bulk, output, count, std::false_type{});
+    }
+  }
+
+  /// Draws blocks of random words and passes them to
+  /// @a convert(bits, n, offset), which writes the values starting at
+  /// @a offset and returns how many it wrote (fewer than @a n only if some
+  /// words were rejected).
+  template <typename WORD, typename URBG, typename BULK, typename CONVERT>
+  static void fill_blocks(URBG &engine, BULK &bulk, std::size_t count, CONVERT &&convert) {
+    constexpr std::size_t block = 256u;
+    WORD bits[block];
+    std::size_t done = 0u;
+    while (done < count) {
+      const auto n = std::min(count - done, block);
+      random_words(engine, bulk, bits, n, has_bulk_generate<BULK>{});
+      done += convert(bits, n, done);
+    }
+  }
+
+  static inline std::size_t bounded_words_fast(
+      const std::uint32_t *bits,
+      std::size_t n,
+      std::uint32_t range,
+      std::uint32_t offset,
+      std::uint32_t *output) {
+    return bounded_u32s(bits, output, n, range, offset);
+  }
+
+  static inline std::size_t bounded_words_fast(
+      const std::uint64_t *,
+      std::size_t,
+      std::uint64_t,
+      std::uint64_t,
+      std::uint64_t *) {
+    return 0u;
+  }
+
+  /// Maps the @a n words of @a bits to [0, @a range), plus @a offset, into
+  /// @a output, where a @a range of zero stands for the full range of WORD.
+  /// Words are consumed in order; a rejection of the last word draws
+  /// directly from @a engine. Since every word yields at most one value,
+  /// all @a n words are used.
+  template <typename URBG, typename WORD>
+  static std::size_t bounded_words(URBG &engine, const WORD *bits, std::size_t n, WORD range, WORD offset, WORD *output) {
+    if (range == 0u) {
+      for (auto i = 0u; i < n; ++i) {
+        output[i] = static_cast<WORD>(bits[i] + offset);
+      }
+      return n;
+    }
+    std::size_t written = 0u;
+    std::size_t i = 0u;
+    while (i < n) {
+      const auto fast = bounded_words_fast(bits + i, n - i, range, offset, output + written);
+      i += fast;
+      written += fast;
+      if (i == n) {
+        break;
+      }
+      output[written++] = static_cast<WORD>(offset + bounded_word(bits[i++], range, [&]() {
+        return (i < n) ? bits[i++] : random_word(engine, output);
+      }));
+    }
+    return written;
+  }
+
+  /// Number of values in [min, max] as a 64-bit word, zero for 2^64.
+  template <typename T>
+  static inline std::uint64_t uniform_range(T min, T max) {
+    using unsigned_type = std::make_unsigned_t<T>;
+    return std::uint64_t(static_cast<unsigned_type>(static_cast<unsigned_type>(max) - static_cast<unsigned_type>(min))) + 1u;
+  }
+
+  template <typename T>
+  static inline T uniform_offset(T min, std::uint64_t value) {
+    using unsigned_type = std::make_unsigned_t<T>;
+    return static_cast<T>(static_cast<unsigned_type>(static_cast<unsigned_type>(min) + static_cast<unsigned_type>(value)));
+  }
+
+  /// @name Fast uniform distributions
+  ///
+  /// Integers use 32-bit words and Lemire's method for ranges up to 2^32,
+  /// 64-bit words otherwise. Floats take 24 bits of a 32-bit word and other
+  /// floating point types 52 bits of a 64-bit word, on [min, max).
+  /// uniform_fill produces the same values, and leaves the engine in the
+  /// same state, as calling uniform_value for every element.
+  /// @{
+
+  template <typename T, typename URBG>
+  static inline T uniform_value(URBG &engine, T min, T max,
+      std::enable_if_t<std::is_integral<T>::value> * = nullptr) {
+    const auto range = uniform_range(min, max);
+    if (range - 1u <= 0xffffffffu) {
+      const auto x = random_u32(engine);
+      return uniform_offset(min, range == 0x100000000u ? x :
+          bounded_word(x, static_cast<std::uint32_t>(range), [&]() { return random_u32(engine); }));
+    } else {
+      const auto x = random_u64(engine);
+      return uniform_offset(min, range == 0u ? x :
+          bounded_word(x, range, [&]() { return random_u64(engine); }));
+    }
+  }
+
+  template <typename T, typename URBG>
+  static inline T uniform_value(URBG &engine, T min, T max,
+      std::enable_if_t<std::is_same<T, float>::value> * = nullptr) {
+    return min + (max - min) * to_unit_float(random_u32(engine));
+  }
+
+  template <typename T, typename URBG>
+  static inline T uniform_value(URBG &engine, T min, T max,
+      std::enable_if_t<std::is_floating_point<T>::value && !std::is_same<T, float>::value> * = nullptr) {
+    return min + (max - min) * static_cast<T>(to_unit_double_fast(random_u64(engine)));
+  }
+
+  /// Values are computed modulo 2^WORD and truncated to T, which matches
+  /// uniform_offset. When T is a variant of WORD they are written in place.
+  template <typename WORD, typename T, typename URBG, typename BULK>
+  static void bounded_fill(URBG &engine, BULK &bulk, T *output, std::size_t count, WORD range, T min) {
+    using unsigned_type = std::make_unsigned_t<T>;
+    constexpr bool in_place = std::is_same<unsigned_type, WORD>::value;
+    const auto offset = static_cast<WORD>(static_cast<unsigned_type>(min));
+    WORD values[256u];
+    fill_blocks<WORD>(engine, bulk, count, [&](const WORD *bits, std::size_t n, std::size_t done) {
+      // Signed and unsigned variants of a type may alias each other.
+      auto target = in_place ? reinterpret_cast<WORD *>(output + done) : values;
+      const auto written = bounded_words(engine, bits, n, range, offset, target);
+      if (!in_place) {
+        for (auto i = 0u; i < written; ++i) {
+          output[done + i] = static_cast<T>(static_cast<unsigned_type>(values[i]));
+        }
+      }
+      return written;
+    });
+  }
+
+  template <typename T, typename URBG, typename BULK>
+  static void uniform_fill(URBG &engine, BULK &bulk, T *output, std::size_t count, T min, T max,
+      std::enable_if_t<std::is_integral<T>::value> * = nullptr) {
+    const auto range = uniform_range(min, max);
+    if (range - 1u <= 0xffffffffu) {
+      bounded_fill<std::uint32_t>(engine, bulk, output, count, static_cast<std::uint32_t>(range), min);
+    } else {
+      bounded_fill<std::uint64_t>(engine, bulk, output, count, range, min);
+    }
+  }
+
+  template <typename T, typename URBG, typename BULK>
+  static void uniform_fill(URBG &engine, BULK &bulk, T *output, std::size_t count, T min, T max,
+      std::enable_if_t<std::is_same<T, float>::value> * = nullptr) {
+    const T scale = max - min;
+    fill_blocks<std::uint32_t>(engine, bulk, count, [&](const std::uint32_t *bits, std::size_t n, std::size_t offset) {
+      to_unit_floats(bits, output + offset, n);
+      for (auto i = offset; i < offset + n; ++i) {
+        output[i] = min + scale * output[i];
+      }
+      return n;
+    });
+  }
+
+  template <typename T, typename URBG, typename BULK>
+  static void uniform_fill(URBG &engine, BULK &bulk, T *output, std::size_t count, T min, T max,
+      std::enable_if_t<std::is_floating_point<T>::value && !std::is_same<T, float>::value> * = nullptr) {
+    const T scale = max - min;
+    double unit[256u];
+    fill_blocks<std::uint64_t>(engine, bulk, count, [&](const std::uint64_t *bits, std::size_t n, std::size_t offset) {
+      to_unit_doubles(bits, unit, n);
+      for (auto i = 0u; i < n; ++i) {
+        output[offset + i] = min + scale * static_cast<T>(unit[i]);
+      }
+      return n;
+    });
+  }
+
+  /// @}
+
+} // namespace detail
+} // namespace crypto
@@ -5,10 +5,24 @@
 
 #pragma once
 
+#include "crypto/buffer_view.h"
+#include "crypto/discrete_sampler.h"
+#include "crypto/engine_jump.h"
+#include "crypto/engine_state.h"
+#include "crypto/parallel_shuffle.h"
+#include "crypto/permutation.h"
+#include "crypto/sampling.h"
+#include "crypto/ziggurat.h"
+
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <iterator>
 #include <random>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace crypto {
 
@@ -36,6 +50,73 @@ namespace detail {
 
 } // detail
 
+  /// A distribution bound to an engine. Unlike the member functions of
+  /// random_engine_adaptor, which build a new distribution on every call, it
+  /// keeps the distribution and its state (e.g. the second value cached by
+  /// std::normal_distribution) across calls.
+  ///
+  /// Holds a reference to the engine, the engine must outlive it.
+  template <typename ENGINE, typename DISTRIBUTION>
+  class bound_distribution {
+  public:
+
+    using engine_type = ENGINE;
+    using distribution_type = DISTRIBUTION;
+    using result_type = typename distribution_type::result_type;
+
+    bound_distribution(engine_type &engine, distribution_type distribution)
+      : _engine(&engine),
+        _distribution(std::move(distribution)) {}
+
+    result_type operator()() {
+      return _distribution(*_engine);
+    }
+
+    template <typename OutputIt>
+    void generate(OutputIt first, OutputIt last) {
+      for (; first != last; ++first) {
+        *first = _distribution(*_engine);
+      }
+    }
+
+    template <typename Range>
+    void generate(Range &&range) {
+      generate(std::begin(range), std::end(range));
+    }
+
+    /// Resets the internal state of the distribution, so that the next value
+    /// does not depend on the previous ones.
+    void reset() {
+      _distribution.reset();
+    }
+
+    result_type min() const {
+      return _distribution.min();
+    }
+
+    result_type max() const {
+      return _distribution.max();
+    }
+
+    engine_type &engine() {
+      return *_engine;
+    }
+
+    distribution_type &distribution() {
+      return _distribution;
+    }
+
+    const distribution_type &distribution() const {
+      return _distribution;
+    }
+
+  private:
+
+    engine_type *_engine;
+
+    distribution_type _distribution;
+  };
+
 
   /// Implements most of the standard random utilities as member functions of
   /// the random engine.
@@ -60,6 +141,75 @@ namespace detail {
       return *this;
     }
 
+    const engine_type &engine() const {
+      return *this;
+    }
+
+    /// @name Engine position
+    /// @{
+
+    /// Advances the engine by @a z values.
+    void discard(unsigned long long z) {
+      underlying_engine().discard(z);
+    }
+
+    /// Positions the engine so that the next value returned is the
+    /// @a position-th value of its stream. Only available for engines with
+    /// random access, e.g. chacha_engine.
+    void seek(std::uint64_t position) {
+      underlying_engine().seek(position);
+    }
+
+    /// Index of the next value to be returned. Only available for engines
+    /// with random access, e.g. chacha_engine.
+    std::uint64_t position() const {
+      return underlying_engine().position();
+    }
+
+    /// Advances the engine by a large fixed distance, for generating
+    /// non-overlapping subsequences. Only available for jumpable engines,
+    /// e.g. xoshiro256starstar_engine or pcg64_engine.
+    void jump() {
+      underlying_engine().jump();
+    }
+
+    /// Advances the engine by a larger fixed distance than jump(). Only
+    /// available for jumpable engines.
+    void long_jump() {
+      underlying_engine().long_jump();
+    }
+
+    /// Advances the engine by @a n values. Takes O(log n) steps for the
+    /// standard linear congruential and Mersenne Twister engines, e.g. the
+    /// engines of default_random_engine and mt19937 (see jump_ahead()), and
+    /// is equivalent to discard(n) for the rest.
+    void jump(unsigned long long n) {
+      jump_ahead(underlying_engine(), n);
+    }
+
+    /// @}
+    /// @name Engine state
+    /// @{
+
+    /// Size in bytes of the state saved by save_state().
+    std::size_t state_size() const {
+      return engine_state_size(underlying_engine());
+    }
+
+    /// Writes a compact binary checkpoint of the engine to @a buffer, and
+    /// returns the number of bytes written. See save_engine_state().
+    std::size_t save_state(mutable_buffer_view buffer) const {
+      return save_engine_state(underlying_engine(), buffer);
+    }
+
+    /// Restores a checkpoint written by save_state(). See
+    /// load_engine_state().
+    void load_state(const_buffer_view buffer) {
+      load_engine_state(underlying_engine(), buffer);
+    }
+
+    /// @}
+
     /// @name Uniform distributions
     /// @{
 
@@ -80,8 +230,31 @@ namespace detail {
       return dist(min, max)(*this);
     }
 
+    /// Same as uniform, but integers are produced with Lemire's nearly
+    /// divisionless method and floating points from a single 64-bit draw
+    /// with 52 bits (24 for float) of resolution, on [min, max). Produces
+    /// the same values as uniform_n.
+    template <typename T>
+    T fast_uniform(
+        T min = detail::uniform_distribution<T>::min,
+        T max = detail::uniform_distribution<T>::max) {
+      return detail::uniform_value<T>(*this, min, max);
+    }
+
+    /// Fills @a output with the values that successive calls to
+    /// fast_uniform(min, max) would produce. Engine output is drawn in blocks,
+    /// through the engine's bulk generate(first, last) when it has one (e.g.
+    /// chacha_engine), and converted with AVX2 when available.
+    template <typename T>
+    void uniform_n(
+        detail::array_view_tmpl<T> output,
+        std::common_type_t<T> min = detail::uniform_distribution<T>::min,
+        std::common_type_t<T> max = detail::uniform_distribution<T>::max) {
+      detail::uniform_fill<T>(*this, underlying_engine(), output.data(), output.size(), min, max);
+    }
+
     bool uniform_bool() {
-      return (uniform<int>(0, 1) == 1);
+      return detail::random_bit(*this);
     }
 
     bool uniform_bool(double weight) {
@@ -120,14 +293,22 @@ namespace detail {
       return std::poisson_distribution<IntType>(mean)(*this);
     }
 
+    /// Sampled with the ziggurat method, see ziggurat.h.
     template <typename RealType = double>
     RealType exponential(RealType lambda = 1.0) {
-      return std::exponential_distribution<RealType>(lambda)(*this);
+      return exponential_sampler<RealType>(lambda)(*this);
+    }
+
+    /// Fills @a output with the values that successive calls to
+    /// exponential(lambda) would produce, drawing engine output in blocks.
+    template <typename RealType>
+    void exponential_n(detail::array_view_tmpl<RealType> output, std::common_type_t<RealType> lambda = 1.0) {
+      detail::exponential_fill(*this, underlying_engine(), output.data(), output.size(), lambda);
     }
 
     template <typename RealType = double>
     RealType gamma(RealType alpha = 1.0, RealType beta = 1.0) {
-      return std::gamma_distribution<RealType>(alpha, beta)(*this);
+      return gamma_sampler<RealType>(alpha, beta)(*this);
     }
 
     template <typename RealType = double>
@@ -142,21 +323,35 @@ namespace detail {
 
     /// @}
     /// @name Normal distributions
+    ///
+    /// normal, lognormal, chi_squared and student_t are built on the
+    /// ziggurat samplers of ziggurat.h.
     /// @{
 
     template <typename RealType = double>
     RealType normal(RealType mean = 0.0, RealType stddev = 1.0) {
-      return std::normal_distribution<RealType>(mean, stddev)(*this);
+      return normal_sampler<RealType>(mean, stddev)(*this);
+    }
+
+    /// Fills @a output with the values that successive calls to
+    /// normal(mean, stddev) would produce, drawing engine output in blocks
+    /// and using AVX2 when available.
+    template <typename RealType>
+    void normal_n(
+        detail::array_view_tmpl<RealType> output,
+        std::common_type_t<RealType> mean = 0.0,
+        std::common_type_t<RealType> stddev = 1.0) {
+      detail::normal_fill(*this, underlying_engine(), output.data(), output.size(), mean, stddev);
     }
 
     template <typename RealType = double>
     RealType lognormal(RealType m = 0.0, RealType s = 1.0) {
-      return std::lognormal_distribution<RealType>(m, s)(*this);
+      return lognormal_sampler<RealType>(m, s)(*this);
     }
 
     template <typename RealType = double>
     RealType chi_squared(RealType n = 1.0) {
-      return std::chi_squared_distribution<RealType>(n)(*this);
+      return chi_squared_sampler<RealType>(n)(*this);
     }
 
     template <typename RealType = double>
@@ -171,7 +366,7 @@ namespace detail {
 
     template <typename RealType = double>
     RealType student_t(RealType n = 1.0) {
-      return std::student_t_distribution<RealType>(n)(*this);
+      return student_t_sampler<RealType>(n)(*this);
     }
 
     /// @}
@@ -193,18 +388,178 @@ namespace detail {
       return std::piecewise_linear_distribution<RealType>(std::forward<ARGS>(args)...)(*this);
     }
 
+    /// @}
+    /// @name Inverse transform sampling
+    ///
+    /// Sample @a quantile(u), the inverse CDF of a distribution (e.g.
+    /// normal_quantile) at a single uniform u on (0, 1), see
+    /// detail::to_open_unit_double. Unlike the samplers above, every sample
+    /// takes exactly one value of the engine, so the samples of a
+    /// quasi-random engine (sobol_engine, halton_engine) keep its low
+    /// discrepancy.
+    /// @{
+
+    template <typename QUANTILE>
+    auto inverse_cdf(QUANTILE &&quantile) {
+      return quantile(detail::to_open_unit_double(detail::random_u64(*this)));
+    }
+
+    /// Fills @a output with the values that successive calls to
+    /// inverse_cdf(quantile) would produce, drawing engine output in blocks.
+    template <typename T, typename QUANTILE>
+    void inverse_cdf_n(detail::array_view_tmpl<T> output, QUANTILE &&quantile) {
+      auto *data = output.data();
+      detail::fill_blocks<std::uint64_t>(*this, underlying_engine(), output.size(),
+          [&](const std::uint64_t *bits, std::size_t n, std::size_t offset) {
+        for (auto i = 0u; i < n; ++i) {
+          data[offset + i] = static_cast<T>(quantile(detail::to_open_unit_double(bits[i])));
+        }
+        return n;
+      });
+    }
+
+    /// @}
+    /// @name Prepared distributions
+    ///
+    /// Return a bound_distribution that keeps the distribution and its state
+    /// across calls, e.g.
+    ///
+    ///     auto normal = rng.make_normal(0.0, 2.0);
+    ///     auto value = normal();
+    ///
+    /// The returned object holds a reference to this engine.
+    ///
+    /// make_discrete, make_piecewise_constant and make_piecewise_linear use
+    /// the constant-time samplers of discrete_sampler.h instead of the std
+    /// distributions, and the normal family and gamma the samplers of
+    /// ziggurat.h, like their member function counterparts.
+    /// @{
+
+    template <typename DISTRIBUTION>
+    bound_distribution<random_engine_adaptor, std::decay_t<DISTRIBUTION>> bind(DISTRIBUTION &&distribution) {
+      return {*this, std::forward<DISTRIBUTION>(distribution)};
+    }
+
+    template <typename T>
+    auto make_uniform(
+        T min = detail::uniform_distribution<T>::min,
+        T max = detail::uniform_distribution<T>::max) {
+      return bind(typename detail::uniform_distribution<T>::distribution(min, max));
+    }
+
+    auto make_bernoulli(double p = 0.5) {
+      return bind(std::bernoulli_distribution(p));
+    }
+
+    template <typename IntType = int>
+    auto make_binomial(IntType t = 1, double p = 0.5) {
+      return bind(std::binomial_distribution<IntType>(t, p));
+    }
+
+    template <typename IntType = int>
+    auto make_negative_binomial(IntType k = 1, double p = 0.5) {
+      return bind(std::negative_binomial_distribution<IntType>(k, p));
+    }
+
+    template <typename IntType = int>
+    auto make_geometric(double p = 0.5) {
+      return bind(std::geometric_distribution<IntType>(p));
+    }
+
+    template <typename IntType = int>
+    auto make_poisson(double mean = 1.0) {
+      return bind(std::poisson_distribution<IntType>(mean));
+    }
+
+    template <typename RealType = double>
+    auto make_exponential(RealType lambda = 1.0) {
+      return bind(exponential_sampler<RealType>(lambda));
+    }
+
+    template <typename RealType = double>
+    auto make_gamma(RealType alpha = 1.0, RealType beta = 1.0) {
+      return bind(gamma_sampler<RealType>(alpha, beta));
+    }
+
+    template <typename RealType = double>
+    auto make_weibull(RealType a = 1.0, RealType b = 1.0) {
+      return bind(std::weibull_distribution<RealType>(a, b));
+    }
+
+    template <typename RealType = double>
+    auto make_extreme_value(RealType a = 0.0, RealType b = 1.0) {
+      return bind(std::extreme_value_distribution<RealType>(a, b));
+    }
+
+    template <typename RealType = double>
+    auto make_normal(RealType mean = 0.0, RealType stddev = 1.0) {
+      return bind(normal_sampler<RealType>(mean, stddev));
+    }
+
+    template <typename RealType = double>
+    auto make_lognormal(RealType m = 0.0, RealType s = 1.0) {
+      return bind(lognormal_sampler<RealType>(m, s));
+    }
+
+    template <typename RealType = double>
+    auto make_chi_squared(RealType n = 1.0) {
+      return bind(chi_squared_sampler<RealType>(n));
+    }
+
+    template <typename RealType = double>
+    auto make_cauchy(RealType a = 0.0, RealType b = 1.0) {
+      return bind(std::cauchy_distribution<RealType>(a, b));
+    }
+
+    template <typename RealType = double>
+    auto make_fisher_f(RealType m = 1.0, RealType n = 1.0) {
+      return bind(std::fisher_f_distribution<RealType>(m, n));
+    }
+
+    template <typename RealType = double>
+    auto make_student_t(RealType n = 1.0) {
+      return bind(student_t_sampler<RealType>(n));
+    }
+
+    template <typename IntType = int, typename ... ARGS>
+    auto make_discrete(ARGS&&...args) {
+      return bind(discrete_sampler<IntType>(std::forward<ARGS>(args)...));
+    }
+
+    template <typename IntType = int>
+    auto make_discrete(std::initializer_list<double> weights) {
+      return bind(discrete_sampler<IntType>(weights));
+    }
+
+    template <typename RealType = double, typename ... ARGS>
+    auto make_piecewise_constant(ARGS&&...args) {
+      return bind(piecewise_constant_sampler<RealType>(std::forward<ARGS>(args)...));
+    }
+
+    template <typename RealType = double, typename UnaryOperation>
+    auto make_piecewise_constant(std::initializer_list<RealType> bl, UnaryOperation fw) {
+      return bind(piecewise_constant_sampler<RealType>(bl, fw));
+    }
+
+    template <typename RealType = double, typename ... ARGS>
+    auto make_piecewise_linear(ARGS&&...args) {
+      return bind(piecewise_linear_sampler<RealType>(std::forward<ARGS>(args)...));
+    }
+
+    template <typename RealType = double, typename UnaryOperation>
+    auto make_piecewise_linear(std::initializer_list<RealType> bl, UnaryOperation fw) {
+      return bind(piecewise_linear_sampler<RealType>(bl, fw));
+    }
+
     /// @}
     /// @name Container utils
     /// @{
 
-    template <typename InputIt>
-    InputIt choice(InputIt begin, InputIt end) {
-      auto distance = std::distance(begin, end);
-      if (distance < 2)
-        return begin;
-      auto position = uniform<decltype(distance)>(0, --distance);
-      std::advance(begin, position);
-      return begin;
+    /// Uniformly chosen element of [begin, end), or @a end if empty. Walks
+    /// forward iterators only once, without computing the distance first.
+    template <typename ForwardIt>
+    ForwardIt choice(ForwardIt begin, ForwardIt end) {
+      return choice(begin, end, typename std::iterator_traits<ForwardIt>::iterator_category());
     }
 
     template <typename Range>
@@ -212,6 +567,59 @@ namespace detail {
       return *choice(std::begin(range), std::end(range));
     }
 
+    /// @a k distinct indices uniformly chosen from [0, @a n), in increasing
+    /// order. Uses Floyd's algorithm, O(k) time and memory.
+    std::vector<std::uint64_t> sample_indices(std::uint64_t n, std::uint64_t k) {
+      return detail::floyd_sample(*this, n, k);
+    }
+
+    /// Moves a uniform sample of @a k elements of [begin, end) to the front,
+    /// keeping their relative order, and returns the end of the sample. The
+    /// order of the rest of the elements is not kept.
+    ///
+    /// If k is small compared to a random access range, the sample is
+    /// chosen with Floyd's algorithm, which touches only the elements
+    /// sampled but allocates O(k) memory for the indices. Otherwise, and for
+    /// forward iterators, selection sampling walks the range once without
+    /// allocating.
+    template <typename ForwardIt>
+    ForwardIt sample(std::uint64_t k, ForwardIt begin, ForwardIt end) {
+      return detail::sample(*this, begin, end, k, typename std::iterator_traits<ForwardIt>::iterator_category());
+    }
+
+    template <typename Range>
+    auto sample(std::uint64_t k, Range &&range) {
+      return sample(k, std::begin(range), std::end(range));
+    }
+
+    /// Uniform sample of up to @a k elements of [begin, end) read in a single
+    /// pass, for streams of unknown length. See reservoir_sampler.
+    template <typename InputIt>
+    auto reservoir_sample(InputIt begin, InputIt end, std::size_t k) {
+      reservoir_sampler<typename std::iterator_traits<InputIt>::value_type> reservoir(k);
+      for (; begin != end; ++begin) {
+        reservoir.push(*this, *begin);
+      }
+      return reservoir.release();
+    }
+
+    template <typename Range>
+    auto reservoir_sample(Range &&range, std::size_t k) {
+      return reservoir_sample(std::begin(range), std::end(range), k);
+    }
+
+    /// Weighted sample without replacement of up to @a k elements of
+    /// [begin, end), with the weights starting at @a first_w, read in a
+    /// single pass. See weighted_reservoir_sampler.
+    template <typename InputIt, typename InputItW>
+    auto weighted_reservoir_sample(InputIt begin, InputIt end, InputItW first_w, std::size_t k) {
+      weighted_reservoir_sampler<typename std::iterator_traits<InputIt>::value_type> reservoir(k);
+      for (; begin != end; ++begin, ++first_w) {
+        reservoir.push(*this, *begin, static_cast<double>(*first_w));
+      }
+      return reservoir.values();
+    }
+
     template <typename RandomIt>
     void shuffle(RandomIt begin, RandomIt end) {
       std::shuffle(begin, end, *this);
@@ -222,7 +630,74 @@ namespace detail {
       shuffle(std::begin(range), std::end(range));
     }
 
+    /// Shuffles [begin, end) on @a threads threads. The elements are
+    /// scattered into random buckets that fit in cache and then shuffled
+    /// locally, which scales better than shuffle for very large ranges at the
+    /// cost of a temporary copy. Draws 256 bits from this engine to key the
+    /// ChaCha8 substreams of the threads; the result depends only on them and
+    /// on @a threads.
+    template <typename RandomIt>
+    void parallel_shuffle(RandomIt begin, RandomIt end, unsigned threads) {
+      chacha8_engine::key_type key;
+      for (auto &word : key) {
+        word = detail::random_u32(*this);
+      }
+      using value_type = typename std::iterator_traits<RandomIt>::value_type;
+      constexpr std::size_t block_bytes = 256u * 1024u;
+      detail::scatter_shuffle(
+          begin,
+          static_cast<std::size_t>(std::distance(begin, end)),
+          key,
+          std::max(threads, 1u),
+          std::max<std::size_t>(block_bytes / sizeof(value_type), 1u));
+    }
+
+    template <typename Range>
+    void parallel_shuffle(Range &&range, unsigned threads) {
+      parallel_shuffle(std::begin(range), std::end(range), threads);
+    }
+
+    /// Lazy random permutation of [0, @a n), keyed with 384 bits drawn from
+    /// this engine. Unlike shuffling an index array, it takes O(1) memory.
+    /// Throws std::invalid_argument if @a n is zero. See random_permutation.
+    random_permutation permutation(std::uint64_t n) {
+      return random_permutation(n, *this);
+    }
+
     /// @}
+
+  private:
+
+    template <typename RandomIt>
+    RandomIt choice(RandomIt begin, RandomIt end, std::random_access_iterator_tag) {
+      auto distance = end - begin;
+      if (distance < 2)
+        return begin;
+      return begin + static_cast<std::ptrdiff_t>(
+          detail::bounded_u64(*this, static_cast<std::uint64_t>(distance)));
+    }
+
+    /// Single-slot reservoir: the n-th element replaces the pick with
+    /// probability 1/n.
+    template <typename ForwardIt>
+    ForwardIt choice(ForwardIt begin, ForwardIt end, std::forward_iterator_tag) {
+      auto pick = end;
+      std::uint64_t n = 0u;
+      for (; begin != end; ++begin) {
+        if (detail::bounded_u64(*this, ++n) == 0u) {
+          pick = begin;
+        }
+      }
+      return pick;
+    }
+
+    auto &underlying_engine() {
+      return detail::underlying_engine<engine_type>::get(engine());
+    }
+
+    auto &underlying_engine() const {
+      return detail::underlying_engine<const engine_type>::get(engine());
+    }
   };
 
 } // namespace crypto
@@ -59,8 +59,10 @@
  * randutils::auto_seeded
  *
  *   Extends a seed sequence class with a nondeterministic default constructor.
- *   Uses a variety of local sources of entropy to portably initialize any
- *   seed sequence to a good default state.
+ *   Takes its seeds from a per-process pool of kernel entropy (see
+ *   RANDUTILS_SYSTEM_ENTROPY), or, where there is none, uses a variety of
+ *   local sources of entropy to portably initialize any seed sequence to a
+ *   good default state.
  *
  *   In normal use, it's accessed via one of the following type aliases, which
  *   use seed_seq_fe128 and seed_seq_fe256 above.
@@ -104,6 +106,7 @@
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <vector>
 
 // Ugly platform-specific code for auto_seeded
 
@@ -113,7 +116,7 @@
     #endif
 #endif
 #if !defined(RANDUTILS_CPU_ENTROPY)
-    #if __i386__
+    #if __i386__ || __x86_64__
         #if __GNUC__
             #define RANDUTILS_CPU_ENTROPY __builtin_ia32_rdtsc()
         #else
@@ -138,6 +141,13 @@
     #define RANDUTILS_GETPID 0
 #endif
 
+// Fills count uint32_t words with system entropy, evaluating to false if not
+// available.  auto_seeded then falls back to gathering local entropy, which is
+// all it does unless defined externally.
+#if !defined(RANDUTILS_SYSTEM_ENTROPY)
+    #define RANDUTILS_SYSTEM_ENTROPY(output, count) false
+#endif
+
 #if __cpp_constexpr >= 201304L
     #define RANDUTILS_GENERALIZED_CONSTEXPR constexpr
 #else
@@ -207,6 +217,15 @@ namespace randutils {
  *   performs dynamic allocation and is free of the possibility of generating
  *   an exception.
  *
+ * Spawning
+ *
+ * spawn(n) returns n child seed sequences, each one seeded with the parent's
+ * entropy store followed by a 64-bit child index, so they are deterministic
+ * and statistically independent of each other and of the parent.  The
+ * mixing of the parent's store is computed once per call, so each child
+ * only costs O(N) hashes.  seed_engines(first, last) seeds a range of
+ * engines with the next children directly.
+ *
  * Ideas used to implement this code include hashing, a simple PCG generator
  * based on an MCG base with an XorShift output function and permutation
  * functions on tuples.
@@ -247,15 +266,78 @@ private:
         return result;
     }
 
+    static IntRep hash(IntRep value, uint32_t& hash_const)
+    {
+        value ^= hash_const;
+        hash_const *= MULT_A;
+        value *= hash_const;
+        value ^= value >> XSHIFT;
+        return value;
+    }
+
+    static IntRep mix(IntRep x, IntRep y)
+    {
+        IntRep result = MIX_MULT_L*x - MIX_MULT_R*y;
+        result ^= result >> XSHIFT;
+        return result;
+    }
+
     std::array<IntRep, count> mixer_;
 
+    // Number of children returned by spawn so far.
+    uint64_t spawned_ = 0;
+
     template <typename InputIter>
     void mix_entropy(InputIter begin, InputIter end);
 
+    template <typename InputIter>
+    uint32_t mix_head(InputIter& current, InputIter end);
+
+    template <typename InputIter>
+    void mix_tail(InputIter current, InputIter end, uint32_t hash_const);
+
+    // Entropy store of the children before mixing in their index, shared by
+    // all of them.
+    struct spawn_prefix {
+        std::array<IntRep, count> mixer;
+        uint32_t hash_const;
+    };
+
+    spawn_prefix make_spawn_prefix() const
+    {
+        seed_seq_fe prefix(mixer_);
+        auto begin = mixer_.begin();
+        uint32_t hash_const = prefix.mix_head(begin, mixer_.end());
+        return {prefix.mixer_, hash_const};
+    }
+
+    explicit seed_seq_fe(const std::array<IntRep, count>& mixer)
+        : mixer_(mixer)
+    {
+    }
+
+    seed_seq_fe(const spawn_prefix& prefix, uint64_t index)
+        : mixer_(prefix.mixer)
+    {
+        constexpr size_t words = (sizeof(uint64_t) + sizeof(IntRep) - 1)
+                                 / sizeof(IntRep);
+        std::array<IntRep, words> index_words;
+        for (auto& word : index_words) {
+            word = IntRep(index);
+            index >>= (sizeof(IntRep) < sizeof(uint64_t) ? 8*sizeof(IntRep)
+                                                         : 0);
+        }
+        mix_tail(index_words.begin(), index_words.end(), prefix.hash_const);
+        for (size_t i = 1; i < mix_rounds; ++i)
+            stir();
+    }
+
 public:
     seed_seq_fe(const seed_seq_fe&)     = delete;
     void operator=(const seed_seq_fe&)  = delete;
 
+    seed_seq_fe(seed_seq_fe&&)          = default;
+
     template <typename T>
     seed_seq_fe(std::initializer_list<T> init)
     {
@@ -296,40 +378,78 @@ public:
         return *this;
     }
 
+    // Returns n child seed sequences, deterministically derived from this
+    // one.  Child i is seeded with this entropy store followed by its index
+    // in the spawn order, so successive calls keep returning new children,
+    // and children of different parents are unrelated.  The mixing of the
+    // parent's store is shared, each child costs O(count) hashes.
+    std::vector<seed_seq_fe> spawn(size_t n)
+    {
+        auto prefix = make_spawn_prefix();
+        std::vector<seed_seq_fe> children;
+        children.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            children.push_back(seed_seq_fe(prefix, spawned_++));
+        return children;
+    }
+
+    // Seeds every engine in [first, last) with the next child seed sequence,
+    // as if seeded with the result of spawn(last - first), without storing
+    // the children.
+    template <typename ForwardIter>
+    void seed_engines(ForwardIter first, ForwardIter last)
+    {
+        auto prefix = make_spawn_prefix();
+        for (; first != last; ++first) {
+            seed_seq_fe child(prefix, spawned_++);
+            first->seed(child);
+        }
+    }
+
+    // Number of children spawned so far.
+    uint64_t spawned() const
+    {
+        return spawned_;
+    }
+
 };
 
 template <size_t count, typename IntRep, size_t r>
 template <typename InputIter>
 void seed_seq_fe<count, IntRep, r>::mix_entropy(InputIter begin, InputIter end)
 {
-    auto hash_const = INIT_A;
-    auto hash = [&](IntRep value) {
-        value ^= hash_const;
-        hash_const *= MULT_A;
-        value *= hash_const;
-        value ^= value >> XSHIFT;
-        return value;
-    };
-    auto mix = [](IntRep x, IntRep y) {
-        IntRep result = MIX_MULT_L*x - MIX_MULT_R*y;
-        result ^= result >> XSHIFT;
-        return result;
-    };
-
     InputIter current = begin;
+    auto hash_const = mix_head(current, end);
+    mix_tail(current, end, hash_const);
+}
+
+template <size_t count, typename IntRep, size_t r>
+template <typename InputIter>
+uint32_t seed_seq_fe<count, IntRep, r>::mix_head(InputIter& current,
+                                                 InputIter end)
+{
+    uint32_t hash_const = INIT_A;
     for (auto& elem : mixer_) {
         if (current != end)
-            elem = hash(*current++);
+            elem = hash(*current++, hash_const);
         else
-            elem = hash(0U);
+            elem = hash(0U, hash_const);
     }
     for (auto& src : mixer_)
         for (auto& dest : mixer_)
             if (&src != &dest)
-                dest = mix(dest,hash(src));
+                dest = mix(dest,hash(src, hash_const));
+    return hash_const;
+}
+
+template <size_t count, typename IntRep, size_t r>
+template <typename InputIter>
+void seed_seq_fe<count, IntRep, r>::mix_tail(InputIter current, InputIter end,
+                                             uint32_t hash_const)
+{
     for (; current != end; ++current)
         for (auto& dest : mixer_)
-            dest = mix(dest,hash(*current));
+            dest = mix(dest,hash(*current, hash_const));
 }
 
 template <size_t count, typename IntRep, size_t mix_rounds>
@@ -409,8 +529,10 @@ using seed_seq_fe256 = seed_seq_fe<8, uint32_t>;
  * randutils::auto_seeded
  *
  *   Extends a seed sequence class with a nondeterministic default constructor.
- *   Uses a variety of local sources of entropy to portably initialize any
- *   seed sequence to a good default state.
+ *   Takes its seeds from a per-process pool of kernel entropy (see
+ *   RANDUTILS_SYSTEM_ENTROPY), or, where there is none, uses a variety of
+ *   local sources of entropy to portably initialize any seed sequence to a
+ *   good default state.
  *
  *   In normal use, it's accessed via one of the following type aliases, which
  *   use seed_seq_fe128 and seed_seq_fe256 above.
@@ -526,6 +648,16 @@ class auto_seeded : public SeedSeq {
                  self_func, exit_func, thread_id, type_id, pid, cpu}};
     }
 
+    // Seeds from the system entropy pool, which is faster than gathering
+    // local entropy and much harder to predict.
+    default_seeds system_entropy()
+    {
+        default_seeds seeds;
+        if (RANDUTILS_SYSTEM_ENTROPY(seeds.data(), seeds.size()))
+            return seeds;
+        return local_entropy();
+    }
+
 
 public:
     using SeedSeq::SeedSeq;
@@ -549,7 +681,7 @@ public:
     }
 
     auto_seeded()
-        : auto_seeded(local_entropy())
+        : auto_seeded(system_entropy())
     {
         // Nothing else to do
     }
@@ -695,14 +827,19 @@ public:
       return engine_();
     }
 
-    typename engine_type::result_type min()
+    static constexpr typename engine_type::result_type min()
+    {
+      return engine_type::min();
+    }
+
+    static constexpr typename engine_type::result_type max()
     {
-      return engine_.min();
+      return engine_type::max();
     }
 
-    typename engine_type::result_type max()
+    void discard(unsigned long long z)
     {
-      return engine_.max();
+        engine_.discard(z);
     }
 
     RandomEngine& engine()
@@ -710,6 +847,11 @@ public:
         return engine_;
     }
 
+    const RandomEngine& engine() const
+    {
+        return engine_;
+    }
+
     template <typename ResultType,
               template <typename> class DistTmpl = std::normal_distribution,
               typename... Params>
@@ -0,0 +1,337 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/random_bits.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace crypto {
+
+namespace detail {
+
+  /// Uniform value on (0, 1].
+  template <typename URBG>
+  static inline double random_open_unit(URBG &engine) {
+    return 1.0 - to_unit_double(random_u64(engine));
+  }
+
+  /// floor(@a x) for non-negative @a x, saturated to the range of uint64_t.
+  static inline std::uint64_t saturated_floor(double x) {
+    constexpr double two_64 = 18446744073709551616.0;
+    return x < two_64 ?
+        static_cast<std::uint64_t>(x) :
+        std::numeric_limits<std::uint64_t>::max();
+  }
+
+  /// Floyd's algorithm (Bentley and Floyd, 1987). Returns @a k distinct
+  /// indices uniformly chosen from [0, @a n), in increasing order, with
+  /// exactly k bounded draws and O(k) memory.
+  template <typename URBG>
+  static std::vector<std::uint64_t> floyd_sample(URBG &engine, std::uint64_t n, std::uint64_t k) {
+    k = std::min(k, n);
+    std::vector<std::uint64_t> indices;
+    indices.reserve(static_cast<std::size_t>(k));
+    std::unordered_set<std::uint64_t> chosen(static_cast<std::size_t>(2u * k));
+    for (auto j = n - k; j < n; ++j) {
+      auto index = bounded_u64(engine, j + 1u);
+      if (!chosen.insert(index).second) {
+        index = j;
+        chosen.insert(j);
+      }
+      indices.push_back(index);
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+  }
+
+  /// Selection sampling, Knuth's Algorithm S. Moves a uniform sample of
+  /// @a k of the @a n elements starting at @a first to the front, keeping
+  /// their relative order, in a single pass that stops at the last element
+  /// selected.
+  template <typename ForwardIt, typename URBG>
+  static ForwardIt selection_sample(URBG &engine, ForwardIt first, std::uint64_t n, std::uint64_t k) {
+    k = std::min(k, n);
+    auto output = first;
+    for (; k > 0u; --n, ++first) {
+      if (bounded_u64(engine, n) < k) {
+        std::iter_swap(output, first);
+        ++output;
+        --k;
+      }
+    }
+    return output;
+  }
+
+  template <typename RandomIt, typename URBG>
+  static RandomIt sample(URBG &engine, RandomIt first, RandomIt last, std::uint64_t k, std::random_access_iterator_tag) {
+    const auto n = static_cast<std::uint64_t>(last - first);
+    // Floyd's algorithm only pays off while the sample is small compared to
+    // the range.
+    if (k > n / 8u) {
+      return selection_sample(engine, first, n, k);
+    }
+    // Indices are increasing and never below their position in the sample,
+    // so every swap leaves the elements already selected in place.
+    auto output = first;
+    for (auto index : floyd_sample(engine, n, k)) {
+      std::iter_swap(output, first + static_cast<std::ptrdiff_t>(index));
+      ++output;
+    }
+    return output;
+  }
+
+  template <typename ForwardIt, typename URBG>
+  static ForwardIt sample(URBG &engine, ForwardIt first, ForwardIt last, std::uint64_t k, std::forward_iterator_tag) {
+    const auto n = static_cast<std::uint64_t>(std::distance(first, last));
+    return selection_sample(engine, first, n, k);
+  }
+
+} // namespace detail
+
+  /// Uniform sample of fixed size from a stream of unknown length, with
+  /// Li's Algorithm L (1994). After the first capacity() elements, only
+  /// O(capacity() * log(count() / capacity())) elements are expected to be
+  /// stored and the rest are skipped without drawing random numbers, so
+  /// pushing an element costs a decrement most of the time.
+  template <typename T>
+  class reservoir_sampler {
+  public:
+
+    using value_type = T;
+
+    explicit reservoir_sampler(std::size_t capacity) : _capacity(capacity) {
+      _values.reserve(capacity);
+    }
+
+    /// Offers the next element of the stream to the sample.
+    template <typename URBG, typename V>
+    void push(URBG &engine, V &&value) {
+      ++_count;
+      if (_values.size() < _capacity) {
+        _values.emplace_back(std::forward<V>(value));
+        if (_values.size() == _capacity) {
+          _w = std::exp(std::log(detail::random_open_unit(engine)) / static_cast<double>(_capacity));
+          next_skip(engine);
+        }
+      } else if (_skip > 0u) {
+        --_skip;
+      } else if (_capacity > 0u) {
+        _values[static_cast<std::size_t>(detail::bounded_u64(engine, _capacity))] = std::forward<V>(value);
+        _w *= std::exp(std::log(detail::random_open_unit(engine)) / static_cast<double>(_capacity));
+        next_skip(engine);
+      }
+    }
+
+    /// Maximum size of the sample.
+    std::size_t capacity() const {
+      return _capacity;
+    }
+
+    /// Number of elements pushed so far.
+    std::uint64_t count() const {
+      return _count;
+    }
+
+    /// The sample, of min(count(), capacity()) elements. The order of the
+    /// elements is not random.
+    const std::vector<value_type> &values() const {
+      return _values;
+    }
+
+    std::vector<value_type> release() {
+      return std::move(_values);
+    }
+
+  private:
+
+    template <typename URBG>
+    void next_skip(URBG &engine) {
+      const auto u = detail::random_open_unit(engine);
+      _skip = _w < 1.0 ?
+          detail::saturated_floor(std::log(u) / std::log1p(-_w)) :
+          0u;
+    }
+
+    std::size_t _capacity;
+
+    std::vector<value_type> _values;
+
+    std::uint64_t _count = 0u;
+
+    std::uint64_t _skip = 0u;
+
+    double _w = 1.0;
+  };
+
+  /// Weighted sample without replacement of fixed size from a stream of
+  /// unknown length, with Efraimidis and Spirakis' A-ExpJ (2006). Every
+  /// element gets the key u^(1/w), for u uniform on (0, 1) and w its weight,
+  /// and the sample keeps the capacity() largest keys. Instead of drawing a
+  /// key for every element, it draws the total weight to skip before the
+  /// next element that enters the sample, so most pushes only subtract a
+  /// weight.
+  ///
+  /// Keys are kept as log(u) / w, which does not underflow for small
+  /// weights. Samplers fed with disjoint parts of a stream, e.g. one per
+  /// thread with engines of independent streams, can be merged into a sample
+  /// of the whole stream.
+  template <typename T>
+  class weighted_reservoir_sampler {
+  public:
+
+    using value_type = T;
+
+    explicit weighted_reservoir_sampler(std::size_t capacity) : _capacity(capacity) {
+      _entries.reserve(capacity);
+    }
+
+    /// Offers the next element of the stream to the sample. Elements of zero
+    /// weight are never sampled.
+    template <typename URBG, typename V>
+    void push(URBG &engine, V &&value, double weight) {
+      if (!(weight >= 0.0) || std::isinf(weight)) {
+        throw std::invalid_argument("negative or invalid weight");
+      }
+      ++_count;
+      if (weight == 0.0 || _capacity == 0u) {
+        return;
+      }
+      if (_entries.size() < _capacity) {
+        insert(std::log(detail::random_open_unit(engine)) / weight, std::forward<V>(value));
+        _skip = -1.0;
+        return;
+      }
+      if (_skip < 0.0) {
+        next_skip(engine);
+      }
+      _skip -= weight;
+      if (_skip > 0.0) {
+        return;
+      }
+      // The key is uniform among those above the threshold t, log(u) / w
+      // with u on (exp(w t), 1].
+      const auto t_w = std::exp(weight * threshold());
+      const auto u = t_w + (1.0 - t_w) * detail::random_open_unit(engine);
+      replace_min(std::log(u) / weight, std::forward<V>(value));
+      next_skip(engine);
+    }
+
+    /// Adds the sample of @a other, taken from a disjoint part of the
+    /// stream, so that this holds a sample of both parts.
+    void merge(const weighted_reservoir_sampler &other) {
+      _count += other._count;
+      for (auto &entry : other._entries) {
+        offer(entry);
+      }
+      _skip = -1.0;
+    }
+
+    void merge(weighted_reservoir_sampler &&other) {
+      _count += other._count;
+      for (auto &entry : other._entries) {
+        offer(std::move(entry));
+      }
+      other._entries.clear();
+      _skip = -1.0;
+    }
+
+    /// Maximum size of the sample.
+    std::size_t capacity() const {
+      return _capacity;
+    }
+
+    /// Number of elements pushed so far.
+    std::uint64_t count() const {
+      return _count;
+    }
+
+    /// Number of elements in the sample.
+    std::size_t size() const {
+      return _entries.size();
+    }
+
+    /// The sample, in no particular order.
+    std::vector<value_type> values() const {
+      std::vector<value_type> result;
+      result.reserve(_entries.size());
+      for (auto &entry : _entries) {
+        result.push_back(entry.value);
+      }
+      return result;
+    }
+
+  private:
+
+    struct entry {
+      double key;
+      value_type value;
+
+      friend bool operator>(const entry &lhs, const entry &rhs) {
+        return lhs.key > rhs.key;
+      }
+    };
+
+    /// Smallest key of the sample, the one an element has to beat.
+    double threshold() const {
+      return _entries.front().key;
+    }
+
+    template <typename V>
+    void insert(double key, V &&value) {
+      _entries.push_back(entry{key, std::forward<V>(value)});
+      std::push_heap(_entries.begin(), _entries.end(), std::greater<entry>());
+    }
+
+    template <typename V>
+    void replace_min(double key, V &&value) {
+      std::pop_heap(_entries.begin(), _entries.end(), std::greater<entry>());
+      _entries.back() = entry{key, std::forward<V>(value)};
+      std::push_heap(_entries.begin(), _entries.end(), std::greater<entry>());
+    }
+
+    template <typename E>
+    void offer(E &&e) {
+      if (_entries.size() < _capacity) {
+        insert(e.key, std::forward<E>(e).value);
+      } else if (_capacity > 0u && e.key > threshold()) {
+        replace_min(e.key, std::forward<E>(e).value);
+      }
+    }
+
+    /// Weight to skip before the next element enters the sample,
+    /// log(r) / log(T) in terms of the threshold key T.
+    template <typename URBG>
+    void next_skip(URBG &engine) {
+      const auto t = threshold();
+      _skip = t < 0.0 ?
+          std::log(detail::random_open_unit(engine)) / t :
+          std::numeric_limits<double>::infinity();
+    }
+
+    std::size_t _capacity;
+
+    /// Min-heap on the key.
+    std::vector<entry> _entries;
+
+    std::uint64_t _count = 0u;
+
+    /// Negative if it has to be drawn again.
+    double _skip = -1.0;
+  };
+
+} // namespace crypto
@@ -6,9 +6,14 @@
 #pragma once
 
 #include "crypto/crypto.h"
+#include "crypto/stats.h"
+#include "crypto/trace.h"
 
+#include <cstddef>
 #include <cstring>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
 
 namespace crypto {
@@ -38,6 +43,12 @@ namespace crypto {
     }
 #endif
 
+    /// Creates a secure_string of @a length null characters, to be filled in
+    /// place through data() or buffer().
+    static secure_string make_zeroed(size_type length) {
+      return secure_string(length);
+    }
+
     /// Creates a secure_string but does not zeroize the given buffer.
     static secure_string unsafe_make(const_buffer_view buffer) {
       return secure_string(buffer);
@@ -55,9 +66,13 @@ namespace crypto {
 
   private:
 
+    explicit secure_string(size_type length)
+      : _length(length),
+        _buffer(allocate(_length)) {}
+
     explicit secure_string(const char *buffer, size_type length)
       : _length(length),
-        _buffer(std::make_unique<char[]>(_length + 1u)) {
+        _buffer(allocate(_length)) {
       std::memcpy(_buffer.get(), buffer, length);
       _buffer[_length] = '\0';
     }
@@ -66,7 +81,7 @@ namespace crypto {
         const char *buffer0, size_type length0,
         const char *buffer1, size_type length1)
       : _length(length0 + length1),
-        _buffer(std::make_unique<char[]>(_length + 1u)) {
+        _buffer(allocate(_length)) {
       std::memcpy(_buffer.get(), buffer0, length0);
       std::memcpy(_buffer.get() + length0, buffer1, length1);
       _buffer[_length] = '\0';
@@ -85,7 +100,7 @@ namespace crypto {
     secure_string(const secure_string &rhs)
       : secure_string(rhs.buffer()) {}
 
-    secure_string(secure_string &&rhs)
+    secure_string(secure_string &&rhs) noexcept
       : _length(rhs._length),
         _buffer(std::move(rhs._buffer)) {
       rhs._length = 0u;
@@ -99,6 +114,11 @@ namespace crypto {
       return _length;
     }
 
+    /// Largest length a secure_string can be created with.
+    static constexpr size_type max_size() {
+      return static_cast<size_type>(std::numeric_limits<std::ptrdiff_t>::max()) - 1u;
+    }
+
     char *data() {
       return _buffer.get();
     }
@@ -136,6 +156,19 @@ namespace crypto {
 
   private:
 
+    /// Buffer for @a length characters and the null terminator. Throws
+    /// std::length_error if @a length is greater than max_size().
+    static std::unique_ptr<char[]> allocate(size_type length) {
+      if (length > max_size()) {
+        throw std::length_error("secure_string too long");
+      }
+      CRYPTO_STATS_ALLOCATION(secure_string, length + 1u);
+      CRYPTO_TRACE1(secure_string_alloc_entry, length + 1u);
+      auto buffer = std::make_unique<char[]>(length + 1u);
+      CRYPTO_TRACE1(secure_string_alloc_return, length + 1u);
+      return buffer;
+    }
+
     void zeroize() {
       if (_buffer != nullptr) {
         ::crypto::zeroize(buffer());
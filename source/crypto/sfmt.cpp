@@ -0,0 +1,151 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "crypto/sfmt_engine.h"
+
+#if defined(__SSE2__)
+#  define CRYPTO_SFMT_SSE2 1
+#  include <emmintrin.h>
+#endif
+
+namespace crypto {
+namespace detail {
+
+  // SFMT19937 parameters.
+  constexpr std::size_t sfmt_n = 156u;
+  constexpr std::size_t sfmt_pos1 = 122u;
+  constexpr int sfmt_sl1 = 18;
+  constexpr int sfmt_sr1 = 11;
+  constexpr std::uint32_t sfmt_msk[4u] = {0xdfffffefu, 0xddfecb7fu, 0xbffaffffu, 0xbffffff6u};
+
+  // dSFMT19937 parameters.
+  constexpr std::size_t dsfmt_n = 191u;
+  constexpr std::size_t dsfmt_pos1 = 117u;
+  constexpr int dsfmt_sl1 = 19;
+  constexpr int dsfmt_sr = 12;
+  constexpr std::uint64_t dsfmt_msk[2u] = {0x000ffafffffffb3fu, 0x000ffdfffc90fffdu};
+
+#ifdef CRYPTO_SFMT_SSE2
+
+  void sfmt19937_next_block(std::uint32_t *state) {
+    auto *w = reinterpret_cast<__m128i *>(state);
+    const auto mask = _mm_set_epi32(
+        static_cast<int>(sfmt_msk[3u]), static_cast<int>(sfmt_msk[2u]),
+        static_cast<int>(sfmt_msk[1u]), static_cast<int>(sfmt_msk[0u]));
+    auto r1 = _mm_load_si128(&w[sfmt_n - 2u]);
+    auto r2 = _mm_load_si128(&w[sfmt_n - 1u]);
+    auto recursion = [&](std::size_t i, std::size_t j) {
+      const auto a = _mm_load_si128(&w[i]);
+      const auto y = _mm_and_si128(_mm_srli_epi32(_mm_load_si128(&w[j]), sfmt_sr1), mask);
+      auto z = _mm_xor_si128(_mm_srli_si128(r1, 1), a);
+      z = _mm_xor_si128(z, _mm_slli_epi32(r2, sfmt_sl1));
+      z = _mm_xor_si128(z, _mm_slli_si128(a, 1));
+      z = _mm_xor_si128(z, y);
+      _mm_store_si128(&w[i], z);
+      r1 = r2;
+      r2 = z;
+    };
+    auto i = 0u;
+    for (; i < sfmt_n - sfmt_pos1; ++i) {
+      recursion(i, i + sfmt_pos1);
+    }
+    for (; i < sfmt_n; ++i) {
+      recursion(i, i + sfmt_pos1 - sfmt_n);
+    }
+  }
+
+  void dsfmt19937_next_block(std::uint64_t *state) {
+    auto *w = reinterpret_cast<__m128i *>(state);
+    const auto mask = _mm_set_epi64x(
+        static_cast<long long>(dsfmt_msk[1u]),
+        static_cast<long long>(dsfmt_msk[0u]));
+    auto lung = _mm_load_si128(&w[dsfmt_n]);
+    auto recursion = [&](std::size_t i, std::size_t j) {
+      const auto x = _mm_load_si128(&w[i]);
+      auto z = _mm_xor_si128(_mm_slli_epi64(x, dsfmt_sl1), _mm_load_si128(&w[j]));
+      lung = _mm_xor_si128(_mm_shuffle_epi32(lung, 0x1b), z);
+      z = _mm_xor_si128(_mm_srli_epi64(lung, dsfmt_sr), x);
+      _mm_store_si128(&w[i], _mm_xor_si128(z, _mm_and_si128(lung, mask)));
+    };
+    auto i = 0u;
+    for (; i < dsfmt_n - dsfmt_pos1; ++i) {
+      recursion(i, i + dsfmt_pos1);
+    }
+    for (; i < dsfmt_n; ++i) {
+      recursion(i, i + dsfmt_pos1 - dsfmt_n);
+    }
+    _mm_store_si128(&w[dsfmt_n], lung);
+  }
+
+#else
+
+  /// 128-bit words as four 32-bit words, least significant first.
+  static inline void sfmt_recursion(
+      std::uint32_t *r,
+      const std::uint32_t *a,
+      const std::uint32_t *b,
+      const std::uint32_t *c,
+      const std::uint32_t *d) {
+    // x = a << 8, y = c >> 8, shifts of the whole 128-bit words.
+    const std::uint64_t ah = (std::uint64_t(a[3u]) << 32) | a[2u];
+    const std::uint64_t al = (std::uint64_t(a[1u]) << 32) | a[0u];
+    const std::uint64_t ch = (std::uint64_t(c[3u]) << 32) | c[2u];
+    const std::uint64_t cl = (std::uint64_t(c[1u]) << 32) | c[0u];
+    const std::uint64_t xh = (ah << 8) | (al >> 56);
+    const std::uint64_t xl = al << 8;
+    const std::uint64_t yh = ch >> 8;
+    const std::uint64_t yl = (cl >> 8) | (ch << 56);
+    const std::uint32_t x[4u] = {
+      static_cast<std::uint32_t>(xl), static_cast<std::uint32_t>(xl >> 32),
+      static_cast<std::uint32_t>(xh), static_cast<std::uint32_t>(xh >> 32)};
+    const std::uint32_t y[4u] = {
+      static_cast<std::uint32_t>(yl), static_cast<std::uint32_t>(yl >> 32),
+      static_cast<std::uint32_t>(yh), static_cast<std::uint32_t>(yh >> 32)};
+    for (auto k = 0u; k < 4u; ++k) {
+      r[k] = a[k] ^ x[k] ^ ((b[k] >> sfmt_sr1) & sfmt_msk[k]) ^ y[k] ^ (d[k] << sfmt_sl1);
+    }
+  }
+
+  void sfmt19937_next_block(std::uint32_t *state) {
+    const std::uint32_t *r1 = state + 4u * (sfmt_n - 2u);
+    const std::uint32_t *r2 = state + 4u * (sfmt_n - 1u);
+    auto i = 0u;
+    for (; i < sfmt_n - sfmt_pos1; ++i) {
+      sfmt_recursion(state + 4u * i, state + 4u * i, state + 4u * (i + sfmt_pos1), r1, r2);
+      r1 = r2;
+      r2 = state + 4u * i;
+    }
+    for (; i < sfmt_n; ++i) {
+      sfmt_recursion(state + 4u * i, state + 4u * i, state + 4u * (i + sfmt_pos1 - sfmt_n), r1, r2);
+      r1 = r2;
+      r2 = state + 4u * i;
+    }
+  }
+
+  void dsfmt19937_next_block(std::uint64_t *state) {
+    std::uint64_t *lung = state + 2u * dsfmt_n;
+    auto recursion = [&](std::size_t i, std::size_t j) {
+      const auto t0 = state[2u * i];
+      const auto t1 = state[2u * i + 1u];
+      const auto l0 = lung[0u];
+      const auto l1 = lung[1u];
+      lung[0u] = (t0 << dsfmt_sl1) ^ (l1 >> 32) ^ (l1 << 32) ^ state[2u * j];
+      lung[1u] = (t1 << dsfmt_sl1) ^ (l0 >> 32) ^ (l0 << 32) ^ state[2u * j + 1u];
+      state[2u * i] = (lung[0u] >> dsfmt_sr) ^ (lung[0u] & dsfmt_msk[0u]) ^ t0;
+      state[2u * i + 1u] = (lung[1u] >> dsfmt_sr) ^ (lung[1u] & dsfmt_msk[1u]) ^ t1;
+    };
+    auto i = 0u;
+    for (; i < dsfmt_n - dsfmt_pos1; ++i) {
+      recursion(i, i + dsfmt_pos1);
+    }
+    for (; i < dsfmt_n; ++i) {
+      recursion(i, i + dsfmt_pos1 - dsfmt_n);
+    }
+  }
+
+#endif // CRYPTO_SFMT_SSE2
+
+} // namespace detail
+} // namespace crypto
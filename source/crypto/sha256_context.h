@@ -0,0 +1,47 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/crypto.h"
+
+#include <cstddef>
+
+struct evp_md_ctx_st;
+
+namespace crypto {
+namespace detail {
+
+  /// Incremental SHA-256, reused for several digests instead of creating an
+  /// OpenSSL context per digest.
+  class sha256_context {
+  public:
+
+    sha256_context();
+
+    sha256_context(const sha256_context &) = delete;
+    sha256_context &operator=(const sha256_context &) = delete;
+
+    ~sha256_context();
+
+    void update(const byte *data, std::size_t size);
+
+    /// Digest of the bytes fed since the last call, restarts the context.
+    sha256_digest finish();
+
+    /// Restarts the context, discarding the bytes fed since the last digest.
+    void reset() {
+      init();
+    }
+
+  private:
+
+    void init();
+
+    evp_md_ctx_st *_context;
+  };
+
+} // namespace detail
+} // namespace crypto
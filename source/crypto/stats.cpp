@@ -0,0 +1,271 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "crypto/stats.h"
+
+#ifdef CRYPTO_ENABLE_STATS
+#  include <algorithm>
+#  include <atomic>
+#  include <mutex>
+#  include <vector>
+#  if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#    include <pthread.h>
+#    define CRYPTO_HAS_PTHREAD_ATFORK 1
+#  endif
+#endif // CRYPTO_ENABLE_STATS
+
+namespace crypto {
+namespace stats {
+
+  const char *name(operation op) {
+    switch (op) {
+      case operation::digest:          return "digest";
+      case operation::zeroize:         return "zeroize";
+      case operation::random_bytes:    return "random_bytes";
+      case operation::secure_string:   return "secure_string";
+      case operation::password_digest: return "password_digest";
+    }
+    return "unknown";
+  }
+
+  std::uint64_t latency_histogram::count() const {
+    std::uint64_t result = 0u;
+    for (auto n : counts) {
+      result += n;
+    }
+    return result;
+  }
+
+  std::uint64_t latency_histogram::quantile(double q) const {
+    const auto total = count();
+    if (total == 0u) {
+      return 0u;
+    }
+    const auto rank = q * static_cast<double>(total);
+    std::uint64_t seen = 0u;
+    for (auto i = 0u; i < buckets; ++i) {
+      seen += counts[i];
+      if (static_cast<double>(seen) >= rank && seen > 0u) {
+        return std::uint64_t(1u) << (i + 1u);
+      }
+    }
+    return std::uint64_t(1u) << buckets;
+  }
+
+  std::uint64_t report::allocations() const {
+    std::uint64_t result = 0u;
+    for (auto &op : operations) {
+      result += op.allocations;
+    }
+    return result;
+  }
+
+  report operator-(const report &lhs, const report &rhs) {
+    report result;
+    for (auto i = 0u; i < operation_count; ++i) {
+      auto &out = result.operations[i];
+      const auto &a = lhs.operations[i];
+      const auto &b = rhs.operations[i];
+      out.calls = a.calls - b.calls;
+      out.bytes = a.bytes - b.bytes;
+      out.evp_contexts = a.evp_contexts - b.evp_contexts;
+      out.allocations = a.allocations - b.allocations;
+      out.allocated_bytes = a.allocated_bytes - b.allocated_bytes;
+      for (auto j = 0u; j < latency_histogram::buckets; ++j) {
+        out.latency.counts[j] = a.latency.counts[j] - b.latency.counts[j];
+      }
+    }
+    return result;
+  }
+
+#ifdef CRYPTO_ENABLE_STATS
+
+namespace detail {
+
+  namespace {
+
+    /// Counters of an operation in a thread. Only the owning thread writes
+    /// them, so increments are a relaxed load and store instead of an atomic
+    /// read-modify-write; atomics only keep snapshot() reads well defined.
+    ///
+    /// No initializers: thread_local objects are zero-initialized, and a
+    /// trivial constructor saves a guard check on every access.
+    struct atomic_counters {
+      std::atomic<std::uint64_t> calls;
+      std::atomic<std::uint64_t> bytes;
+      std::atomic<std::uint64_t> evp_contexts;
+      std::atomic<std::uint64_t> allocations;
+      std::atomic<std::uint64_t> allocated_bytes;
+      std::array<std::atomic<std::uint64_t>, latency_histogram::buckets> latency;
+
+      static void add(std::atomic<std::uint64_t> &counter, std::uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+      }
+
+      void add_to(counters &out) const {
+        out.calls += calls.load(std::memory_order_relaxed);
+        out.bytes += bytes.load(std::memory_order_relaxed);
+        out.evp_contexts += evp_contexts.load(std::memory_order_relaxed);
+        out.allocations += allocations.load(std::memory_order_relaxed);
+        out.allocated_bytes += allocated_bytes.load(std::memory_order_relaxed);
+        for (auto i = 0u; i < latency_histogram::buckets; ++i) {
+          out.latency.counts[i] += latency[i].load(std::memory_order_relaxed);
+        }
+      }
+    };
+
+    struct thread_counters {
+      std::array<atomic_counters, operation_count> operations;
+      bool registered;
+      /// Set when the thread exits, later records (e.g. from the destructors
+      /// of other thread_local objects) go to registry::late.
+      bool retired;
+
+      void add_to(report &out) const {
+        for (auto i = 0u; i < operation_count; ++i) {
+          operations[i].add_to(out.operations[i]);
+        }
+      }
+    };
+
+    /// Counters of the live threads, the sum of the counters of the threads
+    /// that have exited, and the records made after a thread exited.
+    struct registry {
+      std::mutex mutex;
+      std::vector<const thread_counters *> threads;
+      report exited;
+      thread_counters late;
+    };
+
+    registry &get_registry();
+
+#ifdef CRYPTO_HAS_PTHREAD_ATFORK
+
+    /// Keeps the registry unlocked in the child, where only the forking
+    /// thread survives.
+    void on_fork_prepare() {
+      get_registry().mutex.lock();
+    }
+
+    void on_fork_release() {
+      get_registry().mutex.unlock();
+    }
+
+#endif // CRYPTO_HAS_PTHREAD_ATFORK
+
+    /// Never destroyed, threads may exit after main() returns.
+    registry &get_registry() {
+      static auto *instance = []() {
+#ifdef CRYPTO_HAS_PTHREAD_ATFORK
+        pthread_atfork(on_fork_prepare, on_fork_release, on_fork_release);
+#endif // CRYPTO_HAS_PTHREAD_ATFORK
+        return new registry{};
+      }();
+      return *instance;
+    }
+
+    thread_local thread_counters this_thread;
+
+    /// Retires the counters of the thread into the registry on exit.
+    struct thread_exit_hook {
+      bool armed = false;
+
+      ~thread_exit_hook() {
+        if (armed) {
+          auto &r = get_registry();
+          std::lock_guard<std::mutex> lock(r.mutex);
+          this_thread.add_to(r.exited);
+          r.threads.erase(std::find(r.threads.begin(), r.threads.end(), &this_thread));
+          this_thread.retired = true;
+        }
+      }
+    };
+
+    thread_local thread_exit_hook exit_hook;
+
+    /// Applies @a update to the counters of @a op of the calling thread.
+    template <typename F>
+    void record(operation op, F &&update) {
+      const auto i = static_cast<std::size_t>(op);
+      if (!this_thread.retired) {
+        if (!this_thread.registered) {
+          auto &r = get_registry();
+          std::lock_guard<std::mutex> lock(r.mutex);
+          r.threads.push_back(&this_thread);
+          this_thread.registered = true;
+          exit_hook.armed = true;
+        }
+        update(this_thread.operations[i]);
+        return;
+      }
+      auto &r = get_registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      update(r.late.operations[i]);
+    }
+
+    std::size_t latency_bucket(std::uint64_t nanoseconds) {
+      std::size_t bucket = 0u;
+      while ((nanoseconds >>= 1) != 0u && bucket + 1u < latency_histogram::buckets) {
+        ++bucket;
+      }
+      return bucket;
+    }
+
+  } // namespace
+
+  void record_call(operation op, std::uint64_t bytes, std::uint64_t nanoseconds) {
+    record(op, [&](atomic_counters &counters) {
+      atomic_counters::add(counters.calls, 1u);
+      atomic_counters::add(counters.bytes, bytes);
+      atomic_counters::add(counters.latency[latency_bucket(nanoseconds)], 1u);
+    });
+  }
+
+  void record_evp_context(operation op) {
+    record(op, [](atomic_counters &counters) {
+      atomic_counters::add(counters.evp_contexts, 1u);
+    });
+  }
+
+  void record_allocation(operation op, std::uint64_t bytes) {
+    record(op, [&](atomic_counters &counters) {
+      atomic_counters::add(counters.allocations, 1u);
+      atomic_counters::add(counters.allocated_bytes, bytes);
+    });
+  }
+
+} // namespace detail
+
+  report snapshot() {
+    auto &r = detail::get_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto result = r.exited;
+    r.late.add_to(result);
+    for (const auto *thread : r.threads) {
+      thread->add_to(result);
+    }
+    return result;
+  }
+
+  report thread_snapshot() {
+    report result;
+    detail::this_thread.add_to(result);
+    return result;
+  }
+
+#else
+
+  report snapshot() {
+    return report{};
+  }
+
+  report thread_snapshot() {
+    return report{};
+  }
+
+#endif // CRYPTO_ENABLE_STATS
+
+} // namespace stats
+} // namespace crypto
@@ -0,0 +1,173 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef CRYPTO_ENABLE_STATS
+#  include <chrono>
+#endif // CRYPTO_ENABLE_STATS
+
+namespace crypto {
+
+  /// Opt-in counters of the work done by the library: calls, bytes, EVP
+  /// contexts created, allocations and latency histograms per operation.
+  ///
+  /// Counters are only collected when the library and its users are
+  /// compiled with CRYPTO_ENABLE_STATS (the CRYPTO_ENABLE_STATS CMake
+  /// option); otherwise the instrumentation macros expand to nothing and
+  /// snapshot() returns zeros. Every thread updates its own counters without
+  /// synchronization, and snapshot() adds up the counters of every thread on
+  /// demand, including the threads that have already exited.
+namespace stats {
+
+#ifdef CRYPTO_ENABLE_STATS
+  constexpr bool enabled = true;
+#else
+  constexpr bool enabled = false;
+#endif // CRYPTO_ENABLE_STATS
+
+  enum class operation : std::size_t {
+    /// crypto::digest, bytes digested.
+    digest,
+    /// crypto::zeroize, bytes zeroized.
+    zeroize,
+    /// crypto::random_bytes, bytes generated.
+    random_bytes,
+    /// Buffers allocated by secure_string.
+    secure_string,
+    /// Digests allocated by password_digest, and passwords verified against
+    /// them.
+    password_digest
+  };
+
+  constexpr std::size_t operation_count = 5u;
+
+  /// Name of @a op, e.g. "digest".
+  const char *name(operation op);
+
+  /// Latency histogram with power-of-two buckets; bucket i counts the calls
+  /// that took [2^i, 2^(i+1)) nanoseconds, the last bucket every call above.
+  struct latency_histogram {
+    static constexpr std::size_t buckets = 40u;
+
+    std::array<std::uint64_t, buckets> counts{};
+
+    /// Number of calls in the histogram.
+    std::uint64_t count() const;
+
+    /// Upper bound in nanoseconds of the bucket containing the @a q-th
+    /// quantile, e.g. quantile(0.99). Zero if the histogram is empty.
+    std::uint64_t quantile(double q) const;
+  };
+
+  struct counters {
+    std::uint64_t calls = 0u;
+    std::uint64_t bytes = 0u;
+    std::uint64_t evp_contexts = 0u;
+    std::uint64_t allocations = 0u;
+    std::uint64_t allocated_bytes = 0u;
+    latency_histogram latency;
+  };
+
+  /// Counters of every operation, as returned by snapshot().
+  struct report {
+    std::array<counters, operation_count> operations;
+
+    counters &operator[](operation op) {
+      return operations[static_cast<std::size_t>(op)];
+    }
+
+    const counters &operator[](operation op) const {
+      return operations[static_cast<std::size_t>(op)];
+    }
+
+    /// Allocations of every operation.
+    std::uint64_t allocations() const;
+
+    /// Counters accumulated between @a rhs and @a lhs, for measuring a
+    /// piece of code with two snapshots.
+    friend report operator-(const report &lhs, const report &rhs);
+  };
+
+  /// Counters of every thread of the process, live or exited, since the
+  /// start of the process.
+  report snapshot();
+
+  /// Counters of the calling thread, unaffected by the work of other
+  /// threads.
+  report thread_snapshot();
+
+#ifdef CRYPTO_ENABLE_STATS
+
+namespace detail {
+
+  void record_call(operation op, std::uint64_t bytes, std::uint64_t nanoseconds);
+
+  void record_evp_context(operation op);
+
+  void record_allocation(operation op, std::uint64_t bytes);
+
+  /// Records a call to @a op when it goes out of scope, timing it since its
+  /// construction.
+  class scoped_call {
+  public:
+
+    scoped_call(operation op, std::uint64_t bytes)
+      : _op(op),
+        _bytes(bytes),
+        _start(std::chrono::steady_clock::now()) {}
+
+    scoped_call(const scoped_call &) = delete;
+    scoped_call &operator=(const scoped_call &) = delete;
+
+    ~scoped_call() {
+      const auto elapsed = std::chrono::steady_clock::now() - _start;
+      record_call(_op, _bytes, static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+  private:
+
+    operation _op;
+
+    std::uint64_t _bytes;
+
+    std::chrono::steady_clock::time_point _start;
+  };
+
+} // namespace detail
+
+#endif // CRYPTO_ENABLE_STATS
+
+} // namespace stats
+} // namespace crypto
+
+/// @name Instrumentation
+///
+/// Record into the counters of the calling thread; expand to nothing unless
+/// CRYPTO_ENABLE_STATS is defined. @a op is the name of a stats::operation.
+/// @{
+
+#ifdef CRYPTO_ENABLE_STATS
+/// Records a call to @a op processing @a bytes, timed until the end of the
+/// enclosing scope.
+#  define CRYPTO_STATS_CALL(op, bytes) \
+    const ::crypto::stats::detail::scoped_call crypto_stats_call_( \
+        ::crypto::stats::operation::op, (bytes))
+#  define CRYPTO_STATS_EVP_CONTEXT(op) \
+    ::crypto::stats::detail::record_evp_context(::crypto::stats::operation::op)
+#  define CRYPTO_STATS_ALLOCATION(op, bytes) \
+    ::crypto::stats::detail::record_allocation(::crypto::stats::operation::op, (bytes))
+#else
+#  define CRYPTO_STATS_CALL(op, bytes) ((void)0)
+#  define CRYPTO_STATS_EVP_CONTEXT(op) ((void)0)
+#  define CRYPTO_STATS_ALLOCATION(op, bytes) ((void)0)
+#endif // CRYPTO_ENABLE_STATS
+
+/// @}
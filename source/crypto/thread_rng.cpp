@@ -0,0 +1,89 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "crypto/thread_rng.h"
+
+#include "crypto/random.h"
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#  include <pthread.h>
+#  define CRYPTO_HAS_PTHREAD_ATFORK 1
+#endif
+
+namespace crypto {
+namespace detail {
+
+  namespace {
+
+    /// Root of the seed tree, shared by all the threads of the process.
+    struct thread_rng_root {
+      std::mutex mutex;
+      bool seeded = false;
+      std::array<std::uint32_t, 8u> seed;
+      std::uint64_t children = 0u;
+    };
+
+    thread_rng_root &get_root() {
+      static thread_rng_root root;
+      return root;
+    }
+
+#ifdef CRYPTO_HAS_PTHREAD_ATFORK
+
+    void on_fork_prepare() {
+      get_root().mutex.lock();
+    }
+
+    void on_fork_parent() {
+      get_root().mutex.unlock();
+    }
+
+    /// Only the forking thread survives in the child; forget both its engine
+    /// and the process-wide seed.
+    void on_fork_child() {
+      auto &root = get_root();
+      root.seeded = false;
+      root.children = 0u;
+      root.mutex.unlock();
+      thread_rng_holder<>::state.engine = nullptr;
+    }
+
+#endif // CRYPTO_HAS_PTHREAD_ATFORK
+
+  } // namespace
+
+  void seed_thread_rng(thread_rng_state &state) {
+    static std::once_flag once;
+    std::call_once(once, []() {
+#ifdef CRYPTO_HAS_PTHREAD_ATFORK
+      pthread_atfork(on_fork_prepare, on_fork_parent, on_fork_child);
+#endif // CRYPTO_HAS_PTHREAD_ATFORK
+    });
+
+    std::array<std::uint32_t, 10u> words;
+    {
+      auto &root = get_root();
+      std::lock_guard<std::mutex> lock(root.mutex);
+      if (!root.seeded) {
+        randutils::auto_seed_256 seeds;
+        seeds.generate(root.seed.begin(), root.seed.end());
+        root.seeded = true;
+      }
+      const auto child = root.children++;
+      std::copy(root.seed.begin(), root.seed.end(), words.begin());
+      words[8u] = static_cast<std::uint32_t>(child);
+      words[9u] = static_cast<std::uint32_t>(child >> 32);
+    }
+    randutils::seed_seq_fe256 seq(words.begin(), words.end());
+    state.engine = new (&state.storage) thread_rng_engine(seq);
+  }
+
+} // namespace detail
+} // namespace crypto
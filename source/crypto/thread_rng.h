@@ -0,0 +1,62 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/chacha_engine.h"
+#include "crypto/random_engine_adaptor.h"
+
+#include <type_traits>
+
+namespace crypto {
+
+  /// Type of the per-thread engine returned by thread_rng().
+  using thread_rng_engine = random_engine_adaptor<chacha12_engine>;
+
+namespace detail {
+
+  /// Storage of the per-thread engine. Trivial so that accessing the
+  /// thread_local instance needs no initialization guard.
+  struct thread_rng_state {
+    /// The engine constructed in @a storage, as returned by placement new,
+    /// or null until seeded.
+    thread_rng_engine *engine;
+    std::aligned_storage_t<sizeof(thread_rng_engine), alignof(thread_rng_engine)> storage;
+  };
+
+  static_assert(std::is_trivial<thread_rng_state>::value, "thread_rng_state must be trivial");
+  static_assert(
+      std::is_trivially_destructible<thread_rng_engine>::value,
+      "thread_rng_engine must be trivially destructible");
+
+  template <typename T = void>
+  struct thread_rng_holder {
+    static thread_local thread_rng_state state;
+  };
+
+  template <typename T>
+  thread_local thread_rng_state thread_rng_holder<T>::state;
+
+  /// Seeds @a state's engine with the next child of the process-wide seed.
+  void seed_thread_rng(thread_rng_state &state);
+
+} // namespace detail
+
+  /// Returns the engine of the calling thread. Each thread's engine is seeded
+  /// on first use from a process-wide seed, itself seeded once from
+  /// randutils::auto_seed_256. Every thread gets a different seed, and after
+  /// fork() the child process draws a new process-wide seed so it does not
+  /// repeat the parent's sequences.
+  ///
+  /// The returned reference is valid only in the calling thread.
+  static inline thread_rng_engine &thread_rng() {
+    auto &state = detail::thread_rng_holder<>::state;
+    if (state.engine == nullptr) {
+      detail::seed_thread_rng(state);
+    }
+    return *state.engine;
+  }
+
+} // namespace crypto
@@ -0,0 +1,228 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "crypto/token_generator.h"
+
+#include "crypto/crypto.h"
+#include "crypto/random_bits.h"
+
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#  include <pthread.h>
+#  define CRYPTO_HAS_PTHREAD_ATFORK 1
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define CRYPTO_TOKEN_AVX2 1
+#  include <immintrin.h>
+#endif
+
+namespace crypto {
+namespace detail {
+
+#ifdef CRYPTO_TOKEN_AVX2
+
+  /// Looks up 32 bytes at a time in up to four 16-character tables with
+  /// pshufb, selecting the table with bits 4 and 5 of every byte.
+  __attribute__((target("avx2")))
+  static std::size_t map_to_alphabet_avx2(byte *data, std::size_t count, const char *alphabet, std::size_t size) {
+    char padded[64u];
+    for (auto i = 0u; i < 64u; ++i) {
+      padded[i] = alphabet[i % size];
+    }
+    __m256i tables[4u];
+    for (auto t = 0u; t < 4u; ++t) {
+      tables[t] = _mm256_broadcastsi128_si256(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(padded + 16u * t)));
+    }
+    const auto mask = _mm256_set1_epi8(static_cast<char>(size - 1u));
+    const auto low = _mm256_set1_epi8(0x0f);
+    const auto bit4 = _mm256_set1_epi8(0x10);
+    const auto bit5 = _mm256_set1_epi8(0x20);
+    std::size_t i = 0u;
+    for (; i + 32u <= count; i += 32u) {
+      auto *p = reinterpret_cast<__m256i *>(data + i);
+      const auto index = _mm256_and_si256(_mm256_loadu_si256(p), mask);
+      const auto nibble = _mm256_and_si256(index, low);
+      auto result = _mm256_shuffle_epi8(tables[0u], nibble);
+      if (size > 16u) {
+        const auto use4 = _mm256_cmpeq_epi8(_mm256_and_si256(index, bit4), bit4);
+        const auto even = _mm256_blendv_epi8(
+            result, _mm256_shuffle_epi8(tables[1u], nibble), use4);
+        result = even;
+        if (size > 32u) {
+          const auto odd = _mm256_blendv_epi8(
+              _mm256_shuffle_epi8(tables[2u], nibble),
+              _mm256_shuffle_epi8(tables[3u], nibble),
+              use4);
+          const auto use5 = _mm256_cmpeq_epi8(_mm256_and_si256(index, bit5), bit5);
+          result = _mm256_blendv_epi8(even, odd, use5);
+        }
+      }
+      _mm256_storeu_si256(p, result);
+    }
+    return i;
+  }
+
+#endif // CRYPTO_TOKEN_AVX2
+
+  void map_to_alphabet(byte *data, std::size_t count, const char *alphabet, std::size_t size) {
+    std::size_t i = 0u;
+#ifdef CRYPTO_TOKEN_AVX2
+    if (size <= 64u && cpu_has_avx2()) {
+      i = map_to_alphabet_avx2(data, count, alphabet, size);
+    }
+#endif // CRYPTO_TOKEN_AVX2
+    const auto mask = size - 1u;
+    for (; i < count; ++i) {
+      data[i] = static_cast<byte>(alphabet[data[i] & mask]);
+    }
+  }
+
+  namespace {
+
+    /// Bytes of OpenSSL's generator drawn in advance, since every call to
+    /// RAND_bytes has a fixed cost of about a microsecond. Bytes are
+    /// zeroized as they are handed out.
+    struct random_pool {
+      std::array<byte, 4096u> bytes;
+      std::size_t available = 0u;
+
+      ~random_pool() {
+        zeroize(buffer_view::make_mutable(bytes.data(), bytes.size()));
+      }
+    };
+
+    thread_local random_pool pool;
+
+#ifdef CRYPTO_HAS_PTHREAD_ATFORK
+
+    /// Only the forking thread survives in the child, make sure it does not
+    /// hand out the same bytes as the parent.
+    void on_fork_child() {
+      zeroize(buffer_view::make_mutable(pool.bytes.data(), pool.bytes.size()));
+      pool.available = 0u;
+    }
+
+#endif // CRYPTO_HAS_PTHREAD_ATFORK
+
+    /// Fills @a buffer with bytes of OpenSSL's generator, through the pool
+    /// for small requests.
+    void draw_random_bytes(mutable_buffer_view buffer) {
+      static std::once_flag once;
+      std::call_once(once, []() {
+#ifdef CRYPTO_HAS_PTHREAD_ATFORK
+        pthread_atfork(nullptr, nullptr, on_fork_child);
+#endif // CRYPTO_HAS_PTHREAD_ATFORK
+      });
+      const auto size = buffer.size();
+      if (size > pool.bytes.size() / 4u) {
+        random_bytes(buffer);
+        return;
+      }
+      if (pool.available < size) {
+        random_bytes(buffer_view::make_mutable(pool.bytes.data(), pool.bytes.size()));
+        pool.available = pool.bytes.size();
+      }
+      auto *source = pool.bytes.data() + (pool.bytes.size() - pool.available);
+      std::memcpy(buffer.data(), source, size);
+      zeroize(buffer_view::make_mutable(source, size));
+      pool.available -= size;
+    }
+
+  } // namespace
+
+} // namespace detail
+
+  token_generator::token_generator(const std::string &alphabet) : _alphabet(alphabet) {
+    const auto size = _alphabet.size();
+    if (size < 2u || size > 256u) {
+      throw std::invalid_argument("token alphabet must have between 2 and 256 characters");
+    }
+    std::array<bool, 256u> seen{};
+    for (auto c : _alphabet) {
+      auto &entry = seen[static_cast<byte>(c)];
+      if (entry) {
+        throw std::invalid_argument("repeated character in token alphabet");
+      }
+      entry = true;
+    }
+    _limit = static_cast<unsigned>(256u - 256u % size);
+    for (auto b = 0u; b < 256u; ++b) {
+      _table[b] = _alphabet[b % size];
+    }
+  }
+
+  token_generator token_generator::hex() {
+    return token_generator("0123456789abcdef");
+  }
+
+  token_generator token_generator::base32() {
+    return token_generator("ABCDEFGHIJKLMNOPQRSTUVWXYZ234567");
+  }
+
+  token_generator token_generator::base64url() {
+    return token_generator("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_");
+  }
+
+  token_generator token_generator::alphanumeric() {
+    return token_generator("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789");
+  }
+
+  std::size_t token_generator::map_accepted(byte *data, std::size_t count) const {
+    std::size_t accepted = 0u;
+    for (auto i = 0u; i < count; ++i) {
+      const auto b = data[i];
+      data[accepted] = static_cast<byte>(_table[b]);
+      accepted += (b < _limit) ? 1u : 0u;
+    }
+    return accepted;
+  }
+
+  void token_generator::fill(mutable_buffer_view buffer) const {
+    auto *data = buffer.data();
+    const auto size = buffer.size();
+    detail::draw_random_bytes(buffer);
+    if (is_power_of_two()) {
+      detail::map_to_alphabet(data, size, _alphabet.data(), _alphabet.size());
+      return;
+    }
+    auto done = map_accepted(data, size);
+    while (done < size) {
+      detail::draw_random_bytes(buffer_view::make_mutable(data + done, size - done));
+      done += map_accepted(data + done, size - done);
+    }
+  }
+
+  secure_string token_generator::operator()(std::size_t length) const {
+    auto token = secure_string::make_zeroed(length);
+    fill(token);
+    return token;
+  }
+
+  std::vector<secure_string> token_generator::operator()(std::size_t count, std::size_t length) const {
+    if ((count != 0u) && (length > std::numeric_limits<std::size_t>::max() / count)) {
+      throw std::length_error("token batch too large");
+    }
+    // The batch is generated in a single secure_string and then split.
+    const auto batch = [&]() {
+      auto result = secure_string::make_zeroed(count * length);
+      fill(result);
+      return result;
+    }();
+    std::vector<secure_string> tokens;
+    tokens.reserve(count);
+    for (std::size_t i = 0u; i < count; ++i) {
+      tokens.emplace_back(secure_string::unsafe_make(
+          buffer_view::make_const(batch.data() + i * length, length)));
+    }
+    return tokens;
+  }
+
+} // namespace crypto
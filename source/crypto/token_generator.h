@@ -0,0 +1,109 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/buffer_view.h"
+#include "crypto/secure_string.h"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace crypto {
+
+namespace detail {
+
+  /// Replaces every byte b of @a data with alphabet[b % size], for @a size a
+  /// power of two not greater than 256. Uses AVX2 when the CPU supports it
+  /// and @a size is not greater than 64.
+  void map_to_alphabet(byte *data, std::size_t count, const char *alphabet, std::size_t size);
+
+} // namespace detail
+
+  /// Generates random tokens, e.g. API keys, session ids or passwords, as
+  /// uniformly distributed strings over an alphabet, drawing bytes from
+  /// OpenSSL's cryptographically secure generator (see random_bytes).
+  ///
+  /// Bytes are drawn directly into the output and mapped to the alphabet in
+  /// place, so no copy of a token is left in memory that is not zeroized.
+  /// Alphabets whose size is a power of two (hex, base32, base64url) use
+  /// the low bits of every byte, with SIMD lookups; other alphabets reject
+  /// the bytes above the largest multiple of their size in batches.
+  ///
+  /// Short tokens take their bytes from a small per-thread pool, zeroized as
+  /// it is consumed and discarded in the child after fork().
+  class token_generator {
+  public:
+
+    /// Throws std::invalid_argument if @a alphabet has fewer than two or
+    /// more than 256 characters, or repeated characters.
+    explicit token_generator(const std::string &alphabet);
+
+    /// @name Alphabets
+    /// @{
+
+    /// Lowercase hexadecimal digits, 4 bits per character.
+    static token_generator hex();
+
+    /// RFC 4648 base32, "A-Z2-7", 5 bits per character.
+    static token_generator base32();
+
+    /// RFC 4648 base64url, "A-Za-z0-9-_", 6 bits per character.
+    static token_generator base64url();
+
+    /// "A-Za-z0-9".
+    static token_generator alphanumeric();
+
+    /// @}
+
+    const std::string &alphabet() const {
+      return _alphabet;
+    }
+
+    /// @name Generation
+    /// @{
+
+    /// Fills @a buffer with random characters of the alphabet.
+    void fill(mutable_buffer_view buffer) const;
+
+    /// Fills @a token with random characters of the alphabet, keeping its
+    /// size.
+    void fill(secure_string &token) const {
+      fill(token.buffer());
+    }
+
+    /// A random token of @a length characters.
+    secure_string operator()(std::size_t length) const;
+
+    /// @a count random tokens of @a length characters each, drawn with a
+    /// single call to the random generator. Throws std::length_error if
+    /// @a count times @a length does not fit in a std::size_t.
+    std::vector<secure_string> operator()(std::size_t count, std::size_t length) const;
+
+    /// @}
+
+  private:
+
+    /// Whether the size of the alphabet is a power of two.
+    bool is_power_of_two() const {
+      return _limit == 256u;
+    }
+
+    /// Maps the bytes of [@a data, @a data + @a count) that are not rejected
+    /// to the alphabet, moving them to the front, and returns their number.
+    std::size_t map_accepted(byte *data, std::size_t count) const;
+
+    std::string _alphabet;
+
+    /// Bytes below this limit are accepted, 256 for power-of-two alphabets.
+    unsigned _limit;
+
+    /// Character of every accepted byte.
+    std::array<char, 256u> _table;
+  };
+
+} // namespace crypto
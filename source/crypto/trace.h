@@ -0,0 +1,65 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+/// @name Static tracepoints
+///
+/// USDT probes of provider "crypto", compiled in when CRYPTO_ENABLE_TRACE is
+/// defined (the CRYPTO_ENABLE_TRACE CMake option, on by default where
+/// <sys/sdt.h> is available). A probe that is not attached is a single nop
+/// instruction; perf, bpftrace or SystemTap attach to them in a running
+/// process without rebuilding, e.g.
+///
+///     $ bpftrace -e 'usdt:./app:crypto:digest_entry { @[arg0] = hist(arg1); }'
+///
+/// Probes and arguments:
+///
+///   * digest_entry, digest_return (algorithm, size)
+///   * zeroize_entry, zeroize_return (size)
+///   * password_digest_create_entry, password_digest_create_return
+///     (algorithm, password size)
+///   * password_digest_compare_entry (algorithm, password size)
+///   * password_digest_compare_return (algorithm, equal)
+///   * secure_string_alloc_entry, secure_string_alloc_return (size)
+///   * system_entropy_entry (words), system_entropy_return (words, success),
+///     around the kernel entropy that seeds randutils::auto_seeded; it
+///     gathers local entropy instead after a failure
+///
+/// Algorithms are identified by trace::algorithm.
+/// @{
+
+#ifdef CRYPTO_ENABLE_TRACE
+#  include <sys/sdt.h>
+#  define CRYPTO_TRACE0(name) DTRACE_PROBE(crypto, name)
+#  define CRYPTO_TRACE1(name, a0) DTRACE_PROBE1(crypto, name, a0)
+#  define CRYPTO_TRACE2(name, a0, a1) DTRACE_PROBE2(crypto, name, a0, a1)
+#else
+#  define CRYPTO_TRACE0(name) ((void)0)
+#  define CRYPTO_TRACE1(name, a0) ((void)0)
+#  define CRYPTO_TRACE2(name, a0, a1) ((void)0)
+#endif // CRYPTO_ENABLE_TRACE
+
+/// @}
+
+#include <cstddef>
+
+namespace crypto {
+namespace trace {
+
+  /// Algorithm ids passed to the probes.
+  enum algorithm : int {
+    unknown = 0,
+    sha256 = 1,
+    sha512 = 2
+  };
+
+  /// Id of the digest algorithm producing @a digest_size bytes.
+  constexpr int digest_algorithm(std::size_t digest_size) {
+    return (digest_size == 32u) ? sha256 : (digest_size == 64u) ? sha512 : unknown;
+  }
+
+} // namespace trace
+} // namespace crypto
@@ -0,0 +1,698 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "crypto/tree_scanner.h"
+
+#include "crypto/detail/parallel.h"
+#include "crypto/output.h"
+#include "crypto/random_bits.h"
+#include "crypto/sha256_context.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#  include <dirent.h>
+#  include <fcntl.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define CRYPTO_TREE_UNIX 1
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#  if __has_include(<linux/io_uring.h>)
+#    include <linux/io_uring.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+     // IORING_OP_READ came with the same kernel headers (5.6).
+#    if defined(__NR_io_uring_setup) && defined(IORING_FEAT_RW_CUR_POS)
+#      define CRYPTO_TREE_IO_URING 1
+#    endif
+#  endif
+#endif
+
+namespace crypto {
+namespace detail {
+
+  namespace {
+
+#ifdef CRYPTO_TREE_UNIX
+
+    /// A regular file found walking the tree.
+    struct tree_file {
+      std::string path;
+      std::uint64_t device;
+      std::uint64_t inode;
+      std::uint64_t size;
+      std::int64_t mtime;
+    };
+
+    std::runtime_error system_error(const char *what, const std::string &path, int error) {
+      return std::runtime_error(std::string(what) + " " + path + ": " + std::strerror(error));
+    }
+
+    std::int64_t mtime_ns(const struct stat &st) {
+#  if defined(__APPLE__)
+      const auto &time = st.st_mtimespec;
+#  else
+      const auto &time = st.st_mtim;
+#  endif
+      return static_cast<std::int64_t>(time.tv_sec) * 1000000000 + static_cast<std::int64_t>(time.tv_nsec);
+    }
+
+    /// Appends the regular files under @a root to @a files, depth first.
+    /// Entries removed while walking are ignored.
+    void walk(const std::string &root, std::vector<tree_file> &files) {
+      std::vector<std::string> directories{std::string()};
+      while (!directories.empty()) {
+        const auto relative = std::move(directories.back());
+        directories.pop_back();
+        const auto path = relative.empty() ? root : root + '/' + relative;
+        std::unique_ptr<DIR, int (*)(DIR *)> dir(opendir(path.c_str()), closedir);
+        if (dir == nullptr) {
+          if ((errno == ENOENT) && !relative.empty()) {
+            continue;
+          }
+          throw system_error("cannot open directory", path, errno);
+        }
+        const auto fd = dirfd(dir.get());
+        for (;;) {
+          errno = 0;
+          const auto *entry = readdir(dir.get());
+          if (entry == nullptr) {
+            if (errno != 0) {
+              throw system_error("cannot read directory", path, errno);
+            }
+            break;
+          }
+          if ((std::strcmp(entry->d_name, ".") == 0) || (std::strcmp(entry->d_name, "..") == 0)) {
+            continue;
+          }
+          auto child = relative.empty() ? std::string(entry->d_name) : relative + '/' + entry->d_name;
+          struct stat st;
+          if (fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            if (errno == ENOENT) {
+              continue;
+            }
+            throw system_error("cannot stat", root + '/' + child, errno);
+          }
+          if (S_ISDIR(st.st_mode)) {
+            directories.push_back(std::move(child));
+          } else if (S_ISREG(st.st_mode)) {
+            files.push_back(tree_file{
+                std::move(child),
+                static_cast<std::uint64_t>(st.st_dev),
+                static_cast<std::uint64_t>(st.st_ino),
+                static_cast<std::uint64_t>(st.st_size),
+                mtime_ns(st)});
+          }
+        }
+      }
+    }
+
+    /// Closes the file when destroyed.
+    struct scoped_fd {
+      int fd;
+
+      ~scoped_fd() {
+        ::close(fd);
+      }
+    };
+
+    int open_file(const std::string &path) {
+      const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW | O_NOCTTY);
+      if (fd < 0) {
+        throw system_error("cannot open file", path, errno);
+      }
+      return fd;
+    }
+
+    /// Bytes to request per read of a file of @a size bytes: one more than the
+    /// file, so its end is found in a single read, up to @a block_size.
+    std::size_t read_size(std::uint64_t size, std::size_t block_size) {
+      return static_cast<std::size_t>(std::min<std::uint64_t>(size + 1u, block_size));
+    }
+
+    /// A read of a regular file returns less than requested only at its end;
+    /// a short read before the size seen by stat is retried anyway.
+    bool at_end(std::size_t read, std::size_t requested, std::uint64_t offset, std::uint64_t size) {
+      return (read == 0u) || ((read < requested) && (offset >= size));
+    }
+
+    /// Hashes the files of @a pending on @a workers threads, each one reading
+    /// a file at a time with pread.
+    void hash_with_pread(
+        const std::string &root,
+        const std::vector<tree_file> &files,
+        const std::vector<std::size_t> &pending,
+        std::vector<sha256_digest> &digests,
+        unsigned workers,
+        std::size_t block_size) {
+      std::mutex mutex;
+      std::exception_ptr error;
+      std::atomic<bool> failed{false};
+      run_parallel(pending.size(), workers, [&](std::size_t i) {
+        if (failed) {
+          return;
+        }
+        try {
+          const auto &file = files[pending[i]];
+          const auto path = root + '/' + file.path;
+          const scoped_fd fd{open_file(path)};
+          sha256_context context;
+          std::vector<byte> buffer(read_size(file.size, block_size));
+          for (std::uint64_t offset = 0u;;) {
+            const auto n = ::pread(fd.fd, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+            if (n < 0) {
+              if (errno == EINTR) {
+                continue;
+              }
+              throw system_error("cannot read file", path, errno);
+            }
+            const auto read = static_cast<std::size_t>(n);
+            context.update(buffer.data(), read);
+            offset += read;
+            if (at_end(read, buffer.size(), offset, file.size)) {
+              break;
+            }
+          }
+          digests[pending[i]] = context.finish();
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!failed) {
+            error = std::current_exception();
+            failed = true;
+          }
+        }
+      });
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+
+#endif // CRYPTO_TREE_UNIX
+
+#ifdef CRYPTO_TREE_IO_URING
+
+    /// Minimal io_uring on the system calls, so liburing is not needed. Only
+    /// the thread that owns it submits and reaps, so the ring indices shared
+    /// with the kernel only need acquire and release ordering.
+    class uring {
+    public:
+
+      /// Check valid() afterwards, io_uring may be missing, disabled by
+      /// sysctl or forbidden by seccomp.
+      explicit uring(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        _fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (_fd < 0) {
+          return;
+        }
+        _sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        _cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const auto single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0u;
+        if (single_mmap) {
+          _sq_size = _cq_size = std::max(_sq_size, _cq_size);
+        }
+        _sq = map(_sq_size, IORING_OFF_SQ_RING);
+        _cq = single_mmap ? _sq : map(_cq_size, IORING_OFF_CQ_RING);
+        _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        _sqes = static_cast<io_uring_sqe *>(map(_sqes_size, IORING_OFF_SQES));
+        if ((_sq == nullptr) || (_cq == nullptr) || (_sqes == nullptr)) {
+          return;
+        }
+        auto *sq = static_cast<char *>(_sq);
+        _sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        _sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        _sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        _sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        auto *cq = static_cast<char *>(_cq);
+        _cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        _cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        _cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        _cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        _valid = true;
+      }
+
+      uring(const uring &) = delete;
+      uring &operator=(const uring &) = delete;
+
+      ~uring() {
+        if (_sqes != nullptr) {
+          munmap(_sqes, _sqes_size);
+        }
+        if ((_cq != nullptr) && (_cq != _sq)) {
+          munmap(_cq, _cq_size);
+        }
+        if (_sq != nullptr) {
+          munmap(_sq, _sq_size);
+        }
+        if (_fd >= 0) {
+          ::close(_fd);
+        }
+      }
+
+      bool valid() const {
+        return _valid;
+      }
+
+      /// Queues a read, there must be a free submission entry: callers keep
+      /// at most as many reads in flight as entries requested.
+      void read(int fd, byte *buffer, std::size_t size, std::uint64_t offset, std::uint64_t tag) {
+        const auto tail = *_sq_tail;
+        const auto index = tail & _sq_mask;
+        auto &sqe = _sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READ;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buffer);
+        sqe.len = static_cast<std::uint32_t>(size);
+        sqe.off = offset;
+        sqe.user_data = tag;
+        _sq_array[index] = index;
+        __atomic_store_n(_sq_tail, tail + 1u, __ATOMIC_RELEASE);
+      }
+
+      /// Submits the queued reads and waits until one completes.
+      void submit_and_wait() {
+        for (;;) {
+          const auto queued = *_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+          if (syscall(__NR_io_uring_enter, _fd, queued, 1u, IORING_ENTER_GETEVENTS, nullptr, 0) >= 0) {
+            return;
+          }
+          if (errno != EINTR) {
+            throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+          }
+        }
+      }
+
+      /// Takes the next completion, if any.
+      bool pop(std::uint64_t &tag, int &result) {
+        const auto head = *_cq_head;
+        if (head == __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE)) {
+          return false;
+        }
+        const auto &cqe = _cqes[head & _cq_mask];
+        tag = cqe.user_data;
+        result = cqe.res;
+        __atomic_store_n(_cq_head, head + 1u, __ATOMIC_RELEASE);
+        return true;
+      }
+
+    private:
+
+      void *map(std::size_t size, off_t offset) {
+        auto *ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, offset);
+        return ring == MAP_FAILED ? nullptr : ring;
+      }
+
+      int _fd = -1;
+
+      bool _valid = false;
+
+      void *_sq = nullptr;
+
+      void *_cq = nullptr;
+
+      io_uring_sqe *_sqes = nullptr;
+
+      std::size_t _sq_size = 0u;
+
+      std::size_t _cq_size = 0u;
+
+      std::size_t _sqes_size = 0u;
+
+      unsigned *_sq_head = nullptr;
+
+      unsigned *_sq_tail = nullptr;
+
+      unsigned _sq_mask = 0u;
+
+      unsigned *_sq_array = nullptr;
+
+      unsigned *_cq_head = nullptr;
+
+      unsigned *_cq_tail = nullptr;
+
+      unsigned _cq_mask = 0u;
+
+      io_uring_cqe *_cqes = nullptr;
+    };
+
+    /// A file being read through the ring, at most one read in flight or one
+    /// block being hashed at a time.
+    struct uring_slot {
+      std::size_t file = 0u;
+      int fd = -1;
+      std::uint64_t offset = 0u;
+      /// Bytes returned by the last read.
+      std::size_t read = 0u;
+      /// Owned outside the slot, so that it outlives the ring.
+      std::vector<byte> *buffer = nullptr;
+      sha256_context context;
+      std::exception_ptr error;
+
+      ~uring_slot() {
+        if (fd >= 0) {
+          ::close(fd);
+        }
+      }
+    };
+
+    /// Threads hashing the blocks read, handed over in slots.
+    class hash_workers {
+    public:
+
+      explicit hash_workers(unsigned count) {
+        for (auto i = 0u; i < count; ++i) {
+          _threads.emplace_back([this]() { run(); });
+        }
+      }
+
+      ~hash_workers() {
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _stop = true;
+        }
+        _work_available.notify_all();
+        for (auto &thread : _threads) {
+          thread.join();
+        }
+      }
+
+      void push(uring_slot &slot) {
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _work.push_back(&slot);
+        }
+        _work_available.notify_one();
+      }
+
+      /// Moves the slots hashed to @a output, waiting for one if @a wait.
+      void take_hashed(std::vector<uring_slot *> &output, bool wait) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (wait) {
+          _hashed_available.wait(lock, [this]() { return !_hashed.empty(); });
+        }
+        output.insert(output.end(), _hashed.begin(), _hashed.end());
+        _hashed.clear();
+      }
+
+    private:
+
+      void run() {
+        for (;;) {
+          uring_slot *slot;
+          {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _work_available.wait(lock, [this]() { return _stop || !_work.empty(); });
+            if (_stop) {
+              return;
+            }
+            slot = _work.front();
+            _work.pop_front();
+          }
+          try {
+            slot->context.update(slot->buffer->data(), slot->read);
+          } catch (...) {
+            slot->error = std::current_exception();
+          }
+          {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _hashed.push_back(slot);
+          }
+          _hashed_available.notify_one();
+        }
+      }
+
+      std::mutex _mutex;
+
+      std::condition_variable _work_available;
+
+      std::condition_variable _hashed_available;
+
+      std::deque<uring_slot *> _work;
+
+      std::vector<uring_slot *> _hashed;
+
+      bool _stop = false;
+
+      std::vector<std::thread> _threads;
+    };
+
+    /// Waits when destroyed until the kernel has completed the reads still in
+    /// flight, which write into the buffers of the slots. If the ring fails
+    /// meanwhile it gives up; the buffers are declared before the ring, so
+    /// they are only freed after it is closed.
+    struct in_flight_guard {
+      uring &ring;
+      std::size_t &in_flight;
+
+      ~in_flight_guard() {
+        std::uint64_t tag;
+        int result;
+        while (in_flight > 0u) {
+          try {
+            ring.submit_and_wait();
+          } catch (...) {
+            return;
+          }
+          while (ring.pop(tag, result)) {
+            --in_flight;
+          }
+        }
+      }
+    };
+
+    /// Hashes the files of @a pending reading up to @a queue_depth files at a
+    /// time through an io_uring, and hashing on @a threads threads, or on
+    /// this one if @a threads is 1. Returns false, having hashed nothing, if
+    /// io_uring or its read operation is not available.
+    bool hash_with_io_uring(
+        const std::string &root,
+        const std::vector<tree_file> &files,
+        const std::vector<std::size_t> &pending,
+        std::vector<sha256_digest> &digests,
+        unsigned threads,
+        unsigned queue_depth,
+        std::size_t block_size) {
+      const auto slot_count = std::min<std::size_t>(queue_depth, pending.size());
+      // Declared before the ring, so the kernel never writes into freed
+      // memory.
+      std::vector<std::vector<byte>> buffers(slot_count);
+      uring ring(queue_depth);
+      if (!ring.valid()) {
+        return false;
+      }
+      std::vector<uring_slot> slots(slot_count);
+      std::vector<uring_slot *> idle;
+      for (std::size_t i = 0u; i < slot_count; ++i) {
+        slots[i].buffer = &buffers[i];
+        idle.push_back(&slots[i]);
+      }
+      // Declared after the slots, stops before they are destroyed.
+      std::unique_ptr<hash_workers> workers;
+      if (threads > 1u) {
+        workers = std::make_unique<hash_workers>(threads);
+      }
+      std::size_t in_flight = 0u;
+      // Declared last, so on any exit the kernel is done with the buffers
+      // before the workers stop and the slots are freed.
+      const in_flight_guard guard{ring, in_flight};
+      std::size_t next = 0u;
+      std::size_t hashing = 0u;
+      bool any_read = false;
+      std::vector<uring_slot *> hashed;
+
+      auto start_read = [&](uring_slot &slot) {
+        ring.read(slot.fd, slot.buffer->data(), slot.buffer->size(), slot.offset,
+            static_cast<std::uint64_t>(&slot - slots.data()));
+        ++in_flight;
+      };
+      auto finish_file = [&](uring_slot &slot) {
+        digests[slot.file] = slot.context.finish();
+        ::close(slot.fd);
+        slot.fd = -1;
+        idle.push_back(&slot);
+      };
+      auto after_hash = [&](uring_slot &slot) {
+        if (slot.error) {
+          std::rethrow_exception(slot.error);
+        }
+        const auto &file = files[slot.file];
+        slot.offset += slot.read;
+        if (at_end(slot.read, slot.buffer->size(), slot.offset, file.size)) {
+          finish_file(slot);
+        } else {
+          start_read(slot);
+        }
+      };
+
+      for (;;) {
+        while (!idle.empty() && (next < pending.size())) {
+          auto &slot = *idle.back();
+          idle.pop_back();
+          slot.file = pending[next++];
+          const auto &file = files[slot.file];
+          slot.fd = open_file(root + '/' + file.path);
+          slot.offset = 0u;
+          slot.buffer->resize(read_size(file.size, block_size));
+          start_read(slot);
+        }
+        if (workers != nullptr) {
+          hashed.clear();
+          workers->take_hashed(hashed, (in_flight == 0u) && (hashing > 0u));
+          for (auto *slot : hashed) {
+            --hashing;
+            after_hash(*slot);
+          }
+        }
+        if (in_flight == 0u) {
+          if ((hashing > 0u) || (next < pending.size())) {
+            continue;
+          }
+          break;
+        }
+        ring.submit_and_wait();
+        std::uint64_t tag;
+        int result;
+        while (ring.pop(tag, result)) {
+          --in_flight;
+          auto &slot = slots[tag];
+          if (result < 0) {
+            if (!any_read && ((result == -EINVAL) || (result == -EOPNOTSUPP))) {
+              // Kernel before 5.6, without IORING_OP_READ.
+              return false;
+            }
+            throw system_error("cannot read file", root + '/' + files[slot.file].path, -result);
+          }
+          any_read = true;
+          slot.read = static_cast<std::size_t>(result);
+          if (workers != nullptr) {
+            ++hashing;
+            workers->push(slot);
+          } else {
+            try {
+              slot.context.update(slot.buffer->data(), slot.read);
+            } catch (...) {
+              slot.error = std::current_exception();
+            }
+            after_hash(slot);
+          }
+        }
+      }
+      return true;
+    }
+
+#endif // CRYPTO_TREE_IO_URING
+
+  } // namespace
+
+} // namespace detail
+
+  std::size_t tree_digest_cache::key_hash::operator()(const key &k) const {
+    auto state = k.inode ^ (k.device << 32);
+    auto hash = detail::splitmix64(state);
+    state ^= k.size ^ static_cast<std::uint64_t>(k.mtime);
+    return static_cast<std::size_t>(hash ^ detail::splitmix64(state));
+  }
+
+  tree_scanner::tree_scanner(unsigned threads, unsigned queue_depth, std::size_t block_size, bool use_io_uring)
+    : _threads(std::max(threads, 1u)),
+      _queue_depth(queue_depth),
+      _block_size(block_size),
+      _use_io_uring(use_io_uring) {
+    if ((queue_depth < 1u) || (queue_depth > 4096u)) {
+      throw std::invalid_argument("queue depth must be in [1, 4096]");
+    }
+    if ((block_size < (4u << 10)) || (block_size > (1u << 30))) {
+      throw std::invalid_argument("block size must be in [4 KiB, 1 GiB]");
+    }
+  }
+
+#ifdef CRYPTO_TREE_UNIX
+
+  tree_digest tree_scanner::operator()(const std::string &root, tree_digest_cache *cache) const {
+    std::vector<detail::tree_file> files;
+    detail::walk(root, files);
+    std::sort(files.begin(), files.end(), [](const detail::tree_file &lhs, const detail::tree_file &rhs) {
+      return lhs.path < rhs.path;
+    });
+
+    auto key_of = [](const detail::tree_file &file) {
+      return tree_digest_cache::key{file.device, file.inode, file.size, file.mtime};
+    };
+
+    tree_digest result;
+    std::vector<sha256_digest> digests(files.size());
+    std::vector<std::size_t> pending;
+    for (auto i = 0u; i < files.size(); ++i) {
+      if (cache != nullptr) {
+        const auto match = cache->_entries.find(key_of(files[i]));
+        if (match != cache->_entries.end()) {
+          digests[i] = match->second;
+          ++result.cache_hits;
+          continue;
+        }
+      }
+      pending.push_back(i);
+    }
+
+    if (!pending.empty()) {
+#ifdef CRYPTO_TREE_IO_URING
+      result.io_uring = _use_io_uring && detail::hash_with_io_uring(
+          root, files, pending, digests, _threads, _queue_depth, _block_size);
+#endif // CRYPTO_TREE_IO_URING
+      if (!result.io_uring) {
+        detail::hash_with_pread(root, files, pending, digests, _queue_depth, _block_size);
+      }
+    }
+
+    if (cache != nullptr) {
+      cache->_entries.clear();
+      cache->_entries.reserve(files.size());
+      for (auto i = 0u; i < files.size(); ++i) {
+        cache->_entries.emplace(key_of(files[i]), digests[i]);
+      }
+    }
+    result.files.reserve(files.size());
+    for (auto i = 0u; i < files.size(); ++i) {
+      result.files.push_back(file_digest{std::move(files[i].path), files[i].size, digests[i]});
+    }
+    return result;
+  }
+
+#else
+
+  tree_digest tree_scanner::operator()(const std::string &, tree_digest_cache *) const {
+    throw std::runtime_error("tree_scanner is not supported on this platform");
+  }
+
+#endif // CRYPTO_TREE_UNIX
+
+  sha256_digest manifest_digest(const std::vector<file_digest> &files) {
+    detail::sha256_context context;
+    std::string line;
+    for (const auto &file : files) {
+      line = to_hex_string(buffer_view::make_const(file.digest));
+      line += "  ";
+      line += file.path;
+      line += '\n';
+      context.update(reinterpret_cast<const byte *>(line.data()), line.size());
+    }
+    return context.finish();
+  }
+
+} // namespace crypto
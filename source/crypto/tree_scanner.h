@@ -0,0 +1,129 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/crypto.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace crypto {
+
+  /// SHA-256 digest of a regular file in a directory tree.
+  struct file_digest {
+    /// Path relative to the root of the tree, with '/' as separator.
+    std::string path;
+    std::uint64_t size;
+    sha256_digest digest;
+  };
+
+  inline bool operator==(const file_digest &lhs, const file_digest &rhs) {
+    return (lhs.path == rhs.path) && (lhs.size == rhs.size) && (lhs.digest == rhs.digest);
+  }
+
+  inline bool operator!=(const file_digest &lhs, const file_digest &rhs) {
+    return !(lhs == rhs);
+  }
+
+  /// Digests of the files of the last scan of a tree, keyed by device, inode,
+  /// size and modification time. A rescan with the cache only reads the files
+  /// whose key changed; like rsync or make, a file rewritten with the same
+  /// size within the timestamp resolution of the file system is not noticed.
+  class tree_digest_cache {
+  public:
+
+    /// Number of files cached.
+    std::size_t size() const {
+      return _entries.size();
+    }
+
+    void clear() {
+      _entries.clear();
+    }
+
+  private:
+
+    friend class tree_scanner;
+
+    struct key {
+      std::uint64_t device;
+      std::uint64_t inode;
+      std::uint64_t size;
+      /// Nanoseconds since the epoch.
+      std::int64_t mtime;
+
+      bool operator==(const key &rhs) const {
+        return (device == rhs.device) && (inode == rhs.inode) && (size == rhs.size) && (mtime == rhs.mtime);
+      }
+    };
+
+    struct key_hash {
+      std::size_t operator()(const key &k) const;
+    };
+
+    std::unordered_map<key, sha256_digest, key_hash> _entries;
+  };
+
+  /// Files of a scanned tree, sorted by path.
+  struct tree_digest {
+    std::vector<file_digest> files;
+
+    /// Files whose digest was taken from the cache.
+    std::size_t cache_hits = 0u;
+
+    /// Whether the files were read with io_uring, or with pread otherwise.
+    bool io_uring = false;
+  };
+
+  /// Digests every regular file under a directory. Verifying many files is
+  /// bound by the latency of the reads rather than by hashing, so many reads
+  /// are kept in flight: on Linux files are read in blocks through an
+  /// io_uring (io_uring_setup(2)) of @a queue_depth entries, one read per
+  /// file at a time, while @a threads threads hash the blocks read. Where
+  /// io_uring is not available or not allowed, @a queue_depth threads read
+  /// and hash one file each with pread.
+  ///
+  /// Symbolic links and special files are skipped, and mount points are
+  /// crossed.
+  class tree_scanner {
+  public:
+
+    /// Throws std::invalid_argument if @a queue_depth is not in [1, 4096] or
+    /// @a block_size is not in [4 KiB, 1 GiB]. With @a use_io_uring false
+    /// files are always read with pread.
+    explicit tree_scanner(
+        unsigned threads = std::thread::hardware_concurrency(),
+        unsigned queue_depth = 64u,
+        std::size_t block_size = 256u << 10,
+        bool use_io_uring = true);
+
+    /// Digests of the files under @a root. If @a cache is not null, files
+    /// whose key did not change since the last scan with it are not read,
+    /// and the cache is replaced by the files of this scan. Throws
+    /// std::runtime_error if a directory or file cannot be read.
+    tree_digest operator()(const std::string &root, tree_digest_cache *cache = nullptr) const;
+
+  private:
+
+    unsigned _threads;
+
+    unsigned _queue_depth;
+
+    std::size_t _block_size;
+
+    bool _use_io_uring;
+  };
+
+  /// Digest of the manifest of @a files, the output of `sha256sum` for them
+  /// in order: a line "<hex digest>  <path>\n" per file. Identifies the whole
+  /// tree, as long as the files are sorted.
+  sha256_digest manifest_digest(const std::vector<file_digest> &files);
+
+} // namespace crypto
@@ -0,0 +1,214 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/random_bits.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace crypto {
+
+namespace detail {
+
+  /// Common seeding, jumping and comparison for the xoshiro/xoroshiro family
+  /// of engines. @a GENERATOR provides the static functions next(state) and
+  /// the jump polynomials.
+  template <typename GENERATOR, std::size_t N>
+  class xoshiro_engine_base {
+  public:
+
+    using result_type = std::uint64_t;
+
+    using state_type = std::array<std::uint64_t, N>;
+
+    static constexpr result_type default_seed = 0x853c49e6748fea9bu;
+
+    static constexpr result_type min() {
+      return 0u;
+    }
+
+    static constexpr result_type max() {
+      return 0xffffffffffffffffu;
+    }
+
+    xoshiro_engine_base() : xoshiro_engine_base(default_seed) {}
+
+    explicit xoshiro_engine_base(result_type value) {
+      seed(value);
+    }
+
+    template <
+        typename SeedSeq,
+        typename = std::enable_if_t<
+            !std::is_convertible<SeedSeq, result_type>::value &&
+            !std::is_base_of<xoshiro_engine_base, std::decay_t<SeedSeq>>::value>>
+    explicit xoshiro_engine_base(SeedSeq &seq) {
+      seed(seq);
+    }
+
+    explicit xoshiro_engine_base(const state_type &state) {
+      set_state(state);
+    }
+
+    /// Expands @a value with SplitMix64, as recommended by the authors.
+    void seed(result_type value = default_seed) {
+      for (auto &word : _state) {
+        word = splitmix64(value);
+      }
+    }
+
+    template <
+        typename SeedSeq,
+        typename = std::enable_if_t<!std::is_convertible<SeedSeq, result_type>::value>>
+    void seed(SeedSeq &seq) {
+      std::array<std::uint32_t, 2u * N> words;
+      seq.generate(words.begin(), words.end());
+      state_type state;
+      for (auto i = 0u; i < N; ++i) {
+        state[i] = words[2u * i] | (std::uint64_t(words[2u * i + 1u]) << 32);
+      }
+      set_state(state);
+    }
+
+    /// The all-zero state is not valid and is replaced by a fixed state.
+    void set_state(const state_type &state) {
+      _state = state;
+      if (std::all_of(_state.begin(), _state.end(), [](auto w) { return w == 0u; })) {
+        seed();
+      }
+    }
+
+    const state_type &state() const {
+      return _state;
+    }
+
+    result_type operator()() {
+      return GENERATOR::next(_state);
+    }
+
+    void discard(unsigned long long z) {
+      for (; z > 0u; --z) {
+        GENERATOR::next(_state);
+      }
+    }
+
+    /// Equivalent to 2^(N * 32) calls to operator(). Can be used to generate
+    /// 2^(N * 32) non-overlapping subsequences for parallel computations.
+    void jump() {
+      apply_jump(GENERATOR::jump_polynomial());
+    }
+
+    /// Equivalent to 2^(N * 48) calls to operator(). Can be used to generate
+    /// 2^(N * 16) starting points, from each of which jump() generates
+    /// 2^(N * 16) non-overlapping subsequences for parallel distributed
+    /// computations.
+    void long_jump() {
+      apply_jump(GENERATOR::long_jump_polynomial());
+    }
+
+    friend bool operator==(const xoshiro_engine_base &lhs, const xoshiro_engine_base &rhs) {
+      return lhs._state == rhs._state;
+    }
+
+    friend bool operator!=(const xoshiro_engine_base &lhs, const xoshiro_engine_base &rhs) {
+      return !(lhs == rhs);
+    }
+
+  private:
+
+    void apply_jump(const state_type &polynomial) {
+      state_type result{};
+      for (auto word : polynomial) {
+        for (auto bit = 0u; bit < 64u; ++bit) {
+          if (word & (std::uint64_t(1u) << bit)) {
+            for (auto i = 0u; i < N; ++i) {
+              result[i] ^= _state[i];
+            }
+          }
+          GENERATOR::next(_state);
+        }
+      }
+      _state = result;
+    }
+
+    state_type _state;
+  };
+
+  struct xoshiro256starstar_generator {
+    static std::uint64_t next(std::array<std::uint64_t, 4u> &s) {
+      const std::uint64_t result = rotl64(s[1u] * 5u, 7u) * 9u;
+      const std::uint64_t t = s[1u] << 17;
+      s[2u] ^= s[0u];
+      s[3u] ^= s[1u];
+      s[1u] ^= s[2u];
+      s[0u] ^= s[3u];
+      s[2u] ^= t;
+      s[3u] = rotl64(s[3u], 45u);
+      return result;
+    }
+
+    static constexpr std::array<std::uint64_t, 4u> jump_polynomial() {
+      return {{
+        0x180ec6d33cfd0abau, 0xd5a61266f0c9392cu, 0xa9582618e03fc9aau, 0x39abdc4529b1661cu
+      }};
+    }
+
+    static constexpr std::array<std::uint64_t, 4u> long_jump_polynomial() {
+      return {{
+        0x76e15d3efefdcbbfu, 0xc5004e441c522fb3u, 0x77710069854ee241u, 0x39109bb02acbe635u
+      }};
+    }
+  };
+
+  struct xoroshiro128plus_generator {
+    static std::uint64_t next(std::array<std::uint64_t, 2u> &s) {
+      const std::uint64_t s0 = s[0u];
+      std::uint64_t s1 = s[1u];
+      const std::uint64_t result = s0 + s1;
+      s1 ^= s0;
+      s[0u] = rotl64(s0, 24u) ^ s1 ^ (s1 << 16);
+      s[1u] = rotl64(s1, 37u);
+      return result;
+    }
+
+    static constexpr std::array<std::uint64_t, 2u> jump_polynomial() {
+      return {{
+        0xdf900294d8f554a5u, 0x170865df4b3201fcu
+      }};
+    }
+
+    static constexpr std::array<std::uint64_t, 2u> long_jump_polynomial() {
+      return {{
+        0xd2a98b26625eee7bu, 0xdddf9b1090aa7ac1u
+      }};
+    }
+  };
+
+} // namespace detail
+
+  /// xoshiro256** 1.0 by David Blackman and Sebastiano Vigna. All-purpose
+  /// 64-bit engine with 256 bits of state and period 2^256 - 1.
+  class xoshiro256starstar_engine
+    : public detail::xoshiro_engine_base<detail::xoshiro256starstar_generator, 4u> {
+  public:
+    using xoshiro_engine_base::xoshiro_engine_base;
+  };
+
+  /// xoroshiro128+ 1.0 by David Blackman and Sebastiano Vigna. Fastest engine
+  /// of the family, with 128 bits of state and period 2^128 - 1. The lowest
+  /// bits have low linear complexity, use it preferably for floating point
+  /// generation.
+  class xoroshiro128plus_engine
+    : public detail::xoshiro_engine_base<detail::xoroshiro128plus_generator, 2u> {
+  public:
+    using xoshiro_engine_base::xoshiro_engine_base;
+  };
+
+} // namespace crypto
@@ -0,0 +1,178 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "crypto/ziggurat.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#  define CRYPTO_ZIGGURAT_AVX2 1
+#  include <immintrin.h>
+#endif
+
+namespace crypto {
+namespace detail {
+
+  /// Builds the layers of equal area @a v under the decreasing density
+  /// @a f, with the tail starting at @a r; @a f_inverse(y) gives the x with
+  /// f(x) = y. Follows the construction of Marsaglia and Tsang's zigset.
+  template <typename F, typename F_INVERSE>
+  static ziggurat_table make_ziggurat(double r, double v, F &&f, F_INVERSE &&f_inverse) {
+    constexpr double scale = 4503599627370496.0; // 2^52
+    ziggurat_table table;
+    table.r = r;
+    const double q = v / f(r);
+    table.k[0u] = static_cast<std::uint64_t>((r / q) * scale);
+    table.k[1u] = 0u;
+    table.w[0u] = q / scale;
+    table.w[255u] = r / scale;
+    table.f[0u] = 1.0;
+    table.f[255u] = f(r);
+    double x = r;
+    for (auto i = 254u; i >= 1u; --i) {
+      const double next = f_inverse(v / x + f(x));
+      table.k[i + 1u] = static_cast<std::uint64_t>((next / x) * scale);
+      x = next;
+      table.f[i] = f(x);
+      table.w[i] = x / scale;
+    }
+    return table;
+  }
+
+  const ziggurat_table &normal_ziggurat() {
+    static const ziggurat_table table = make_ziggurat(
+        3.6541528853610088,
+        0.00492867323399,
+        [](double x) { return std::exp(-0.5 * x * x); },
+        [](double y) { return std::sqrt(-2.0 * std::log(y)); });
+    return table;
+  }
+
+  const ziggurat_table &exponential_ziggurat() {
+    static const ziggurat_table table = make_ziggurat(
+        7.69711747013104972,
+        0.0039496598225815571993,
+        [](double x) { return std::exp(-x); },
+        [](double y) { return -std::log(y); });
+    return table;
+  }
+
+#ifdef CRYPTO_ZIGGURAT_AVX2
+
+  /// Layer widths and thresholds of four words, and their positions as
+  /// doubles. Positions are below 2^52, so they convert exactly by setting
+  /// them as the mantissa of 2^52.
+  struct ziggurat_lanes {
+    __m256i position;
+    __m256i threshold;
+    __m256d value;
+  };
+
+  __attribute__((target("avx2")))
+  static inline ziggurat_lanes ziggurat_load(const ziggurat_table &table, __m256i x) {
+    const __m256i layer = _mm256_and_si256(x, _mm256_set1_epi64x(0xff));
+    const __m256i position = _mm256_srli_epi64(x, 12);
+    const __m256i threshold = _mm256_i64gather_epi64(
+        reinterpret_cast<const long long *>(table.k), layer, 8);
+    const __m256d width = _mm256_i64gather_pd(table.w, layer, 8);
+    const __m256d two_52 = _mm256_set1_pd(4503599627370496.0);
+    const __m256d exact = _mm256_sub_pd(
+        _mm256_castsi256_pd(_mm256_or_si256(position, _mm256_castpd_si256(two_52))),
+        two_52);
+    return {position, threshold, _mm256_mul_pd(exact, width)};
+  }
+
+  __attribute__((target("avx2")))
+  static std::size_t ziggurat_normals_avx2(
+      const ziggurat_table &table,
+      const std::uint64_t *bits,
+      double *output,
+      std::size_t count) {
+    std::size_t i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+      const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bits + i));
+      const auto lanes = ziggurat_load(table, x);
+      const __m256i accept = _mm256_cmpgt_epi64(lanes.threshold, lanes.position);
+      if (_mm256_movemask_pd(_mm256_castsi256_pd(accept)) != 0xf) {
+        break;
+      }
+      // Bit 8 of the word is the sign.
+      const __m256i sign = _mm256_slli_epi64(_mm256_srli_epi64(x, 8), 63);
+      _mm256_storeu_pd(output + i, _mm256_xor_pd(lanes.value, _mm256_castsi256_pd(sign)));
+    }
+    return i;
+  }
+
+  __attribute__((target("avx2")))
+  static std::size_t ziggurat_exponentials_avx2(
+      const ziggurat_table &table,
+      const std::uint64_t *bits,
+      double *output,
+      std::size_t count) {
+    std::size_t i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+      const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bits + i));
+      const auto lanes = ziggurat_load(table, x);
+      const __m256i accept = _mm256_cmpgt_epi64(lanes.threshold, lanes.position);
+      if (_mm256_movemask_pd(_mm256_castsi256_pd(accept)) != 0xf) {
+        break;
+      }
+      _mm256_storeu_pd(output + i, lanes.value);
+    }
+    return i;
+  }
+
+#endif // CRYPTO_ZIGGURAT_AVX2
+
+  std::size_t ziggurat_normals(
+      const ziggurat_table &table,
+      const std::uint64_t *bits,
+      double *output,
+      std::size_t count) {
+    std::size_t i = 0u;
+#ifdef CRYPTO_ZIGGURAT_AVX2
+    if (cpu_has_avx2()) {
+      i = ziggurat_normals_avx2(table, bits, output, count);
+      if (i + 4u <= count) {
+        return i;
+      }
+    }
+#endif // CRYPTO_ZIGGURAT_AVX2
+    for (; i < count; ++i) {
+      const auto layer = static_cast<std::size_t>(bits[i] & 0xffu);
+      const auto position = bits[i] >> 12;
+      if (position >= table.k[layer]) {
+        break;
+      }
+      output[i] = ziggurat_sign(static_cast<double>(position) * table.w[layer], bits[i]);
+    }
+    return i;
+  }
+
+  std::size_t ziggurat_exponentials(
+      const ziggurat_table &table,
+      const std::uint64_t *bits,
+      double *output,
+      std::size_t count) {
+    std::size_t i = 0u;
+#ifdef CRYPTO_ZIGGURAT_AVX2
+    if (cpu_has_avx2()) {
+      i = ziggurat_exponentials_avx2(table, bits, output, count);
+      if (i + 4u <= count) {
+        return i;
+      }
+    }
+#endif // CRYPTO_ZIGGURAT_AVX2
+    for (; i < count; ++i) {
+      const auto layer = static_cast<std::size_t>(bits[i] & 0xffu);
+      const auto position = bits[i] >> 12;
+      if (position >= table.k[layer]) {
+        break;
+      }
+      output[i] = static_cast<double>(position) * table.w[layer];
+    }
+    return i;
+  }
+
+} // namespace detail
+} // namespace crypto
@@ -0,0 +1,512 @@
+// Copyright (c) 2017 N Subiron Montoro. All rights reserved.
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "crypto/array_view.h"
+#include "crypto/random_bits.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace crypto {
+
+namespace detail {
+
+  /// Layers of a 256-layer ziggurat (Marsaglia and Tsang, 2000). Layer 0 is
+  /// the base rectangle plus the tail, layer i > 0 spans [0, x_i] below the
+  /// density f(x_(i-1)).
+  struct ziggurat_table {
+    /// Start of the tail, x_255.
+    double r;
+    /// Values of a layer below this 52-bit threshold fall inside the density
+    /// and are accepted right away.
+    std::uint64_t k[256u];
+    /// Width of each layer divided by 2^52.
+    double w[256u];
+    /// Density at x_i.
+    double f[256u];
+  };
+
+  /// Tables for the standard normal and standard exponential densities,
+  /// computed once on first use.
+  const ziggurat_table &normal_ziggurat();
+
+  const ziggurat_table &exponential_ziggurat();
+
+  /// Flips the sign of @a x if bit 8 of @a bits is set, without a branch.
+  static inline double ziggurat_sign(double x, std::uint64_t bits) {
+    std::uint64_t value;
+    std::memcpy(&value, &x, sizeof(value));
+    value ^= ((bits >> 8) & 1u) << 63;
+    std::memcpy(&x, &value, sizeof(x));
+    return x;
+  }
+
+  /// Rejection and tail cases of ziggurat_normal, kept out of line.
+  template <typename NEXT>
+  static double ziggurat_normal_slow(const ziggurat_table &table, std::uint64_t bits, NEXT &next) {
+    for (;;) {
+      const auto i = static_cast<std::size_t>(bits & 0xffu);
+      const auto position = bits >> 12;
+      auto x = static_cast<double>(position) * table.w[i];
+      if (position < table.k[i]) {
+        return ziggurat_sign(x, bits);
+      }
+      if (i == 0u) {
+        // Tail, Marsaglia (1964).
+        for (;;) {
+          const auto tx = -std::log1p(-to_unit_double(next())) / table.r;
+          const auto ty = -std::log1p(-to_unit_double(next()));
+          if (ty + ty > tx * tx) {
+            return ziggurat_sign(table.r + tx, bits);
+          }
+        }
+      }
+      const auto y = table.f[i] + (table.f[i - 1u] - table.f[i]) * to_unit_double(next());
+      if (y < std::exp(-0.5 * x * x)) {
+        return ziggurat_sign(x, bits);
+      }
+      bits = next();
+    }
+  }
+
+  /// Standard normal value from the 64-bit word @a bits: the low 8 bits
+  /// select the layer, bit 8 the sign and the top 52 bits the position. More
+  /// words are requested from @a next only in the rare rejection and tail
+  /// cases.
+  template <typename NEXT>
+  static inline double ziggurat_normal(const ziggurat_table &table, std::uint64_t bits, NEXT &&next) {
+    const auto i = static_cast<std::size_t>(bits & 0xffu);
+    const auto position = bits >> 12;
+    if (position < table.k[i]) {
+      return ziggurat_sign(static_cast<double>(position) * table.w[i], bits);
+    }
+    return ziggurat_normal_slow(table, bits, next);
+  }
+
+  /// Rejection and tail cases of ziggurat_exponential, kept out of line.
+  template <typename NEXT>
+  static double ziggurat_exponential_slow(const ziggurat_table &table, std::uint64_t bits, NEXT &next) {
+    for (;;) {
+      const auto i = static_cast<std::size_t>(bits & 0xffu);
+      const auto position = bits >> 12;
+      const auto x = static_cast<double>(position) * table.w[i];
+      if (position < table.k[i]) {
+        return x;
+      }
+      if (i == 0u) {
+        // The tail of the exponential is an exponential itself.
+        return table.r - std::log1p(-to_unit_double(next()));
+      }
+      const auto y = table.f[i] + (table.f[i - 1u] - table.f[i]) * to_unit_double(next());
+      if (y < std::exp(-x)) {
+        return x;
+      }
+      bits = next();
+    }
+  }
+
+  /// Standard exponential value from the 64-bit word @a bits: the low 8 bits
+  /// select the layer and the top 52 bits the position.
+  template <typename NEXT>
+  static inline double ziggurat_exponential(const ziggurat_table &table, std::uint64_t bits, NEXT &&next) {
+    const auto i = static_cast<std::size_t>(bits & 0xffu);
+    const auto position = bits >> 12;
+    if (position < table.k[i]) {
+      return static_cast<double>(position) * table.w[i];
+    }
+    return ziggurat_exponential_slow(table, bits, next);
+  }
+
+  /// @name Batch kernels
+  ///
+  /// Implemented in ziggurat.cpp, use AVX2 when the CPU supports it. Convert
+  /// the leading words of @a bits that are accepted on the first try, as
+  /// ziggurat_normal and ziggurat_exponential would, stopping at the first
+  /// word that is not. Return the number of values written.
+  /// @{
+
+  std::size_t ziggurat_normals(
+      const ziggurat_table &table,
+      const std::uint64_t *bits,
+      double *output,
+      std::size_t count);
+
+  std::size_t ziggurat_exponentials(
+      const ziggurat_table &table,
+      const std::uint64_t *bits,
+      double *output,
+      std::size_t count);
+
+  /// @}
+
+  /// Fills [output, output + count) with offset + scale * X, X drawn with
+  /// @a SAMPLE from @a table. Produces the same values, and leaves @a engine
+  /// in the same state, as calling @a SAMPLE once per element with words of
+  /// random_u64.
+  template <typename T, typename URBG, typename BULK, typename KERNEL, typename SAMPLE>
+  static void ziggurat_fill(
+      URBG &engine,
+      BULK &bulk,
+      T *output,
+      std::size_t count,
+      T offset,
+      T scale,
+      const ziggurat_table &table,
+      KERNEL &&kernel,
+      SAMPLE &&sample) {
+    double values[256u];
+    fill_blocks<std::uint64_t>(engine, bulk, count, [&](const std::uint64_t *bits, std::size_t n, std::size_t done) {
+      std::size_t written = 0u;
+      std::size_t i = 0u;
+      while (i < n) {
+        const auto fast = kernel(table, bits + i, values + written, n - i);
+        i += fast;
+        written += fast;
+        if (i == n) {
+          break;
+        }
+        values[written++] = sample(table, bits[i++], [&]() {
+          return (i < n) ? bits[i++] : random_u64(engine);
+        });
+      }
+      for (auto j = 0u; j < written; ++j) {
+        output[done + j] = offset + scale * static_cast<T>(values[j]);
+      }
+      return written;
+    });
+  }
+
+  template <typename URBG>
+  static inline double standard_normal(URBG &engine) {
+    return ziggurat_normal(normal_ziggurat(), random_u64(engine), [&]() { return random_u64(engine); });
+  }
+
+  template <typename URBG>
+  static inline double standard_exponential(URBG &engine) {
+    return ziggurat_exponential(exponential_ziggurat(), random_u64(engine), [&]() { return random_u64(engine); });
+  }
+
+  template <typename T, typename URBG, typename BULK>
+  static void normal_fill(URBG &engine, BULK &bulk, T *output, std::size_t count, T mean, T stddev) {
+    ziggurat_fill(engine, bulk, output, count, mean, stddev, normal_ziggurat(),
+        [](const ziggurat_table &t, const std::uint64_t *b, double *o, std::size_t n) {
+          return ziggurat_normals(t, b, o, n);
+        },
+        [](const ziggurat_table &t, std::uint64_t b, auto &&next) {
+          return ziggurat_normal(t, b, next);
+        });
+  }
+
+  template <typename T, typename URBG, typename BULK>
+  static void exponential_fill(URBG &engine, BULK &bulk, T *output, std::size_t count, T lambda) {
+    ziggurat_fill(engine, bulk, output, count, T(0), T(1) / lambda, exponential_ziggurat(),
+        [](const ziggurat_table &t, const std::uint64_t *b, double *o, std::size_t n) {
+          return ziggurat_exponentials(t, b, o, n);
+        },
+        [](const ziggurat_table &t, std::uint64_t b, auto &&next) {
+          return ziggurat_exponential(t, b, next);
+        });
+  }
+
+} // namespace detail
+
+  /// Normal distribution sampled with the ziggurat method, a single 64-bit
+  /// draw per value in about 99% of the cases. Replacement for
+  /// std::normal_distribution (it does not produce the same values).
+  template <typename RealType = double>
+  class normal_sampler {
+  public:
+
+    using result_type = RealType;
+
+    explicit normal_sampler(RealType mean = 0.0, RealType stddev = 1.0)
+      : _mean(mean),
+        _stddev(stddev) {}
+
+    RealType mean() const {
+      return _mean;
+    }
+
+    RealType stddev() const {
+      return _stddev;
+    }
+
+    result_type min() const {
+      return std::numeric_limits<RealType>::lowest();
+    }
+
+    result_type max() const {
+      return std::numeric_limits<RealType>::max();
+    }
+
+    void reset() {}
+
+    template <typename URBG>
+    result_type operator()(URBG &engine) const {
+      return _mean + _stddev * static_cast<RealType>(detail::standard_normal(engine));
+    }
+
+    template <typename URBG>
+    void generate(URBG &engine, mutable_array_view<result_type> output) const {
+      detail::normal_fill(engine, detail::underlying_engine<URBG>::get(engine), output.data(), output.size(), _mean, _stddev);
+    }
+
+  private:
+
+    RealType _mean;
+
+    RealType _stddev;
+  };
+
+  /// Exponential distribution sampled with the ziggurat method. Replacement
+  /// for std::exponential_distribution (it does not produce the same
+  /// values).
+  template <typename RealType = double>
+  class exponential_sampler {
+  public:
+
+    using result_type = RealType;
+
+    explicit exponential_sampler(RealType lambda = 1.0) : _lambda(lambda) {}
+
+    RealType lambda() const {
+      return _lambda;
+    }
+
+    result_type min() const {
+      return RealType(0);
+    }
+
+    result_type max() const {
+      return std::numeric_limits<RealType>::max();
+    }
+
+    void reset() {}
+
+    template <typename URBG>
+    result_type operator()(URBG &engine) const {
+      return (RealType(1) / _lambda) * static_cast<RealType>(detail::standard_exponential(engine));
+    }
+
+    template <typename URBG>
+    void generate(URBG &engine, mutable_array_view<result_type> output) const {
+      detail::exponential_fill(engine, detail::underlying_engine<URBG>::get(engine), output.data(), output.size(), _lambda);
+    }
+
+  private:
+
+    RealType _lambda;
+  };
+
+  /// Lognormal distribution, exp(m + s * N) with N drawn by normal_sampler.
+  template <typename RealType = double>
+  class lognormal_sampler {
+  public:
+
+    using result_type = RealType;
+
+    explicit lognormal_sampler(RealType m = 0.0, RealType s = 1.0) : _normal(m, s) {}
+
+    RealType m() const {
+      return _normal.mean();
+    }
+
+    RealType s() const {
+      return _normal.stddev();
+    }
+
+    result_type min() const {
+      return RealType(0);
+    }
+
+    result_type max() const {
+      return std::numeric_limits<RealType>::max();
+    }
+
+    void reset() {}
+
+    template <typename URBG>
+    result_type operator()(URBG &engine) const {
+      return std::exp(_normal(engine));
+    }
+
+    template <typename URBG>
+    void generate(URBG &engine, mutable_array_view<result_type> output) const {
+      _normal.generate(engine, output);
+      for (auto &value : output) {
+        value = std::exp(value);
+      }
+    }
+
+  private:
+
+    normal_sampler<RealType> _normal;
+  };
+
+  /// Gamma distribution with shape @a alpha and scale @a beta, sampled with
+  /// the method of Marsaglia and Tsang (2000) on top of normal_sampler.
+  /// Shapes below one are boosted with U^(1 / alpha).
+  template <typename RealType = double>
+  class gamma_sampler {
+  public:
+
+    using result_type = RealType;
+
+    explicit gamma_sampler(RealType alpha = 1.0, RealType beta = 1.0)
+      : _alpha(alpha),
+        _beta(beta),
+        _d((alpha < RealType(1) ? alpha + RealType(1) : alpha) - RealType(1) / RealType(3)),
+        _c(RealType(1) / std::sqrt(RealType(9) * _d)) {}
+
+    RealType alpha() const {
+      return _alpha;
+    }
+
+    RealType beta() const {
+      return _beta;
+    }
+
+    result_type min() const {
+      return RealType(0);
+    }
+
+    result_type max() const {
+      return std::numeric_limits<RealType>::max();
+    }
+
+    void reset() {}
+
+    template <typename URBG>
+    result_type operator()(URBG &engine) const {
+      const auto &table = detail::normal_ziggurat();
+      auto next = [&]() { return detail::random_u64(engine); };
+      for (;;) {
+        const auto x = detail::ziggurat_normal(table, next(), next);
+        auto v = 1.0 + static_cast<double>(_c) * x;
+        if (v <= 0.0) {
+          continue;
+        }
+        v = v * v * v;
+        const auto u = detail::to_unit_double(next());
+        const auto x2 = x * x;
+        const auto d = static_cast<double>(_d);
+        if (u < 1.0 - 0.0331 * x2 * x2 || std::log(u) < 0.5 * x2 + d * (1.0 - v + std::log(v))) {
+          auto result = d * v;
+          if (_alpha < RealType(1)) {
+            const auto boost = 1.0 - detail::to_unit_double(next());
+            result *= std::pow(boost, 1.0 / static_cast<double>(_alpha));
+          }
+          return static_cast<RealType>(result) * _beta;
+        }
+      }
+    }
+
+    template <typename URBG>
+    void generate(URBG &engine, mutable_array_view<result_type> output) const {
+      for (auto &value : output) {
+        value = (*this)(engine);
+      }
+    }
+
+  private:
+
+    RealType _alpha;
+
+    RealType _beta;
+
+    RealType _d;
+
+    RealType _c;
+  };
+
+  /// Chi-squared distribution with @a n degrees of freedom, a gamma
+  /// distribution of shape n / 2 and scale 2.
+  template <typename RealType = double>
+  class chi_squared_sampler {
+  public:
+
+    using result_type = RealType;
+
+    explicit chi_squared_sampler(RealType n = 1.0) : _gamma(n / RealType(2), RealType(2)) {}
+
+    RealType n() const {
+      return _gamma.alpha() * RealType(2);
+    }
+
+    result_type min() const {
+      return RealType(0);
+    }
+
+    result_type max() const {
+      return std::numeric_limits<RealType>::max();
+    }
+
+    void reset() {}
+
+    template <typename URBG>
+    result_type operator()(URBG &engine) const {
+      return _gamma(engine);
+    }
+
+    template <typename URBG>
+    void generate(URBG &engine, mutable_array_view<result_type> output) const {
+      _gamma.generate(engine, output);
+    }
+
+  private:
+
+    gamma_sampler<RealType> _gamma;
+  };
+
+  /// Student's t-distribution with @a n degrees of freedom, N / sqrt(X / n)
+  /// with N standard normal and X chi-squared.
+  template <typename RealType = double>
+  class student_t_sampler {
+  public:
+
+    using result_type = RealType;
+
+    explicit student_t_sampler(RealType n = 1.0) : _n(n), _chi_squared(n) {}
+
+    RealType n() const {
+      return _n;
+    }
+
+    result_type min() const {
+      return std::numeric_limits<RealType>::lowest();
+    }
+
+    result_type max() const {
+      return std::numeric_limits<RealType>::max();
+    }
+
+    void reset() {}
+
+    template <typename URBG>
+    result_type operator()(URBG &engine) const {
+      const auto z = static_cast<RealType>(detail::standard_normal(engine));
+      return z / std::sqrt(_chi_squared(engine) / _n);
+    }
+
+    template <typename URBG>
+    void generate(URBG &engine, mutable_array_view<result_type> output) const {
+      for (auto &value : output) {
+        value = (*this)(engine);
+      }
+    }
+
+  private:
+
+    RealType _n;
+
+    chi_squared_sampler<RealType> _chi_squared;
+  };
+
+} // namespace crypto
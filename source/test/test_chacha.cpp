@@ -0,0 +1,126 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <openssl/evp.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using namespace crypto;
+
+static const chacha20_engine::key_type test_key = {{
+  0x03020100u, 0x07060504u, 0x0b0a0908u, 0x0f0e0d0cu,
+  0x13121110u, 0x17161514u, 0x1b1a1918u, 0x1f1e1d1cu
+}};
+
+static std::vector<std::uint32_t> openssl_keystream(
+    const chacha20_engine::key_type &key,
+    std::uint64_t counter,
+    std::uint64_t stream,
+    std::size_t words) {
+  std::array<unsigned char, 32u> key_bytes;
+  std::memcpy(key_bytes.data(), key.data(), key_bytes.size());
+  const std::array<std::uint64_t, 2u> iv = {{counter, stream}};
+  std::vector<unsigned char> zeros(4u * words, 0u);
+  std::vector<std::uint32_t> result(words);
+  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+  int length = 0;
+  EVP_EncryptInit_ex(ctx, EVP_chacha20(), nullptr, key_bytes.data(), reinterpret_cast<const unsigned char *>(iv.data()));
+  EVP_EncryptUpdate(ctx, reinterpret_cast<unsigned char *>(result.data()), &length, zeros.data(), static_cast<int>(zeros.size()));
+  EVP_CIPHER_CTX_free(ctx);
+  return result;
+}
+
+TEST(chacha, zero_key) {
+  chacha20_engine engine(chacha20_engine::key_type{});
+  EXPECT_EQ(engine(), 0xade0b876u);
+  EXPECT_EQ(engine(), 0x903df1a0u);
+  EXPECT_EQ(engine(), 0xe56a5d40u);
+  EXPECT_EQ(engine(), 0x28bd8653u);
+}
+
+TEST(chacha, openssl) {
+  constexpr auto size = 1000u;
+  for (auto stream : {0x0ull, 0x4a000000ull, 0xfedcba9876543210ull}) {
+    chacha20_engine engine(test_key, stream);
+    const auto expected = openssl_keystream(test_key, 0u, stream, size);
+    for (auto i = 0u; i < size; ++i) {
+      ASSERT_EQ(engine(), expected[i]) << "at " << i;
+    }
+  }
+}
+
+TEST(chacha, seek) {
+  chacha20_engine engine(test_key, 7u);
+  const auto expected = openssl_keystream(test_key, 1000u, 7u, 300u);
+  for (auto offset = 0u; offset < 200u; offset += 13u) {
+    engine.seek(16000u + offset);
+    EXPECT_EQ(engine.position(), 16000u + offset);
+    for (auto i = offset; i < 300u; ++i) {
+      ASSERT_EQ(engine(), expected[i]) << "at " << i;
+    }
+  }
+}
+
+template <typename E>
+static void test_discard() {
+  E engine0;
+  E engine1;
+  for (auto step : {0u, 1u, 15u, 16u, 17u, 127u, 128u, 129u, 1000u}) {
+    for (auto i = 0u; i < step; ++i) {
+      engine0();
+    }
+    engine1.discard(step);
+    ASSERT_EQ(engine0.position(), engine1.position());
+    ASSERT_EQ(engine0(), engine1());
+    ASSERT_TRUE(engine0 == engine1);
+  }
+}
+
+TEST(chacha, discard) {
+  test_discard<chacha8_engine>();
+  test_discard<chacha12_engine>();
+  test_discard<chacha20_engine>();
+}
+
+TEST(chacha, counter_overflow) {
+  chacha12_engine engine0(42u);
+  chacha12_engine engine1(42u);
+  const auto position = (std::uint64_t(1u) << 36) - 21u;
+  engine0.seek(position);
+  for (auto i = 0u; i < 1000u; ++i) {
+    engine1.seek(position + i);
+    ASSERT_EQ(engine0(), engine1());
+  }
+  engine0.seek(std::uint64_t(-5));
+  engine0.discard(10u);
+  EXPECT_EQ(engine0.position(), 5u);
+}
+
+TEST(chacha, generate) {
+  chacha20_engine engine0(1234u);
+  chacha20_engine engine1(1234u);
+  std::vector<std::uint32_t> buffer;
+  for (auto size : {0u, 3u, 16u, 100u, 128u, 1000u, 4097u}) {
+    buffer.resize(size);
+    engine0.generate(buffer.data(), buffer.data() + buffer.size());
+    for (auto value : buffer) {
+      ASSERT_EQ(value, engine1());
+    }
+    ASSERT_EQ(engine0.position(), engine1.position());
+  }
+}
+
+TEST(chacha, adaptor) {
+  random_engine_adaptor<chacha20_engine> rng0(99u);
+  crypto::chacha20 rng1;
+  rng0.seek(12345u);
+  rng1.seek(12345u);
+  EXPECT_EQ(rng0.position(), 12345u);
+  rng0.discard(5u);
+  rng1.discard(5u);
+  EXPECT_EQ(rng0.position(), 12350u);
+  EXPECT_EQ(rng1.position(), 12350u);
+}
@@ -0,0 +1,116 @@
+#include "crypto/chunker.h"
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+using namespace crypto;
+
+static std::vector<byte> random_data(std::size_t size, std::uint64_t seed = 42u) {
+  crypto::xoshiro256starstar rng(seed);
+  std::vector<byte> data(size);
+  rng.uniform_n(array_view::make_mutable(data), byte(0u), byte(255u));
+  return data;
+}
+
+/// Chunks cover @a data in order, with sizes in bounds and digests of their
+/// bytes.
+static void check_chunks(const chunker &chunker, const std::vector<byte> &data, const std::vector<chunk> &chunks) {
+  std::uint64_t offset = 0u;
+  for (auto i = 0u; i < chunks.size(); ++i) {
+    const auto &c = chunks[i];
+    ASSERT_EQ(offset, c.offset);
+    ASSERT_LE(c.length, chunker.max_size());
+    if (i + 1u < chunks.size()) {
+      ASSERT_GE(c.length, chunker.min_size());
+    }
+    sha256_digest expected;
+    digest(buffer_view::make_const(data.data() + c.offset, c.length), expected);
+    ASSERT_EQ(expected, c.digest);
+    offset += c.length;
+  }
+  ASSERT_EQ(data.size(), offset);
+}
+
+TEST(chunker, chunks) {
+  const chunker chunker;
+  const auto data = random_data(4u << 20);
+  const auto chunks = chunker(buffer_view::make_const(data), 1u);
+  check_chunks(chunker, data, chunks);
+  // Normalized chunking keeps the average close to the target.
+  const auto average = static_cast<double>(data.size()) / static_cast<double>(chunks.size());
+  EXPECT_GT(average, 0.75 * chunker.average_size());
+  EXPECT_LT(average, 1.5 * chunker.average_size());
+}
+
+TEST(chunker, small_and_constant_data) {
+  const chunker chunker(1024u, 256u, 4096u);
+  EXPECT_TRUE(chunker(buffer_view::make_const(std::vector<byte>{}), 1u).empty());
+  const auto tiny = random_data(100u);
+  const auto chunks = chunker(buffer_view::make_const(tiny), 1u);
+  ASSERT_EQ(1u, chunks.size());
+  EXPECT_EQ(100u, chunks[0u].length);
+  const std::vector<byte> zeros(100000u, 0u);
+  check_chunks(chunker, zeros, chunker(buffer_view::make_const(zeros), 1u));
+}
+
+TEST(chunker, parallel_matches_sequential) {
+  const chunker chunker(1024u, 256u, 8192u);
+  const auto data = random_data(9u << 20);
+  const auto sequential = chunker(buffer_view::make_const(data), 1u);
+  for (auto threads : {2u, 3u, 8u}) {
+    ASSERT_EQ(sequential, chunker(buffer_view::make_const(data), threads)) << threads << " threads";
+  }
+  check_chunks(chunker, data, sequential);
+}
+
+TEST(chunker, stream_matches_buffer) {
+  const chunker chunker(2048u, 512u, 16384u);
+  const auto data = random_data(1u << 20);
+  const auto expected = chunker(buffer_view::make_const(data), 1u);
+  crypto::pcg64 rng(7u);
+  chunk_stream stream(chunker);
+  std::vector<chunk> chunks;
+  for (std::size_t position = 0u; position < data.size();) {
+    const auto size = std::min<std::size_t>(rng.uniform<std::size_t>(0u, 5000u), data.size() - position);
+    stream.update(buffer_view::make_const(data.data() + position, size), chunks);
+    position += size;
+  }
+  EXPECT_EQ(data.size(), stream.position());
+  stream.finish(chunks);
+  EXPECT_EQ(expected, chunks);
+  // The stream restarts after finish().
+  chunks.clear();
+  stream.update(buffer_view::make_const(data), chunks);
+  stream.finish(chunks);
+  EXPECT_EQ(expected, chunks);
+}
+
+TEST(chunker, insertion_keeps_most_chunks) {
+  const chunker chunker;
+  auto data = random_data(2u << 20);
+  const auto before = chunker(buffer_view::make_const(data), 1u);
+  data.insert(data.begin() + static_cast<std::ptrdiff_t>(data.size() / 2u), 100u, byte(1u));
+  const auto after = chunker(buffer_view::make_const(data), 1u);
+  std::set<sha256_digest> digests;
+  for (const auto &c : before) {
+    digests.insert(c.digest);
+  }
+  std::size_t shared = 0u;
+  for (const auto &c : after) {
+    shared += digests.count(c.digest);
+  }
+  EXPECT_GE(shared + 3u, before.size());
+}
+
+TEST(chunker, invalid_sizes) {
+  EXPECT_THROW(chunker(8192u, 32u, 65536u), std::invalid_argument);
+  EXPECT_THROW(chunker(8192u, 16384u, 65536u), std::invalid_argument);
+  EXPECT_THROW(chunker(8192u, 2048u, 4096u), std::invalid_argument);
+  EXPECT_THROW(chunker(6000u, 2048u, 65536u), std::invalid_argument);
+  EXPECT_NO_THROW(chunker(4096u, 4096u, 4096u));
+}
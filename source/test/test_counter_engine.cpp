@@ -0,0 +1,141 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace crypto;
+
+using philox = detail::philox4x32_generator<10u>;
+using threefry = detail::threefry4x64_generator<20u>;
+
+// Known answers of the Random123 reference implementation.
+TEST(counter_engine, philox4x32_known_answers) {
+  EXPECT_EQ(
+      philox::block({{0u, 0u, 0u, 0u}}, {{0u, 0u}}),
+      (philox::block_type{{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}}));
+  EXPECT_EQ(
+      philox::block({{0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}}, {{0xffffffffu, 0xffffffffu}}),
+      (philox::block_type{{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}}));
+  EXPECT_EQ(
+      philox::block({{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}}, {{0xa4093822u, 0x299f31d0u}}),
+      (philox::block_type{{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}}));
+}
+
+TEST(counter_engine, threefry4x64_known_answers) {
+  EXPECT_EQ(
+      threefry::block({{0u, 0u, 0u, 0u}}, {{0u, 0u, 0u, 0u}}),
+      (threefry::block_type{{
+        0x09218ebde6c85537u, 0x55941f5266d86105u, 0x4bd25e16282434dcu, 0xee29ec846bd2e40bu}}));
+  const auto ones = ~std::uint64_t(0u);
+  EXPECT_EQ(
+      threefry::block({{ones, ones, ones, ones}}, {{ones, ones, ones, ones}}),
+      (threefry::block_type{{
+        0x29c24097942bba1bu, 0x0371bbfb0f6f4e11u, 0x3c231ffa33f83a1cu, 0xcd29113fde32d168u}}));
+}
+
+template <typename ENGINE>
+static void check_engine() {
+  typename ENGINE::key_type key;
+  for (auto i = 0u; i < key.size(); ++i)
+    key[i] = 0x01234567u * (i + 1u);
+  ENGINE engine(key, 42u);
+  std::vector<typename ENGINE::result_type> values(1000u);
+  for (auto &value : values)
+    value = engine();
+  ASSERT_EQ(engine.position(), values.size());
+  const auto block = ENGINE::block_size;
+  for (auto i = 0u; i < values.size(); ++i)
+    ASSERT_EQ(engine.at(i), values[i]) << "at " << i;
+  // Random access.
+  for (auto position : {0u, 1u, 3u, 4u, 17u, 999u}) {
+    engine.seek(position);
+    ASSERT_EQ(engine.position(), position);
+    ASSERT_EQ(engine(), values[position]);
+  }
+  engine.seek(10u);
+  engine.discard(block * 50u + 3u);
+  ASSERT_EQ(engine(), values[10u + block * 50u + 3u]);
+  // Bulk generation.
+  for (auto start : {0u, 1u, 5u}) {
+    engine.seek(start);
+    std::vector<typename ENGINE::result_type> bulk(values.size() - start - 7u);
+    engine.generate(bulk.data(), bulk.data() + bulk.size());
+    ASSERT_TRUE(std::equal(bulk.begin(), bulk.end(), values.begin() + start));
+    ASSERT_EQ(engine(), values[start + bulk.size()]);
+  }
+  // Streams.
+  ENGINE other(key, 43u);
+  ASSERT_NE(other(), values[0u]);
+  other.set_stream(42u);
+  ASSERT_EQ(other(), values[0u]);
+  engine.seek(1u);
+  ASSERT_TRUE(engine == other);
+  // Seeding.
+  std::seed_seq seed{1, 2, 3};
+  ENGINE a(seed);
+  ENGINE b(seed);
+  ASSERT_TRUE(a == b);
+  ASSERT_EQ(a(), b());
+  ASSERT_NE(ENGINE(1u)(), ENGINE(2u)());
+}
+
+TEST(counter_engine, philox4x32) {
+  check_engine<philox4x32_engine>();
+}
+
+TEST(counter_engine, threefry4x64) {
+  check_engine<threefry4x64_engine>();
+}
+
+TEST(counter_engine, adaptor) {
+  crypto::philox4x32 rng0;
+  crypto::threefry4x64 rng1;
+  double sum = 0.0;
+  for (auto i = 0u; i < 10000u; ++i)
+    sum += rng0.uniform<double>() + rng1.uniform<double>();
+  EXPECT_NEAR(sum / 20000.0, 0.5, 0.01);
+}
+
+template <typename ENGINE, typename DISTRIBUTION>
+static void check_parallel_generate(const DISTRIBUTION &distribution) {
+  using value_type = typename DISTRIBUTION::result_type;
+  std::vector<value_type> expected(50000u);
+  parallel_generate<ENGINE>(expected, distribution, 1234u, 1u);
+  for (auto threads : {2u, 3u, 8u}) {
+    std::vector<value_type> values(expected.size());
+    parallel_generate<ENGINE>(values, distribution, 1234u, threads);
+    ASSERT_EQ(values, expected) << threads << " threads";
+  }
+  // Part of the range on its own.
+  std::vector<value_type> part(777u);
+  parallel_generate<ENGINE>(part.begin(), part.end(), distribution, 1234u, 2u, 20000u);
+  ASSERT_TRUE(std::equal(part.begin(), part.end(), expected.begin() + 20000));
+  parallel_generate<ENGINE>(part, distribution, 1234u, 3u, 40000u);
+  ASSERT_TRUE(std::equal(part.begin(), part.end(), expected.begin() + 40000));
+
+  std::vector<value_type> other(expected.size());
+  parallel_generate<ENGINE>(other, distribution, 1235u, 4u);
+  ASSERT_NE(other, expected);
+}
+
+TEST(counter_engine, parallel_generate) {
+  check_parallel_generate<philox4x32_engine>(std::normal_distribution<double>(1.0, 2.0));
+  check_parallel_generate<philox4x32_engine>(std::uniform_int_distribution<int>(0, 99));
+  check_parallel_generate<threefry4x64_engine>(std::gamma_distribution<double>(0.5));
+  check_parallel_generate<threefry4x64_engine>(crypto::normal_sampler<float>());
+
+  std::vector<double> values(100000u);
+  parallel_generate(values, std::normal_distribution<double>(), 7u, 4u);
+  double sum = 0.0;
+  double squares = 0.0;
+  for (auto value : values) {
+    sum += value;
+    squares += value * value;
+  }
+  EXPECT_NEAR(sum / values.size(), 0.0, 0.02);
+  EXPECT_NEAR(squares / values.size(), 1.0, 0.02);
+}
@@ -0,0 +1,201 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace crypto;
+
+TEST(discrete_sampler, frequencies) {
+  const std::vector<double> weights = {1.0, 0.0, 2.0, 5.0, 0.5, 1.5};
+  const auto total = std::accumulate(weights.begin(), weights.end(), 0.0);
+  discrete_sampler<int> sampler(weights.begin(), weights.end());
+  ASSERT_EQ(sampler.size(), weights.size());
+  std::seed_seq seed{1, 2, 3};
+  crypto::xoshiro256starstar rng(seed);
+  constexpr auto count = 1000000u;
+  std::vector<int> values(count);
+  sampler.generate(rng, array_view::make_mutable(values));
+  std::vector<double> histogram(weights.size(), 0.0);
+  for (auto value : values) {
+    ASSERT_GE(value, 0);
+    ASSERT_LT(value, static_cast<int>(weights.size()));
+    histogram[value] += 1.0;
+  }
+  for (auto i = 0u; i < weights.size(); ++i) {
+    const auto p = weights[i] / total;
+    const auto sigma = std::sqrt(count * p * (1.0 - p));
+    EXPECT_NEAR(histogram[i], count * p, 5.0 * sigma + 1e-9) << "at " << i;
+  }
+}
+
+TEST(discrete_sampler, large) {
+  std::vector<double> weights(100000u);
+  for (auto i = 0u; i < weights.size(); ++i)
+    weights[i] = (i % 7u == 0u) ? 0.0 : 1.0 + i % 13u;
+  crypto::pcg64 rng;
+  auto sampler = rng.make_discrete(weights.begin(), weights.end());
+  for (auto i = 0u; i < 100000u; ++i) {
+    auto value = sampler();
+    ASSERT_GE(value, 0);
+    ASSERT_LT(value, 100000);
+    ASSERT_NE(value % 7, 0);
+  }
+}
+
+TEST(discrete_sampler, invalid) {
+  const std::vector<double> zeros(3u, 0.0);
+  EXPECT_THROW(discrete_sampler<>(zeros.begin(), zeros.end()), std::invalid_argument);
+  EXPECT_THROW(discrete_sampler<>({1.0, -1.0}), std::invalid_argument);
+  EXPECT_EQ(discrete_sampler<>().size(), 1u);
+}
+
+template <typename SAMPLER, typename STD_DISTRIBUTION>
+static void compare_moments(SAMPLER &&sampler, STD_DISTRIBUTION &&dist) {
+  std::seed_seq seed0{4, 5, 6};
+  std::seed_seq seed1{7, 8, 9};
+  crypto::mt19937 rng0(seed0);
+  crypto::mt19937 rng1(seed1);
+  constexpr auto count = 400000u;
+  double sum0 = 0.0, sum1 = 0.0, sq0 = 0.0, sq1 = 0.0;
+  for (auto i = 0u; i < count; ++i) {
+    const double x0 = sampler(rng0);
+    const double x1 = dist(rng1);
+    ASSERT_GE(x0, sampler.min());
+    ASSERT_LE(x0, sampler.max());
+    sum0 += x0;
+    sum1 += x1;
+    sq0 += x0 * x0;
+    sq1 += x1 * x1;
+  }
+  const auto mean0 = sum0 / count, mean1 = sum1 / count;
+  const auto var0 = sq0 / count - mean0 * mean0;
+  const auto var1 = sq1 / count - mean1 * mean1;
+  EXPECT_NEAR(mean0, mean1, 10.0 * std::sqrt(var1 / count));
+  EXPECT_NEAR(var0, var1, 0.02 * var1);
+}
+
+TEST(discrete_sampler, piecewise_constant) {
+  const std::vector<double> b = {-1.0, 0.0, 0.5, 2.0, 3.0, 10.0};
+  const std::vector<double> w = {1.0, 3.0, 0.0, 2.0, 0.1};
+  compare_moments(
+      piecewise_constant_sampler<double>(b.begin(), b.end(), w.begin()),
+      std::piecewise_constant_distribution<double>(b.begin(), b.end(), w.begin()));
+}
+
+TEST(discrete_sampler, piecewise_linear) {
+  const std::vector<double> b = {-1.0, 0.0, 0.5, 2.0, 3.0, 10.0};
+  const std::vector<double> w = {0.0, 3.0, 3.0, 2.0, 0.1, 1.0};
+  compare_moments(
+      piecewise_linear_sampler<double>(b.begin(), b.end(), w.begin()),
+      std::piecewise_linear_distribution<double>(b.begin(), b.end(), w.begin()));
+}
+
+TEST(discrete_sampler, std_constructors) {
+  const auto fw = [](double x) { return 1.0 + x * x; };
+  const discrete_sampler<> counted(4u, -1.0, 3.0, fw);
+  const std::discrete_distribution<> std_counted(4u, -1.0, 3.0, fw);
+  ASSERT_EQ(counted.size(), 4u);
+  for (auto i = 0u; i < 4u; ++i)
+    EXPECT_NEAR(counted.probabilities()[i], std_counted.probabilities()[i], 1e-12);
+  EXPECT_EQ(discrete_sampler<>(0u, 0.0, 1.0, fw).size(), 1u);
+
+  compare_moments(
+      piecewise_constant_sampler<double>({-1.0, 0.0, 2.0, 3.0}, fw),
+      std::piecewise_constant_distribution<double>({-1.0, 0.0, 2.0, 3.0}, fw));
+  compare_moments(
+      piecewise_constant_sampler<double>(5u, -1.0, 3.0, fw),
+      std::piecewise_constant_distribution<double>(5u, -1.0, 3.0, fw));
+  compare_moments(
+      piecewise_linear_sampler<double>({-1.0, 0.0, 2.0, 3.0}, fw),
+      std::piecewise_linear_distribution<double>({-1.0, 0.0, 2.0, 3.0}, fw));
+  // libstdc++ takes the densities at b + delta rather than at the
+  // boundaries b, compare with the boundaries and densities given.
+  const std::vector<double> b = {-1.0, -0.2, 0.6, 1.4, 2.2, 3.0};
+  std::vector<double> w;
+  for (auto x : b)
+    w.push_back(fw(x));
+  compare_moments(
+      piecewise_linear_sampler<double>(5u, -1.0, 3.0, fw),
+      std::piecewise_linear_distribution<double>(b.begin(), b.end(), w.begin()));
+
+  // Less than two boundaries and the default constructors give [0, 1).
+  for (const auto &sampler : {piecewise_constant_sampler<double>({2.0}, fw), piecewise_constant_sampler<double>()}) {
+    EXPECT_EQ(sampler.min(), 0.0);
+    EXPECT_EQ(sampler.max(), 1.0);
+  }
+  for (const auto &sampler : {piecewise_linear_sampler<double>({}, fw), piecewise_linear_sampler<double>()}) {
+    EXPECT_EQ(sampler.min(), 0.0);
+    EXPECT_EQ(sampler.max(), 1.0);
+    EXPECT_NEAR(sampler.quantile(0.25), 0.25, 1e-12);
+  }
+
+  crypto::xoshiro256starstar rng(3u);
+  auto discrete = rng.make_discrete({0.0, 1.0, 0.0});
+  auto counted_discrete = rng.make_discrete(3u, 0.0, 3.0, [](double x) { return x < 1.0 ? 1.0 : 0.0; });
+  auto constant = rng.make_piecewise_constant({1.0, 2.0}, fw);
+  auto linear = rng.make_piecewise_linear(4u, 0.0, 1.0, fw);
+  for (auto i = 0u; i < 100u; ++i) {
+    ASSERT_EQ(discrete(), 1);
+    ASSERT_EQ(counted_discrete(), 0);
+    const auto x = constant();
+    ASSERT_TRUE(x >= 1.0 && x <= 2.0);
+    const auto y = linear();
+    ASSERT_TRUE(y >= 0.0 && y <= 1.0);
+  }
+}
+
+TEST(discrete_sampler, quantile_is_monotonic) {
+  const std::vector<double> b = {0.0, 1.0, 2.0, 4.0};
+  const std::vector<double> w = {1.0, 0.0, 2.0, 0.5};
+  piecewise_linear_sampler<double> sampler(b.begin(), b.end(), w.begin());
+  double previous = sampler.min();
+  for (auto i = 0u; i < 10000u; ++i) {
+    const auto x = sampler.quantile(i / 10000.0);
+    ASSERT_GE(x, previous);
+    previous = x;
+  }
+  EXPECT_LE(previous, sampler.max());
+}
+
+/// Engine whose output maps to the largest uniform double below 1, which
+/// rounds to 1 as a float.
+struct max_engine {
+  using result_type = std::uint64_t;
+
+  static constexpr result_type min() {
+    return 0u;
+  }
+
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() {
+    return max();
+  }
+};
+
+TEST(discrete_sampler, float_zero_weight_tail) {
+  const std::vector<float> b = {0.0f, 1.0f, 2.0f, 3.0f};
+  const std::vector<float> w = {1.0f, 2.0f, 0.0f};
+  const piecewise_constant_sampler<float> constant(b.begin(), b.end(), w.begin());
+  max_engine engine;
+  const auto x = constant(engine);
+  ASSERT_FALSE(std::isnan(x));
+  EXPECT_FLOAT_EQ(2.0f, x);
+  crypto::xoshiro256starstar rng(3u);
+  for (auto i = 0u; i < 100000u; ++i) {
+    const auto value = constant(rng);
+    ASSERT_GE(value, 0.0f);
+    ASSERT_LE(value, 2.0f);
+  }
+  const std::vector<float> d = {1.0f, 2.0f, 0.0f, 0.0f};
+  const piecewise_linear_sampler<float> linear(b.begin(), b.end(), d.begin());
+  EXPECT_LE(linear(engine), 2.0f);
+}
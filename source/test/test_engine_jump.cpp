@@ -0,0 +1,66 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+
+using namespace crypto;
+
+template <typename ENGINE>
+static void check_jump(unsigned long long n) {
+  ENGINE expected(42u);
+  expected();
+  auto engine = expected;
+  expected.discard(n);
+  jump_ahead(engine, n);
+  for (auto i = 0u; i < 2000u; ++i)
+    ASSERT_EQ(engine(), expected()) << "jump " << n << ", at " << i;
+}
+
+TEST(engine_jump, linear_congruential) {
+  for (auto n : {0ull, 1ull, 2ull, 1000ull, 12345678ull}) {
+    check_jump<std::minstd_rand0>(n);
+    check_jump<std::minstd_rand>(n);
+  }
+  // The period of minstd is 2^31 - 2.
+  std::minstd_rand0 engine(7u);
+  const auto expected = engine;
+  jump_ahead(engine, 2147483646ull * 3u);
+  EXPECT_EQ(engine, expected);
+}
+
+TEST(engine_jump, mersenne_twister) {
+  for (auto n : {0ull, 1ull, 623ull, 625ull, (1ull << 20) + 1ull, 3000017ull}) {
+    check_jump<std::mt19937>(n);
+    check_jump<std::mt19937_64>(n);
+  }
+}
+
+TEST(engine_jump, composes) {
+  const auto n = 1ull << 40;
+  std::mt19937 a(5u);
+  auto b = a;
+  jump_ahead(a, n);
+  jump_ahead(a, n);
+  jump_ahead(b, 2u * n);
+  for (auto i = 0u; i < 1000u; ++i)
+    ASSERT_EQ(a(), b());
+}
+
+TEST(engine_jump, adaptor) {
+  std::seed_seq seed{1, 2, 3};
+  default_random_engine rng1(seed);
+  default_random_engine rng2(seed);
+  rng1.jump(1000000u);
+  rng2.discard(1000000u);
+  for (auto i = 0u; i < 1000u; ++i)
+    ASSERT_EQ(rng1.uniform<int>(0, 1000), rng2.uniform<int>(0, 1000));
+
+  crypto::mt19937 mt1(seed);
+  crypto::mt19937 mt2(seed);
+  mt1.jump(5000000u);
+  mt2.discard(5000000u);
+  for (auto i = 0u; i < 1000u; ++i)
+    ASSERT_EQ(mt1.uniform<int>(0, 1000), mt2.uniform<int>(0, 1000));
+}
@@ -0,0 +1,140 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace crypto;
+
+/// Saves @a engine after advancing it a bit, and checks that an engine
+/// restored from the state produces the same values.
+template <typename ENGINE>
+static void check_round_trip(ENGINE engine) {
+  for (auto i = 0u; i < 1234u; ++i)
+    engine();
+  std::vector<byte> buffer(engine_state_size(engine));
+  ASSERT_EQ(save_engine_state(engine, buffer), buffer.size());
+  ENGINE restored;
+  load_engine_state(restored, buffer);
+  for (auto i = 0u; i < 10000u; ++i)
+    ASSERT_EQ(restored(), engine()) << "at " << i;
+}
+
+TEST(engine_state, round_trip) {
+  check_round_trip(std::minstd_rand0(42u));
+  check_round_trip(std::minstd_rand(42u));
+  check_round_trip(std::mt19937(42u));
+  check_round_trip(std::mt19937_64(42u));
+  check_round_trip(std::ranlux24_base(42u));
+  check_round_trip(xoshiro256starstar_engine(42u));
+  check_round_trip(xoroshiro128plus_engine(42u));
+  check_round_trip(pcg64_engine(42u));
+  check_round_trip(chacha8_engine(42u));
+  check_round_trip(chacha20_engine(42u));
+  check_round_trip(philox4x32_engine(42u));
+  check_round_trip(threefry4x64_engine(42u));
+  check_round_trip(sfmt19937_engine(42u));
+  check_round_trip(dsfmt19937_engine(42u));
+}
+
+TEST(engine_state, compact) {
+  EXPECT_EQ(engine_state_size(std::mt19937()), 16u + 624u * 4u);
+  EXPECT_EQ(engine_state_size(std::mt19937_64()), 16u + 312u * 8u);
+  EXPECT_EQ(engine_state_size(std::minstd_rand()), 16u + 32u);
+  EXPECT_EQ(engine_state_size(xoshiro256starstar_engine()), 16u + 32u);
+  EXPECT_EQ(engine_state_size(pcg64_engine()), 16u + 32u);
+  EXPECT_EQ(engine_state_size(chacha20_engine()), 16u + 48u);
+  EXPECT_EQ(engine_state_size(philox4x32_engine()), 16u + 24u);
+}
+
+TEST(engine_state, keeps_stream_and_position) {
+  chacha20_engine engine(7u);
+  engine.set_key(engine.key(), 99u);
+  engine.discard(13u);
+  std::vector<byte> buffer(engine_state_size(engine));
+  save_engine_state(engine, buffer);
+  chacha20_engine restored;
+  load_engine_state(restored, buffer);
+  EXPECT_EQ(restored, engine);
+  EXPECT_EQ(restored.stream(), 99u);
+  EXPECT_EQ(restored.position(), 13u);
+}
+
+TEST(engine_state, invalid_state) {
+  pcg64_engine engine(1u);
+  std::vector<byte> buffer(engine_state_size(engine));
+  std::vector<byte> small(buffer.size() - 1u);
+  EXPECT_THROW(save_engine_state(engine, small), std::invalid_argument);
+  save_engine_state(engine, buffer);
+
+  const pcg64_engine original(2u);
+  auto other = original;
+  const_buffer_view truncated(buffer.data(), buffer.size() - 1u);
+  EXPECT_THROW(load_engine_state(other, truncated), std::invalid_argument);
+  xoshiro256starstar_engine xoshiro;
+  EXPECT_THROW(load_engine_state(xoshiro, buffer), std::invalid_argument);
+  auto corrupt = buffer;
+  corrupt[0u] ^= 1u;
+  EXPECT_THROW(load_engine_state(other, corrupt), std::invalid_argument);
+  corrupt = buffer;
+  corrupt[4u] = 2u;
+  EXPECT_THROW(load_engine_state(other, corrupt), std::invalid_argument);
+  corrupt = buffer;
+  corrupt[16u + 24u] &= 0xfeu; // Even increment.
+  EXPECT_THROW(load_engine_state(other, corrupt), std::invalid_argument);
+  EXPECT_EQ(other, original);
+
+  load_engine_state(other, buffer);
+  EXPECT_EQ(other, engine);
+}
+
+TEST(engine_state, other_parameters) {
+  // Same word size, state size and recurrence as std::mt19937, another
+  // initialization multiplier.
+  using mt19937_other = std::mersenne_twister_engine<
+      std::uint_fast32_t, 32, 624, 397, 31, 0x9908b0df, 11, 0xffffffff,
+      7, 0x9d2c5680, 15, 0xefc60000, 18, 1812433255>;
+  std::mt19937 mt(1u);
+  std::vector<byte> buffer(engine_state_size(mt));
+  save_engine_state(mt, buffer);
+  mt19937_other other_mt;
+  ASSERT_EQ(engine_state_size(other_mt), buffer.size());
+  EXPECT_THROW(load_engine_state(other_mt, buffer), std::invalid_argument);
+
+  std::minstd_rand0 lcg(1u);
+  buffer.resize(engine_state_size(lcg));
+  save_engine_state(lcg, buffer);
+  std::minstd_rand other_lcg;
+  EXPECT_THROW(load_engine_state(other_lcg, buffer), std::invalid_argument);
+
+  // Both stored as text.
+  std::ranlux24_base ranlux(1u);
+  buffer.resize(engine_state_size(ranlux));
+  save_engine_state(ranlux, buffer);
+  std::ranlux48_base other_ranlux;
+  EXPECT_THROW(load_engine_state(other_ranlux, buffer), std::invalid_argument);
+  std::knuth_b knuth;
+  EXPECT_THROW(load_engine_state(knuth, buffer), std::invalid_argument);
+}
+
+TEST(engine_state, adaptor) {
+  random_engine_adaptor<std::mt19937_64> engine(3u);
+  engine.discard(1000u);
+  std::vector<byte> buffer(engine.state_size());
+  EXPECT_EQ(engine.save_state(buffer), buffer.size());
+  random_engine_adaptor<std::mt19937_64> restored;
+  restored.load_state(buffer);
+  for (auto i = 0u; i < 1000u; ++i)
+    ASSERT_EQ(restored(), engine());
+
+  default_random_engine seeded;
+  std::vector<byte> state(seeded.state_size());
+  seeded.save_state(state);
+  default_random_engine other;
+  other.load_state(state);
+  for (auto i = 0u; i < 1000u; ++i)
+    ASSERT_EQ(other.uniform<int>(0, 1000), seeded.uniform<int>(0, 1000));
+}
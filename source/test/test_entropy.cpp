@@ -0,0 +1,74 @@
+#include "crypto/entropy.h"
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+using namespace crypto;
+
+TEST(entropy, system_entropy) {
+  std::unordered_set<std::uint32_t> seen;
+  // Cross the end of the pool several times, and request more than a pool.
+  for (auto size : {1u, 7u, 300u, 1000u, 5000u}) {
+    std::vector<std::uint32_t> words(size);
+    ASSERT_TRUE(detail::system_entropy(words.data(), words.size()));
+    for (auto word : words)
+      seen.insert(word);
+  }
+  // Collisions among 6308 random words are unlikely.
+  EXPECT_GE(seen.size(), 6300u);
+
+  std::array<unsigned, 32u> ones{};
+  std::vector<std::uint32_t> words(10000u);
+  ASSERT_TRUE(detail::system_entropy(words.data(), words.size()));
+  for (auto word : words)
+    for (auto bit = 0u; bit < 32u; ++bit)
+      ones[bit] += (word >> bit) & 1u;
+  for (auto count : ones)
+    EXPECT_NEAR(count, 5000.0, 6.0 * std::sqrt(2500.0));
+}
+
+// After fork(), parent and child must not get the same words from the pool.
+TEST(entropy, fork) {
+  std::uint32_t word;
+  ASSERT_TRUE(detail::system_entropy(&word, 1u));
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  const auto pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    std::array<std::uint32_t, 4u> words;
+    const bool ok = detail::system_entropy(words.data(), words.size());
+    const auto written = write(fds[1], words.data(), sizeof(words));
+    _exit(ok && written == sizeof(words) ? 0 : 1);
+  }
+  std::array<std::uint32_t, 4u> parent;
+  ASSERT_TRUE(detail::system_entropy(parent.data(), parent.size()));
+  std::array<std::uint32_t, 4u> child;
+  ASSERT_EQ(read(fds[0], child.data(), sizeof(child)), static_cast<ssize_t>(sizeof(child)));
+  int status = 0;
+  waitpid(pid, &status, 0);
+  close(fds[0]);
+  close(fds[1]);
+  ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  EXPECT_NE(parent, child);
+}
+
+TEST(entropy, auto_seeded) {
+  randutils::auto_seed_256 seed0;
+  randutils::auto_seed_256 seed1;
+  std::array<std::uint32_t, 8u> words0;
+  std::array<std::uint32_t, 8u> words1;
+  seed0.generate(words0.begin(), words0.end());
+  seed1.generate(words1.begin(), words1.end());
+  EXPECT_NE(words0, words1);
+}
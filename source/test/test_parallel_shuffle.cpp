@@ -0,0 +1,80 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <vector>
+
+using namespace crypto;
+
+static std::vector<int> iota_vector(std::size_t size) {
+  std::vector<int> v(size);
+  std::iota(v.begin(), v.end(), 0);
+  return v;
+}
+
+TEST(parallel_shuffle, permutation) {
+  for (auto threads : {1u, 2u, 3u, 8u}) {
+    for (auto size : {0u, 1u, 2u, 7u, 1000u, 300001u}) {
+      crypto::xoshiro256starstar rng;
+      auto v = iota_vector(size);
+      rng.parallel_shuffle(v, threads);
+      auto sorted = v;
+      std::sort(sorted.begin(), sorted.end());
+      ASSERT_EQ(sorted, iota_vector(size)) << threads << " threads, size " << size;
+    }
+  }
+}
+
+TEST(parallel_shuffle, reproducible) {
+  std::seed_seq seed{1, 2, 3};
+  crypto::pcg64 rng0(seed);
+  crypto::pcg64 rng1(seed);
+  auto v0 = iota_vector(1000000u);
+  auto v1 = v0;
+  rng0.parallel_shuffle(v0, 4u);
+  rng1.parallel_shuffle(v1, 4u);
+  ASSERT_EQ(v0, v1);
+  ASSERT_NE(v0, iota_vector(1000000u));
+  ASSERT_EQ(rng0(), rng1());
+}
+
+// Every permutation of four elements must be equally likely, with every
+// element scattered into one of four buckets.
+TEST(parallel_shuffle, uniform_permutations) {
+  crypto::xoroshiro128plus rng;
+  std::map<std::vector<int>, int> counts;
+  constexpr auto trials = 48000;
+  for (auto i = 0; i < trials; ++i) {
+    auto v = iota_vector(4u);
+    rng.parallel_shuffle(v, 4u);
+    ++counts[v];
+  }
+  ASSERT_EQ(counts.size(), 24u);
+  double chi_squared = 0.0;
+  const double expected = trials / 24.0;
+  for (auto &count : counts)
+    chi_squared += (count.second - expected) * (count.second - expected) / expected;
+  // 23 degrees of freedom, p = 0.001.
+  EXPECT_LT(chi_squared, 49.7);
+}
+
+TEST(parallel_shuffle, uniform_positions) {
+  crypto::xoshiro256starstar rng;
+  constexpr auto size = 37u;
+  constexpr auto trials = 37000;
+  std::vector<std::vector<int>> counts(size, std::vector<int>(size, 0));
+  for (auto i = 0; i < trials; ++i) {
+    auto v = iota_vector(size);
+    rng.parallel_shuffle(v, 3u);
+    for (auto j = 0u; j < size; ++j)
+      ++counts[v[j]][j];
+  }
+  const double expected = static_cast<double>(trials) / size;
+  for (auto &row : counts)
+    for (auto count : row)
+      ASSERT_NEAR(count, expected, 6.0 * std::sqrt(expected));
+}
@@ -0,0 +1,54 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+using namespace crypto;
+
+TEST(pcg, reference) {
+  // Output of the PCG reference implementation for pcg64 seeded with
+  // srandom_r(42, 54).
+  pcg64_engine engine({0u, 42u}, {0u, 54u});
+  EXPECT_EQ(engine(), 0x86b1da1d72062b68u);
+  EXPECT_EQ(engine(), 0x1304aa46c9853d39u);
+  EXPECT_EQ(engine(), 0xa3670e9e0dd50358u);
+  EXPECT_EQ(engine(), 0xf9090e529a7dae00u);
+  EXPECT_EQ(engine(), 0xc85b9fd837996f2cu);
+  EXPECT_EQ(engine(), 0x606121f8e3919196u);
+}
+
+TEST(pcg, discard) {
+  pcg64_engine engine0(1234u);
+  pcg64_engine engine1(1234u);
+  for (auto step : {0u, 1u, 2u, 3u, 100u, 12345u}) {
+    for (auto i = 0u; i < step; ++i)
+      engine0();
+    engine1.discard(step);
+    ASSERT_EQ(engine0, engine1);
+    ASSERT_EQ(engine0(), engine1());
+  }
+}
+
+TEST(pcg, jump) {
+  pcg64_engine engine0(1234u);
+  pcg64_engine engine1(1234u);
+  engine0.jump();
+  engine1.advance({0u, std::uint64_t(1u) << 63});
+  engine1.advance({0u, std::uint64_t(1u) << 63});
+  EXPECT_EQ(engine0, engine1);
+  engine0.long_jump();
+  engine1.advance({std::uint64_t(1u) << 31, 0u});
+  engine1.advance({std::uint64_t(1u) << 31, 0u});
+  EXPECT_EQ(engine0, engine1);
+  // Full period.
+  engine1.advance({std::uint64_t(-1), std::uint64_t(-1)});
+  engine1.discard(1u);
+  EXPECT_EQ(engine0, engine1);
+}
+
+TEST(pcg, adaptor) {
+  crypto::pcg64 rng0;
+  auto rng1 = rng0;
+  rng0.jump();
+  rng1.discard(1000u);
+  EXPECT_NE(rng0(), rng1());
+}
@@ -0,0 +1,132 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace crypto;
+
+static std::vector<std::uint64_t> iota_vector(std::size_t size) {
+  std::vector<std::uint64_t> v(size);
+  std::iota(v.begin(), v.end(), 0u);
+  return v;
+}
+
+TEST(permutation, bijective) {
+  crypto::xoshiro256starstar rng(42u);
+  for (auto size : {1u, 2u, 3u, 4u, 5u, 7u, 8u, 9u, 1000u, 1023u, 1024u, 1025u, 300001u}) {
+    const auto permutation = rng.permutation(size);
+    std::vector<std::uint64_t> images;
+    for (auto i = 0u; i < size; ++i) {
+      const auto j = permutation(i);
+      ASSERT_LT(j, size);
+      ASSERT_EQ(permutation.inverse(j), i) << "size " << size;
+      images.push_back(j);
+    }
+    std::sort(images.begin(), images.end());
+    ASSERT_EQ(images, iota_vector(size)) << "size " << size;
+  }
+}
+
+TEST(permutation, huge_domain) {
+  crypto::pcg64 rng(7u);
+  for (auto size : {std::uint64_t(10000000000u), std::uint64_t(1u) << 63, ~std::uint64_t(0u)}) {
+    const auto permutation = rng.permutation(size);
+    for (auto i : {std::uint64_t(0u), std::uint64_t(12345u), size / 2u, size - 1u}) {
+      const auto j = permutation(i);
+      ASSERT_LT(j, size);
+      ASSERT_EQ(permutation.inverse(j), i);
+    }
+  }
+}
+
+TEST(permutation, reproducible) {
+  crypto::chacha8 rng0(3u);
+  crypto::chacha8 rng1(3u);
+  const auto p0 = rng0.permutation(1000u);
+  const auto p1 = rng1.permutation(1000u);
+  EXPECT_EQ(p0, p1);
+  const random_permutation p2(1000u, p0.key());
+  EXPECT_EQ(p2, p0);
+  EXPECT_NE(rng0.permutation(1000u), p0);
+  for (auto i = 0u; i < 1000u; ++i)
+    ASSERT_EQ(p1(i), p0(i));
+
+  xoshiro256starstar_engine engine(5u);
+  const random_permutation p3(1000u, engine);
+  EXPECT_EQ(p3.size(), 1000u);
+}
+
+TEST(permutation, evaluate) {
+  crypto::xoshiro256starstar rng(1u);
+  const auto permutation = rng.permutation(100003u);
+  std::vector<std::uint64_t> output(1000u);
+  permutation.evaluate(50000u, array_view::make_mutable(output));
+  for (auto i = 0u; i < output.size(); ++i)
+    ASSERT_EQ(output[i], permutation(50000u + i));
+
+  const std::vector<std::uint64_t> indices = {5u, 100002u, 0u, 5u, 777u};
+  std::vector<std::uint64_t> images(indices.size());
+  permutation.evaluate(array_view::make_const(indices), array_view::make_mutable(images));
+  for (auto i = 0u; i < indices.size(); ++i)
+    ASSERT_EQ(images[i], permutation(indices[i]));
+
+  std::vector<std::uint64_t> small(2u);
+  EXPECT_THROW(
+      permutation.evaluate(array_view::make_const(indices), array_view::make_mutable(small)),
+      std::invalid_argument);
+
+  // Cycle walking would never find an image for indices past the end.
+  EXPECT_NO_THROW(permutation.evaluate(100003u - 1000u, array_view::make_mutable(output)));
+  EXPECT_THROW(permutation.evaluate(100003u - 999u, array_view::make_mutable(output)), std::out_of_range);
+  EXPECT_THROW(permutation.evaluate(~std::uint64_t(0u), array_view::make_mutable(output)), std::out_of_range);
+  const std::vector<std::uint64_t> past_end = {0u, 100003u};
+  EXPECT_THROW(
+      permutation.evaluate(array_view::make_const(past_end), array_view::make_mutable(small)),
+      std::out_of_range);
+}
+
+TEST(permutation, iteration) {
+  crypto::xoshiro256starstar rng(2u);
+  const auto permutation = rng.permutation(5000u);
+  std::vector<std::uint64_t> values(permutation.begin(), permutation.end());
+  ASSERT_EQ(values.size(), 5000u);
+  for (auto i = 0u; i < values.size(); ++i)
+    ASSERT_EQ(values[i], permutation(i));
+  EXPECT_NE(values, iota_vector(5000u));
+
+  const random_permutation empty;
+  EXPECT_EQ(empty.begin(), empty.end());
+  EXPECT_THROW(*empty.begin(), std::out_of_range);
+  EXPECT_THROW(*permutation.end(), std::out_of_range);
+}
+
+TEST(permutation, out_of_range) {
+  crypto::xoshiro256starstar rng(3u);
+  const auto permutation = rng.permutation(1000u);
+  EXPECT_NO_THROW(permutation(999u));
+  EXPECT_NO_THROW(permutation.inverse(999u));
+  EXPECT_THROW(permutation(1000u), std::out_of_range);
+  EXPECT_THROW(permutation.inverse(1000u), std::out_of_range);
+  EXPECT_THROW(permutation(~std::uint64_t(0u)), std::out_of_range);
+  EXPECT_THROW(rng.permutation(0u), std::invalid_argument);
+  EXPECT_THROW(random_permutation(0u, random_permutation::key_type{}), std::invalid_argument);
+}
+
+TEST(permutation, uniform_positions) {
+  // Position of 0 over many keys, roughly uniform over a small range.
+  constexpr auto size = 10u;
+  constexpr auto trials = 100000u;
+  std::vector<unsigned> counts(size, 0u);
+  crypto::xoshiro256starstar rng(9u);
+  for (auto i = 0u; i < trials; ++i)
+    ++counts[rng.permutation(size)(0u)];
+  const double expected = double(trials) / size;
+  for (auto count : counts)
+    EXPECT_LT(std::abs(count - expected), 6.0 * std::sqrt(expected));
+}
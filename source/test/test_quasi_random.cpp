@@ -0,0 +1,180 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+using namespace crypto;
+
+static double to_fraction(std::uint64_t x) {
+  return static_cast<double>(x) / 18446744073709551616.0;
+}
+
+/// Checks that the first @a count values of every coordinate fall each in a
+/// different interval of width 1 / @a count.
+template <typename ENGINE>
+static void check_stratified(ENGINE engine, std::uint64_t count) {
+  const auto dimensions = engine.dimensions();
+  std::vector<std::set<std::uint64_t>> cells(dimensions);
+  for (auto i = 0u; i < count; ++i) {
+    for (auto j = 0u; j < dimensions; ++j) {
+      cells[j].insert(static_cast<std::uint64_t>(to_fraction(engine()) * static_cast<double>(count)));
+    }
+  }
+  for (auto j = 0u; j < dimensions; ++j) {
+    ASSERT_EQ(cells[j].size(), count) << "dimension " << j;
+  }
+}
+
+template <typename ENGINE>
+static void check_seek(ENGINE engine) {
+  auto stepped = engine;
+  const std::uint64_t position = 12345u * engine.dimensions() + 2u;
+  engine.seek(position);
+  for (auto i = 0u; i < position; ++i)
+    stepped();
+  EXPECT_EQ(engine.position(), position);
+  for (auto i = 0u; i < 10000u; ++i)
+    ASSERT_EQ(engine(), stepped()) << "at " << i;
+}
+
+TEST(quasi_random, sobol_points) {
+  sobol_engine engine(3u);
+  const double expected[][3u] = {
+    {0.0, 0.0, 0.0},
+    {0.5, 0.5, 0.5},
+    {0.75, 0.25, 0.25},
+    {0.25, 0.75, 0.75},
+    {0.375, 0.375, 0.625},
+    {0.875, 0.875, 0.125},
+    {0.625, 0.125, 0.875},
+    {0.125, 0.625, 0.375}};
+  for (const auto &point : expected) {
+    for (auto x : point) {
+      ASSERT_EQ(to_fraction(engine()), x);
+    }
+  }
+  EXPECT_THROW(sobol_engine(0u), std::invalid_argument);
+  EXPECT_THROW(sobol_engine(sobol_engine::max_dimensions + 1u), std::invalid_argument);
+}
+
+TEST(quasi_random, sobol_stratified) {
+  check_stratified(sobol_engine(20u), 1024u);
+  check_stratified(sobol_engine(sobol_engine::max_dimensions), 64u);
+  sobol_engine shifted(8u);
+  xoshiro256starstar_engine rng(1u);
+  shifted.randomize(rng);
+  check_stratified(shifted, 256u);
+}
+
+TEST(quasi_random, sobol_seek) {
+  check_seek(sobol_engine(7u));
+  sobol_engine engine(4u);
+  engine.discard(10u);
+  EXPECT_EQ(engine.position(), 10u);
+  engine.seed();
+  EXPECT_EQ(engine(), 0u);
+}
+
+TEST(quasi_random, halton_points) {
+  halton_engine engine(3u);
+  EXPECT_EQ(engine.base(0u), 2u);
+  EXPECT_EQ(engine.base(1u), 3u);
+  EXPECT_EQ(engine.base(2u), 5u);
+  for (auto n = 0u; n < 10000u; ++n) {
+    for (auto j = 0u; j < 3u; ++j) {
+      const auto base = engine.base(j);
+      double expected = 0.0;
+      double weight = 1.0 / base;
+      for (auto k = n; k > 0u; k /= base, weight /= base) {
+        expected += (k % base) * weight;
+      }
+      ASSERT_NEAR(to_fraction(engine()), expected, 1e-15) << "point " << n;
+    }
+  }
+  EXPECT_THROW(halton_engine(0u), std::invalid_argument);
+}
+
+TEST(quasi_random, halton_scrambled) {
+  halton_engine engine(3u);
+  pcg64_engine rng(5u);
+  engine.randomize(rng);
+  check_seek(engine);
+  // Scrambling permutes the digits, the points of a full period of a base
+  // still fall in different intervals.
+  halton_engine scrambled(2u);
+  scrambled.randomize(rng);
+  std::vector<unsigned> halves(64u, 0u);
+  std::vector<unsigned> thirds(81u, 0u);
+  for (auto i = 0u; i < 64u * 81u; ++i) {
+    ++halves[static_cast<std::size_t>(to_fraction(scrambled()) * 64.0)];
+    ++thirds[static_cast<std::size_t>(to_fraction(scrambled()) * 81.0)];
+  }
+  EXPECT_EQ(std::set<unsigned>(halves.begin(), halves.end()), std::set<unsigned>{81u});
+  EXPECT_EQ(std::set<unsigned>(thirds.begin(), thirds.end()), std::set<unsigned>{64u});
+  halton_engine first(10u);
+  first.randomize(rng);
+  halton_engine other(10u);
+  other.randomize(rng);
+  std::vector<std::uint64_t> values;
+  std::vector<std::uint64_t> other_values;
+  for (auto i = 0u; i < 300u; ++i) {
+    values.push_back(first());
+    other_values.push_back(other());
+  }
+  EXPECT_NE(values, other_values);
+}
+
+TEST(quasi_random, halton_seek) {
+  check_seek(halton_engine(10u));
+}
+
+TEST(quasi_random, normal_quantile) {
+  for (auto p : {1e-300, 1e-20, 1e-8, 0.001, 0.02425, 0.1, 0.3, 0.5, 0.7, 0.9, 0.975, 0.999}) {
+    const auto x = normal_quantile(p);
+    const auto cdf = 0.5 * std::erfc(-x / std::sqrt(2.0));
+    EXPECT_NEAR(cdf / p, 1.0, 1e-13) << "p = " << p;
+  }
+  EXPECT_EQ(normal_quantile(0.5), 0.0);
+  EXPECT_NEAR(normal_quantile(0.975), 1.959963984540054, 1e-15);
+  EXPECT_TRUE(std::isinf(normal_quantile(0.0)));
+  EXPECT_TRUE(std::isinf(normal_quantile(1.0)));
+  EXPECT_NEAR(exponential_quantile(1.0 - std::exp(-2.0)), 2.0, 1e-14);
+}
+
+TEST(quasi_random, adaptor) {
+  // Integral of x * y on the unit square, 1/4.
+  crypto::sobol qrng(2u);
+  double sum = 0.0;
+  constexpr auto count = 1u << 14;
+  for (auto i = 0u; i < count; ++i) {
+    const auto x = qrng.fast_uniform<double>();
+    sum += x * qrng.fast_uniform<double>();
+  }
+  EXPECT_NEAR(sum / count, 0.25, 1e-4);
+
+  const xoshiro256starstar_engine shift(3u);
+  auto rng = shift;
+  crypto::sobol normals(1u);
+  normals.engine().randomize(rng);
+  std::vector<double> values(count);
+  normals.inverse_cdf_n(array_view::make_mutable(values), normal_quantile);
+  double mean = 0.0;
+  double square = 0.0;
+  for (auto x : values) {
+    mean += x;
+    square += x * x;
+  }
+  EXPECT_NEAR(mean / count, 0.0, 1e-3);
+  EXPECT_NEAR(square / count, 1.0, 1e-3);
+
+  crypto::sobol one_by_one(1u);
+  rng = shift;
+  one_by_one.engine().randomize(rng);
+  for (auto i = 0u; i < 100u; ++i)
+    ASSERT_EQ(one_by_one.inverse_cdf(normal_quantile), values[i]);
+}
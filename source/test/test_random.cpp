@@ -33,6 +33,8 @@ static bool test_engine() {
     if (rng0.template uniform<float>() != rng1.template uniform<float>()) return false;
     if (rng0.template uniform<int>() != rng1.template uniform<int>()) return false;
     if (rng0.template uniform<size_t>() != rng1.template uniform<size_t>()) return false;
+    if (rng0.template fast_uniform<float>() != rng1.template fast_uniform<float>()) return false;
+    if (rng0.template fast_uniform<int>(-3, 3) != rng1.template fast_uniform<int>(-3, 3)) return false;
     if (rng0.template uniform_bool() != rng1.template uniform_bool()) return false;
     if (rng0.template uniform_bool(0.3) != rng1.template uniform_bool(0.3)) return false;
     if (rng0.template bernoulli() != rng1.template bernoulli()) return false;
@@ -65,6 +67,10 @@ static bool test_engine() {
     return false;
   if (rng0.choice(v0) != rng1.choice(v1))
     return false;
+  rng0.uniform_n(array_view::make_mutable(v0), -1.0, 1.0);
+  rng1.uniform_n(array_view::make_mutable(v1), -1.0, 1.0);
+  if (v0 != v1)
+    return false;
 
   for (auto i = 0u; i < 10000u; ++i) {
     if (rng0.template discrete(v0.begin(), v0.end()) !=
@@ -83,6 +89,12 @@ static bool test_engine() {
 
 TEST(random, default_random_engine)     { ASSERT_TRUE(test_engine<crypto::default_random_engine>()); }
 TEST(random, mt19937)                   { ASSERT_TRUE(test_engine<crypto::mt19937>()); }
+TEST(random, xoshiro256starstar)        { ASSERT_TRUE(test_engine<crypto::xoshiro256starstar>()); }
+TEST(random, xoroshiro128plus)          { ASSERT_TRUE(test_engine<crypto::xoroshiro128plus>()); }
+TEST(random, pcg64)                     { ASSERT_TRUE(test_engine<crypto::pcg64>()); }
+TEST(random, chacha8)                   { ASSERT_TRUE(test_engine<crypto::chacha8>()); }
+TEST(random, chacha12)                  { ASSERT_TRUE(test_engine<crypto::chacha12>()); }
+TEST(random, chacha20)                  { ASSERT_TRUE(test_engine<crypto::chacha20>()); }
 TEST(random, std_default_random_engine) { ASSERT_TRUE(test_engine<std::default_random_engine>()); }
 TEST(random, std_minstd_rand0)          { ASSERT_TRUE(test_engine<std::minstd_rand0>()); }
 TEST(random, std_minstd_rand)           { ASSERT_TRUE(test_engine<std::minstd_rand>()); }
@@ -93,3 +105,92 @@ TEST(random, std_ranlux48_base)         { ASSERT_TRUE(test_engine<std::ranlux48_
 TEST(random, std_ranlux24)              { ASSERT_TRUE(test_engine<std::ranlux24>()); }
 TEST(random, std_ranlux48)              { ASSERT_TRUE(test_engine<std::ranlux48>()); }
 TEST(random, std_knuth_b)               { ASSERT_TRUE(test_engine<std::knuth_b>()); }
+
+template <typename T, typename RNG>
+static void check_uniform_n(T min, T max) {
+  std::seed_seq seed{1,2,3,4,5,6,7,8,9};
+  // Odd size to exercise the partial blocks and SIMD tails.
+  constexpr auto size = 1000u;
+  RNG rng0(seed);
+  RNG rng1(seed);
+  std::vector<T> values(size);
+  rng0.uniform_n(crypto::array_view::make_mutable(values), min, max);
+  for (auto value : values) {
+    ASSERT_EQ(value, rng1.fast_uniform(min, max));
+    ASSERT_LE(min, value);
+    ASSERT_LE(value, max);
+  }
+  // Both engines must be left in the same state.
+  ASSERT_EQ(rng0(), rng1());
+}
+
+template <typename RNG>
+static void check_uniform_n() {
+  check_uniform_n<int, RNG>(1, 6);
+  check_uniform_n<int, RNG>(-100, 100);
+  check_uniform_n<std::int64_t, RNG>(
+      std::numeric_limits<std::int64_t>::min(),
+      std::numeric_limits<std::int64_t>::max());
+  check_uniform_n<std::uint64_t, RNG>(0u, 0xffffffffu);
+  // Half of the draws are rejected.
+  check_uniform_n<std::uint64_t, RNG>(0u, std::uint64_t(1u) << 63);
+  check_uniform_n<std::uint8_t, RNG>(0u, 255u);
+  check_uniform_n<float, RNG>(-1.0f, 1.0f);
+  check_uniform_n<double, RNG>(10.0, 20.0);
+}
+
+TEST(random, uniform_n) {
+  check_uniform_n<crypto::mt19937>();
+  check_uniform_n<crypto::xoshiro256starstar>();
+  check_uniform_n<crypto::chacha8>();
+  check_uniform_n<crypto::random_engine_adaptor<crypto::chacha20_engine>>();
+  check_uniform_n<crypto::random_engine_adaptor<std::ranlux24>>();
+}
+
+TEST(random, fast_uniform_distribution) {
+  crypto::xoshiro256starstar rng;
+  std::vector<int> counts(6u, 0);
+  constexpr auto draws = 600000;
+  for (auto i = 0; i < draws; ++i)
+    ++counts[rng.fast_uniform(0, 5)];
+  for (auto count : counts) {
+    EXPECT_GT(count, draws / 6 - 2000);
+    EXPECT_LT(count, draws / 6 + 2000);
+  }
+  for (auto i = 0; i < 1000; ++i) {
+    auto value = rng.fast_uniform<double>();
+    ASSERT_LE(0.0, value);
+    ASSERT_LT(value, 1.0);
+  }
+}
+
+TEST(random, prepared_distributions) {
+  std::seed_seq seed{1,2,3,4,5,6,7,8,9};
+  crypto::mt19937 rng0(seed);
+  crypto::mt19937 rng1(seed);
+  auto normal = rng0.make_normal(1.0, 2.0);
+  auto gamma = rng0.make_gamma(3.0, 0.5);
+  auto binomial = rng0.make_binomial(20, 0.3);
+  auto poisson = rng0.make_poisson(4.0);
+  auto uniform = rng0.make_uniform<int>(-5, 5);
+  crypto::normal_sampler<double> expected_normal(1.0, 2.0);
+  crypto::gamma_sampler<double> expected_gamma(3.0, 0.5);
+  std::binomial_distribution<int> expected_binomial(20, 0.3);
+  std::poisson_distribution<int> expected_poisson(4.0);
+  std::uniform_int_distribution<int> expected_uniform(-5, 5);
+  for (auto i = 0u; i < 1000u; ++i) {
+    ASSERT_EQ(normal(), expected_normal(rng1));
+    ASSERT_EQ(gamma(), expected_gamma(rng1));
+    ASSERT_EQ(binomial(), expected_binomial(rng1));
+    ASSERT_EQ(poisson(), expected_poisson(rng1));
+    ASSERT_EQ(uniform(), expected_uniform(rng1));
+  }
+  std::vector<double> values(100u);
+  normal.generate(values);
+  for (auto value : values)
+    ASSERT_EQ(value, expected_normal(rng1));
+  const std::vector<double> weights = {1.0, 2.0, 3.0};
+  auto discrete = rng0.make_discrete(weights.begin(), weights.end());
+  EXPECT_EQ(discrete.min(), 0);
+  EXPECT_EQ(discrete.max(), 2);
+}
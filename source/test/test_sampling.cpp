@@ -0,0 +1,232 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <forward_list>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
+using namespace crypto;
+
+template <typename T>
+static void expect_uniform(const std::vector<T> &counts, double expected) {
+  for (auto count : counts) {
+    EXPECT_NEAR(static_cast<double>(count), expected, 6.0 * std::sqrt(expected));
+  }
+}
+
+TEST(sampling, sample_indices) {
+  crypto::xoshiro256starstar rng;
+  for (auto k : {0u, 1u, 5u, 100u}) {
+    auto indices = rng.sample_indices(100u, k);
+    ASSERT_EQ(indices.size(), k);
+    ASSERT_TRUE(std::is_sorted(indices.begin(), indices.end()));
+    ASSERT_TRUE(std::adjacent_find(indices.begin(), indices.end()) == indices.end());
+    for (auto index : indices)
+      ASSERT_LT(index, 100u);
+  }
+  ASSERT_EQ(rng.sample_indices(3u, 10u), (std::vector<std::uint64_t>{0u, 1u, 2u}));
+  auto large = rng.sample_indices(std::uint64_t(1u) << 62, 1000u);
+  ASSERT_EQ(large.size(), 1000u);
+  ASSERT_TRUE(std::adjacent_find(large.begin(), large.end()) == large.end());
+
+  constexpr auto trials = 20000u;
+  std::vector<unsigned> counts(10u, 0u);
+  for (auto i = 0u; i < trials; ++i)
+    for (auto index : rng.sample_indices(10u, 3u))
+      ++counts[index];
+  expect_uniform(counts, trials * 0.3);
+}
+
+template <typename CONTAINER>
+static void check_sample(std::size_t n, std::size_t k) {
+  crypto::pcg64 rng;
+  constexpr auto trials = 10000u;
+  std::vector<unsigned> counts(n, 0u);
+  for (auto i = 0u; i < trials; ++i) {
+    std::vector<int> values(n);
+    std::iota(values.begin(), values.end(), 0);
+    CONTAINER container(values.begin(), values.end());
+    auto end = rng.sample(k, container);
+    ASSERT_EQ(static_cast<std::size_t>(std::distance(container.begin(), end)), std::min(n, k));
+    ASSERT_TRUE(std::is_sorted(container.begin(), end));
+    std::vector<int> all(container.begin(), container.end());
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all, values);
+    for (auto it = container.begin(); it != end; ++it)
+      ++counts[static_cast<std::size_t>(*it)];
+  }
+  expect_uniform(counts, static_cast<double>(trials) * std::min(n, k) / n);
+}
+
+TEST(sampling, sample) {
+  // Floyd's algorithm.
+  check_sample<std::vector<int>>(100u, 4u);
+  // Selection sampling.
+  check_sample<std::vector<int>>(20u, 7u);
+  check_sample<std::forward_list<int>>(20u, 3u);
+  check_sample<std::list<int>>(5u, 9u);
+}
+
+TEST(sampling, reservoir_sample) {
+  crypto::chacha8 rng;
+  constexpr auto trials = 10000u;
+  std::vector<unsigned> counts(30u, 0u);
+  for (auto i = 0u; i < trials; ++i) {
+    std::vector<int> values(30u);
+    std::iota(values.begin(), values.end(), 0);
+    auto sample = rng.reservoir_sample(values, 5u);
+    ASSERT_EQ(sample.size(), 5u);
+    std::sort(sample.begin(), sample.end());
+    ASSERT_TRUE(std::adjacent_find(sample.begin(), sample.end()) == sample.end());
+    for (auto value : sample)
+      ++counts[static_cast<std::size_t>(value)];
+  }
+  expect_uniform(counts, trials * 5.0 / 30.0);
+
+  std::vector<int> few{1, 2, 3};
+  ASSERT_EQ(rng.reservoir_sample(few, 10u), few);
+  ASSERT_TRUE(rng.reservoir_sample(few, 0u).empty());
+
+  // Input iterators.
+  std::istringstream stream("1 2 3 4 5 6 7 8 9");
+  auto sample = rng.reservoir_sample(
+      std::istream_iterator<int>(stream),
+      std::istream_iterator<int>(),
+      4u);
+  ASSERT_EQ(sample.size(), 4u);
+}
+
+TEST(sampling, reservoir_long_stream) {
+  crypto::xoroshiro128plus rng;
+  crypto::reservoir_sampler<std::uint64_t> reservoir(2000u);
+  constexpr std::uint64_t n = 20000000u;
+  for (auto i = 0u; i < n; ++i)
+    reservoir.push(rng, i);
+  ASSERT_EQ(reservoir.count(), n);
+  ASSERT_EQ(reservoir.values().size(), 2000u);
+  // The mean of a uniform sample of [0, n).
+  double mean = 0.0;
+  for (auto value : reservoir.values())
+    mean += static_cast<double>(value) / 2000.0;
+  const double sigma = n / std::sqrt(12.0 * 2000.0);
+  EXPECT_NEAR(mean, n / 2.0, 5.0 * sigma);
+  // Elements of every tenth of the stream.
+  std::vector<unsigned> counts(10u, 0u);
+  for (auto value : reservoir.values())
+    ++counts[static_cast<std::size_t>(value / (n / 10u))];
+  expect_uniform(counts, 200.0);
+}
+
+TEST(sampling, choice) {
+  crypto::xoshiro256starstar rng;
+  std::forward_list<int> empty;
+  ASSERT_TRUE(rng.choice(empty.begin(), empty.end()) == empty.end());
+  std::forward_list<int> list{0, 1, 2, 3, 4, 5, 6};
+  std::vector<int> vector(list.begin(), list.end());
+  constexpr auto trials = 14000u;
+  std::vector<unsigned> list_counts(7u, 0u);
+  std::vector<unsigned> vector_counts(7u, 0u);
+  for (auto i = 0u; i < trials; ++i) {
+    ++list_counts[static_cast<std::size_t>(rng.choice(list))];
+    ++vector_counts[static_cast<std::size_t>(rng.choice(vector))];
+  }
+  expect_uniform(list_counts, trials / 7.0);
+  expect_uniform(vector_counts, trials / 7.0);
+}
+
+// Probability of every element of being in a weighted sample of two
+// elements without replacement.
+static std::vector<double> inclusion_probabilities(const std::vector<double> &weights) {
+  const auto total = std::accumulate(weights.begin(), weights.end(), 0.0);
+  std::vector<double> result(weights.size(), 0.0);
+  for (auto a = 0u; a < weights.size(); ++a) {
+    for (auto b = 0u; b < weights.size(); ++b) {
+      if (a != b) {
+        const auto p = weights[a] / total * weights[b] / (total - weights[a]);
+        result[a] += p;
+        result[b] += p;
+      }
+    }
+  }
+  return result;
+}
+
+static void expect_probabilities(
+    const std::vector<unsigned> &counts,
+    const std::vector<double> &probabilities,
+    unsigned trials) {
+  for (auto i = 0u; i < counts.size(); ++i) {
+    const auto expected = probabilities[i] * trials;
+    EXPECT_NEAR(counts[i], expected, 6.0 * std::sqrt(expected) + 1.0) << "element " << i;
+  }
+}
+
+TEST(sampling, weighted_reservoir) {
+  crypto::xoshiro256starstar rng;
+  const std::vector<double> weights{1.0, 2.0, 0.0, 3.0, 0.5, 4.0};
+  std::vector<int> values(weights.size());
+  std::iota(values.begin(), values.end(), 0);
+  constexpr auto trials = 40000u;
+  std::vector<unsigned> counts(weights.size(), 0u);
+  for (auto i = 0u; i < trials; ++i) {
+    auto sample = rng.weighted_reservoir_sample(values.begin(), values.end(), weights.begin(), 2u);
+    ASSERT_EQ(sample.size(), 2u);
+    ASSERT_NE(sample[0u], sample[1u]);
+    for (auto value : sample)
+      ++counts[static_cast<std::size_t>(value)];
+  }
+  ASSERT_EQ(counts[2u], 0u);
+  expect_probabilities(counts, inclusion_probabilities(weights), trials);
+
+  EXPECT_THROW(
+      rng.weighted_reservoir_sample(values.begin(), values.begin() + 1, std::vector<double>{-1.0}.begin(), 2u),
+      std::invalid_argument);
+}
+
+// With a single element the sample is a weighted choice, and almost every
+// element of a long stream is skipped.
+TEST(sampling, weighted_reservoir_skip) {
+  crypto::pcg64 rng;
+  constexpr auto trials = 20000u;
+  std::vector<unsigned> counts(10u, 0u);
+  for (auto i = 0u; i < trials; ++i) {
+    crypto::weighted_reservoir_sampler<int> reservoir(1u);
+    for (auto j = 0; j < 1000; ++j)
+      reservoir.push(rng, j % 10, static_cast<double>(j % 10 + 1));
+    ++counts[static_cast<std::size_t>(reservoir.values().front())];
+  }
+  std::vector<double> probabilities(10u);
+  for (auto i = 0u; i < 10u; ++i)
+    probabilities[i] = (i + 1.0) / 55.0;
+  expect_probabilities(counts, probabilities, trials);
+}
+
+TEST(sampling, weighted_reservoir_merge) {
+  std::vector<double> weights(12u);
+  for (auto i = 0u; i < weights.size(); ++i)
+    weights[i] = 1.0 + (i % 4u);
+  constexpr auto trials = 20000u;
+  std::vector<unsigned> counts(weights.size(), 0u);
+  crypto::pcg64 seeder;
+  for (auto i = 0u; i < trials; ++i) {
+    crypto::weighted_reservoir_sampler<std::size_t> total(2u);
+    for (auto part = 0u; part < 3u; ++part) {
+      crypto::xoshiro256starstar rng(seeder());
+      crypto::weighted_reservoir_sampler<std::size_t> reservoir(2u);
+      for (auto j = part * 4u; j < part * 4u + 4u; ++j)
+        reservoir.push(rng, j, weights[j]);
+      total.merge(std::move(reservoir));
+    }
+    ASSERT_EQ(total.count(), weights.size());
+    ASSERT_EQ(total.size(), 2u);
+    for (auto value : total.values())
+      ++counts[value];
+  }
+  expect_probabilities(counts, inclusion_probabilities(weights), trials);
+}
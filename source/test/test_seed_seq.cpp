@@ -0,0 +1,95 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+using namespace crypto;
+
+template <typename SeedSeq>
+static std::array<std::uint32_t, 8u> generate(const SeedSeq &seq) {
+  std::array<std::uint32_t, 8u> words;
+  seq.generate(words.begin(), words.end());
+  return words;
+}
+
+// Splitting the mixing in two must not change the values.
+TEST(seed_seq, known_values) {
+  randutils::seed_seq_fe256 seq{1u, 2u, 3u};
+  EXPECT_EQ(generate(seq), (std::array<std::uint32_t, 8u>{{
+    0x4618eb71u, 0xef5ef2e2u, 0x3341b2eeu, 0xcc6bf3fdu,
+    0x385e1830u, 0x04210811u, 0x2cfaa1d6u, 0x1c8c080cu}}));
+  randutils::seed_seq_fe<2u, std::uint64_t> seq64{0x0123456789abcdefull, 42ull, 7ull};
+  std::array<std::uint64_t, 4u> words;
+  seq64.generate(words.begin(), words.end());
+  EXPECT_EQ(words, (std::array<std::uint64_t, 4u>{{
+    0x8e772c0b9d63ae25u, 0xd78bfd94296a9f51u, 0x8ab43ac2a377b764u, 0x6a55b42e25dc286bu}}));
+}
+
+TEST(seed_seq, spawn) {
+  randutils::seed_seq_fe128 parent0{7u, 8u};
+  randutils::seed_seq_fe128 parent1{7u, 8u};
+  const auto before = generate(parent0);
+  auto children0 = parent0.spawn(5u);
+  auto first = parent1.spawn(3u);
+  auto second = parent1.spawn(2u);
+  ASSERT_EQ(children0.size(), 5u);
+  ASSERT_EQ(parent0.spawned(), 5u);
+  ASSERT_EQ(parent1.spawned(), 5u);
+  // Spawning does not change the parent.
+  ASSERT_EQ(generate(parent0), before);
+  for (auto i = 0u; i < 3u; ++i)
+    ASSERT_EQ(generate(children0[i]), generate(first[i]));
+  for (auto i = 0u; i < 2u; ++i)
+    ASSERT_EQ(generate(children0[3u + i]), generate(second[i]));
+  for (auto i = 0u; i < children0.size(); ++i) {
+    ASSERT_NE(generate(children0[i]), before);
+    for (auto j = 0u; j < i; ++j)
+      ASSERT_NE(generate(children0[i]), generate(children0[j]));
+  }
+  // Grandchildren.
+  auto grandchildren = children0[0u].spawn(2u);
+  ASSERT_NE(generate(grandchildren[0u]), generate(children0[1u]));
+  ASSERT_NE(generate(grandchildren[0u]), generate(grandchildren[1u]));
+  // Other parents.
+  randutils::seed_seq_fe128 other{7u, 9u};
+  ASSERT_NE(generate(other.spawn(1u)[0u]), generate(children0[0u]));
+}
+
+TEST(seed_seq, seed_engines) {
+  randutils::seed_seq_fe256 parent0{1u, 2u, 3u, 4u};
+  randutils::seed_seq_fe256 parent1{1u, 2u, 3u, 4u};
+  std::vector<crypto::xoshiro256starstar_engine> engines(100u);
+  parent0.seed_engines(engines.begin(), engines.end());
+  ASSERT_EQ(parent0.spawned(), engines.size());
+  auto children = parent1.spawn(engines.size());
+  for (auto i = 0u; i < engines.size(); ++i)
+    ASSERT_TRUE(engines[i] == crypto::xoshiro256starstar_engine(children[i]));
+
+  std::vector<crypto::pcg64> adaptors(3u);
+  parent0.seed_engines(adaptors.begin(), adaptors.end());
+  ASSERT_NE(adaptors[0u](), adaptors[1u]());
+}
+
+// The first outputs of engines seeded by many children are distinct and
+// their bits balanced.
+TEST(seed_seq, independent_children) {
+  randutils::seed_seq_fe128 parent{42u};
+  std::vector<crypto::pcg64_engine> engines(100000u);
+  parent.seed_engines(engines.begin(), engines.end());
+  std::unordered_set<std::uint64_t> seen;
+  std::array<unsigned, 64u> ones{};
+  for (auto &engine : engines) {
+    const auto value = engine();
+    ASSERT_TRUE(seen.insert(value).second);
+    for (auto bit = 0u; bit < 64u; ++bit)
+      ones[bit] += (value >> bit) & 1u;
+  }
+  for (auto count : ones)
+    EXPECT_NEAR(count, 50000.0, 6.0 * std::sqrt(25000.0));
+}
@@ -0,0 +1,98 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace crypto;
+
+// Known answers of the reference implementations, SFMT.19937.out.txt and
+// dSFMT.19937.out.txt.
+TEST(sfmt, sfmt19937_known_answers) {
+  sfmt19937_engine engine(1234u);
+  const std::uint32_t expected[] = {
+    3440181298u, 1564997079u, 1510669302u, 2930277156u, 1452439940u,
+    3796268453u, 423124208u, 2143818589u, 3827219408u, 2987036003u};
+  for (auto value : expected)
+    ASSERT_EQ(engine(), value);
+}
+
+TEST(sfmt, dsfmt19937_known_answers) {
+  dsfmt19937_engine engine(0u);
+  const double expected[] = {
+    1.030581026769374, 1.213140320067012, 1.299002525016001, 1.381138853044628};
+  for (auto value : expected)
+    ASSERT_NEAR(engine.unit_double() + 1.0, value, 1e-15);
+}
+
+template <typename ENGINE>
+static void check_engine() {
+  ENGINE engine(7u);
+  std::vector<typename ENGINE::result_type> values(5000u);
+  for (auto &value : values)
+    value = engine();
+  // Bulk generation, starting in the middle of a block.
+  engine.seed(7u);
+  std::vector<typename ENGINE::result_type> bulk(values.size());
+  bulk[0u] = engine();
+  engine.generate(bulk.data() + 1u, bulk.data() + 3u);
+  engine.generate(bulk.data() + 3u, bulk.data() + bulk.size());
+  EXPECT_EQ(bulk, values);
+  // Discard.
+  for (auto n : {0u, 1u, 381u, 382u, 623u, 624u, 1000u, 4000u}) {
+    engine.seed(7u);
+    engine.discard(n);
+    ASSERT_EQ(engine(), values[n]) << "discard " << n;
+  }
+  // Seed sequences.
+  std::seed_seq seq{1, 2, 3};
+  ENGINE a(seq);
+  ENGINE b;
+  b.seed(seq);
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, engine);
+}
+
+TEST(sfmt, sfmt19937_engine) {
+  check_engine<sfmt19937_engine>();
+}
+
+TEST(sfmt, dsfmt19937_engine) {
+  check_engine<dsfmt19937_engine>();
+}
+
+TEST(sfmt, dsfmt19937_doubles) {
+  dsfmt19937_engine engine(3u);
+  auto copy = engine;
+  std::vector<double> values(1000u);
+  engine.generate_doubles(values.data(), values.data() + values.size());
+  double sum = 0.0;
+  for (auto value : values) {
+    ASSERT_EQ(copy.unit_double(), value);
+    ASSERT_GE(value, 0.0);
+    ASSERT_LT(value, 1.0);
+    sum += value;
+  }
+  EXPECT_NEAR(sum / values.size(), 0.5, 0.05);
+  EXPECT_EQ(engine, copy);
+}
+
+TEST(sfmt, adaptor) {
+  std::seed_seq seq{4, 5, 6};
+  sfmt19937 rng1(seq);
+  sfmt19937 rng2(seq);
+  std::vector<int> values(1000u);
+  rng1.uniform_n(array_view::make_mutable(values), 1, 6);
+  for (auto value : values)
+    ASSERT_EQ(value, rng2.uniform<int>(1, 6));
+
+  dsfmt19937 rng3(seq);
+  std::vector<double> doubles(1000u);
+  rng3.uniform_n(array_view::make_mutable(doubles), 0.0, 1.0);
+  for (auto value : doubles) {
+    ASSERT_GE(value, 0.0);
+    ASSERT_LT(value, 1.0);
+  }
+}
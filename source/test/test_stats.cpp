@@ -0,0 +1,125 @@
+#include "crypto/password_digest.h"
+#include "crypto/stats.h"
+#include "crypto/token_generator.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace crypto;
+
+#ifdef CRYPTO_ENABLE_STATS
+
+/// Counters of the calling thread accumulated while running @a code.
+template <typename F>
+static stats::report measure(F &&code) {
+  const auto before = stats::thread_snapshot();
+  code();
+  return stats::thread_snapshot() - before;
+}
+
+TEST(stats, digest) {
+  const std::vector<byte> data(1000u, 42u);
+  sha256_digest digest;
+  const auto report = measure([&]() {
+    for (auto i = 0u; i < 10u; ++i) {
+      ::crypto::digest(buffer_view::make_const(data), digest);
+    }
+  });
+  const auto &counters = report[stats::operation::digest];
+  EXPECT_EQ(10u, counters.calls);
+  EXPECT_EQ(10000u, counters.bytes);
+  EXPECT_EQ(10u, counters.evp_contexts);
+  EXPECT_EQ(10u, counters.latency.count());
+  EXPECT_GT(counters.latency.quantile(0.5), 0u);
+  EXPECT_LE(counters.latency.quantile(0.5), counters.latency.quantile(1.0));
+  EXPECT_EQ(0u, report.allocations());
+}
+
+TEST(stats, secure_string_allocations) {
+  auto a = secure_string::unsafe_make("some secret");
+  auto b = secure_string::unsafe_make("another secret");
+  const auto size = a.size() + b.size();
+  EXPECT_EQ(0u, measure([&]() { auto moved = std::move(a); a = std::move(moved); }).allocations());
+  EXPECT_EQ(1u, measure([&]() { auto copy = a; }).allocations());
+  const auto concat = measure([&]() { auto c = secure_string(a) + std::move(b); });
+  EXPECT_EQ(2u, concat[stats::operation::secure_string].allocations);
+  EXPECT_EQ(a.size() + 1u + size + 1u, concat[stats::operation::secure_string].allocated_bytes);
+}
+
+TEST(stats, zeroize) {
+  std::string string = "a super secret password";
+  const auto size = string.size();
+  const auto report = measure([&]() {
+    auto password = secure_string::clean_buffer_and_make(buffer_view::make_mutable(&string[0], size));
+  });
+  // The clear text, then the secure_string on destruction.
+  EXPECT_EQ(2u, report[stats::operation::zeroize].calls);
+  EXPECT_EQ(2u * size, report[stats::operation::zeroize].bytes);
+  EXPECT_EQ(1u, report.allocations());
+}
+
+TEST(stats, password_verification_is_allocation_free) {
+  const auto password = secure_string::unsafe_make("a super secret password");
+  const auto wrong = secure_string::unsafe_make("a wrong password");
+  const password_digest<sha512_digest> digest{password};
+  const auto report = measure([&]() {
+    EXPECT_TRUE(digest == password);
+    EXPECT_TRUE(digest != wrong);
+    const auto copy = digest;
+    EXPECT_TRUE(copy == digest);
+  });
+  EXPECT_EQ(0u, report.allocations());
+  EXPECT_EQ(2u, report[stats::operation::password_digest].calls);
+  EXPECT_EQ(2u, report[stats::operation::digest].calls);
+  EXPECT_EQ(1u, measure([&]() { password_digest<> other{password}; }).allocations());
+}
+
+TEST(stats, token_generator_allocations) {
+  const auto generator = token_generator::base64url();
+  auto token = secure_string::make_zeroed(32u);
+  EXPECT_EQ(0u, measure([&]() { generator.fill(token); }).allocations());
+  EXPECT_EQ(1u, measure([&]() { generator(32u); }).allocations());
+  EXPECT_EQ(11u, measure([&]() { generator(10u, 32u); }).allocations());
+}
+
+TEST(stats, threads) {
+  const auto before = stats::snapshot();
+  std::vector<std::thread> threads;
+  for (auto i = 0u; i < 4u; ++i) {
+    threads.emplace_back([]() {
+      sha256_digest digest;
+      ::crypto::digest(buffer_view::make_const("thread"), digest);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  const auto report = stats::snapshot() - before;
+  EXPECT_EQ(4u, report[stats::operation::digest].calls);
+  EXPECT_EQ(4u, report[stats::operation::digest].evp_contexts);
+}
+
+#else
+
+TEST(stats, disabled) {
+  sha256_digest digest;
+  ::crypto::digest(buffer_view::make_const("nothing recorded"), digest);
+  auto password = secure_string::unsafe_make("nothing recorded");
+  const auto report = stats::snapshot();
+  for (const auto &counters : report.operations) {
+    EXPECT_EQ(0u, counters.calls);
+    EXPECT_EQ(0u, counters.allocations);
+    EXPECT_EQ(0u, counters.latency.count());
+  }
+  EXPECT_FALSE(stats::enabled);
+}
+
+#endif // CRYPTO_ENABLE_STATS
+
+TEST(stats, names) {
+  EXPECT_STREQ("digest", stats::name(stats::operation::digest));
+  EXPECT_STREQ("password_digest", stats::name(stats::operation::password_digest));
+}
@@ -0,0 +1,63 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace crypto;
+
+TEST(thread_rng, same_engine) {
+  auto &rng0 = thread_rng();
+  auto &rng1 = thread_rng();
+  EXPECT_EQ(&rng0, &rng1);
+  auto value = rng0.uniform<double>();
+  EXPECT_GE(value, 0.0);
+  EXPECT_LE(value, 1.0);
+}
+
+TEST(thread_rng, threads) {
+  constexpr auto count = 8u;
+  std::vector<std::uint32_t> values(count);
+  std::vector<const void *> addresses(count);
+  std::vector<std::thread> threads;
+  for (auto i = 0u; i < count; ++i) {
+    threads.emplace_back([&, i]() {
+      addresses[i] = &thread_rng();
+      values[i] = thread_rng()();
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  for (auto i = 0u; i < count; ++i) {
+    EXPECT_NE(addresses[i], &thread_rng());
+    for (auto j = i + 1u; j < count; ++j) {
+      EXPECT_NE(values[i], values[j]);
+    }
+  }
+}
+
+TEST(thread_rng, fork) {
+  thread_rng()();
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  const auto pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    std::uint32_t value = thread_rng()();
+    auto result = write(fds[1], &value, sizeof(value));
+    _exit(result == sizeof(value) ? 0 : 1);
+  }
+  const auto parent_value = thread_rng()();
+  std::uint32_t child_value = 0u;
+  ASSERT_EQ(read(fds[0], &child_value, sizeof(child_value)), ssize_t(sizeof(child_value)));
+  int status = 0;
+  waitpid(pid, &status, 0);
+  close(fds[0]);
+  close(fds[1]);
+  EXPECT_NE(parent_value, child_value);
+}
@@ -0,0 +1,122 @@
+#include "crypto/token_generator.h"
+
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace crypto;
+
+static void check_alphabet(const token_generator &generator, std::size_t length) {
+  const auto token = generator(length);
+  ASSERT_EQ(token.size(), length);
+  ASSERT_EQ(token.c_str()[length], '\0');
+  for (auto i = 0u; i < token.size(); ++i)
+    ASSERT_NE(generator.alphabet().find(token.data()[i]), std::string::npos) << "at " << i;
+}
+
+TEST(token_generator, alphabets) {
+  for (auto length : {0u, 1u, 31u, 32u, 33u, 1000u}) {
+    check_alphabet(token_generator::hex(), length);
+    check_alphabet(token_generator::base32(), length);
+    check_alphabet(token_generator::base64url(), length);
+    check_alphabet(token_generator::alphanumeric(), length);
+    check_alphabet(token_generator("0123456789"), length);
+  }
+}
+
+TEST(token_generator, uniform) {
+  for (auto generator : {token_generator::base64url(), token_generator::alphanumeric(), token_generator("abc")}) {
+    const std::size_t length = 100000u;
+    const auto token = generator(length);
+    std::map<char, std::size_t> counts;
+    for (auto i = 0u; i < length; ++i)
+      ++counts[token.data()[i]];
+    ASSERT_EQ(counts.size(), generator.alphabet().size());
+    const double expected = double(length) / generator.alphabet().size();
+    double chi_squared = 0.0;
+    for (auto &pair : counts)
+      chi_squared += (pair.second - expected) * (pair.second - expected) / expected;
+    // Far beyond the 99.99% quantile for 63 degrees of freedom.
+    EXPECT_LT(chi_squared, 140.0) << generator.alphabet();
+  }
+}
+
+TEST(token_generator, map_to_alphabet) {
+  const std::string alphabets[] = {
+    "01", "0123", "0123456789abcdef",
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567",
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"};
+  for (auto &alphabet : alphabets) {
+    std::vector<byte> data(256u + 45u);
+    for (auto i = 0u; i < data.size(); ++i)
+      data[i] = static_cast<byte>(i * 7u);
+    const auto input = data;
+    detail::map_to_alphabet(data.data(), data.size(), alphabet.data(), alphabet.size());
+    for (auto i = 0u; i < data.size(); ++i)
+      ASSERT_EQ(data[i], static_cast<byte>(alphabet[input[i] % alphabet.size()])) << alphabet << " at " << i;
+  }
+}
+
+TEST(token_generator, batch) {
+  auto generator = token_generator::base32();
+  const auto tokens = generator(1000u, 26u);
+  ASSERT_EQ(tokens.size(), 1000u);
+  std::set<std::string> unique;
+  for (auto &token : tokens) {
+    ASSERT_EQ(token.size(), 26u);
+    unique.insert(token.c_str());
+  }
+  EXPECT_EQ(unique.size(), tokens.size());
+  EXPECT_TRUE(generator(0u, 26u).empty());
+  // The size of the batch would wrap around.
+  EXPECT_THROW(generator(std::size_t(1u) << 33, std::size_t(1u) << 31), std::length_error);
+}
+
+TEST(token_generator, fill) {
+  auto token = secure_string::make_zeroed(20u);
+  token_generator::hex().fill(token);
+  EXPECT_EQ(std::string(token.c_str()).size(), 20u);
+  char buffer[16u] = {};
+  token_generator("xyz").fill(buffer_view::make_mutable(buffer, sizeof(buffer)));
+  for (auto c : buffer)
+    EXPECT_TRUE(c == 'x' || c == 'y' || c == 'z');
+}
+
+TEST(token_generator, invalid_alphabet) {
+  EXPECT_THROW(token_generator(""), std::invalid_argument);
+  EXPECT_THROW(token_generator("a"), std::invalid_argument);
+  EXPECT_THROW(token_generator("abca"), std::invalid_argument);
+  EXPECT_THROW(token_generator(std::string(257u, 'a')), std::invalid_argument);
+}
+
+// After fork(), parent and child must not mint the same tokens.
+TEST(token_generator, fork) {
+  const auto generator = token_generator::hex();
+  generator(16u);
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  const auto pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    const auto token = generator(16u);
+    const auto written = write(fds[1], token.data(), token.size());
+    _exit(written == 16 ? 0 : 1);
+  }
+  const auto parent = generator(16u);
+  char child[16u];
+  ASSERT_EQ(read(fds[0], child, sizeof(child)), 16);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  close(fds[0]);
+  close(fds[1]);
+  ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  EXPECT_NE(std::memcmp(parent.data(), child, sizeof(child)), 0);
+}
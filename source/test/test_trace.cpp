@@ -0,0 +1,74 @@
+#include "crypto/crypto.h"
+#include "crypto/entropy.h"
+#include "crypto/trace.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+#if defined(CRYPTO_ENABLE_TRACE) && defined(__linux__)
+#  include <elf.h>
+#endif
+
+using namespace crypto;
+
+TEST(trace, digest_algorithm) {
+  static_assert(trace::digest_algorithm(32u) == trace::sha256, "");
+  static_assert(trace::digest_algorithm(64u) == trace::sha512, "");
+  EXPECT_EQ(trace::unknown, trace::digest_algorithm(20u));
+}
+
+#if defined(CRYPTO_ENABLE_TRACE) && defined(__linux__)
+
+/// "provider:name" of every USDT probe in the .note.stapsdt section of this
+/// executable, what `readelf -n` lists as stapsdt notes.
+static std::set<std::string> usdt_probes() {
+  std::ifstream file("/proc/self/exe", std::ios::binary);
+  const std::vector<char> elf{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  std::set<std::string> probes;
+  if ((elf.size() < sizeof(Elf64_Ehdr)) || (elf[EI_CLASS] != ELFCLASS64)) {
+    return probes;
+  }
+  const auto &header = *reinterpret_cast<const Elf64_Ehdr *>(elf.data());
+  const auto *sections = reinterpret_cast<const Elf64_Shdr *>(elf.data() + header.e_shoff);
+  const auto *names = elf.data() + sections[header.e_shstrndx].sh_offset;
+  for (auto i = 0u; i < header.e_shnum; ++i) {
+    if (std::string(names + sections[i].sh_name) != ".note.stapsdt") {
+      continue;
+    }
+    auto offset = sections[i].sh_offset;
+    const auto end = offset + sections[i].sh_size;
+    while (offset + sizeof(Elf64_Nhdr) <= end) {
+      const auto &note = *reinterpret_cast<const Elf64_Nhdr *>(elf.data() + offset);
+      const auto *desc = elf.data() + offset + sizeof(Elf64_Nhdr) + ((note.n_namesz + 3u) & ~3u);
+      // The probe address, the base address and the semaphore address come
+      // before the provider and the name.
+      const std::string provider(desc + 3u * sizeof(Elf64_Addr));
+      const std::string name(desc + 3u * sizeof(Elf64_Addr) + provider.size() + 1u);
+      probes.insert(provider + ":" + name);
+      offset += sizeof(Elf64_Nhdr) + ((note.n_namesz + 3u) & ~3u) + ((note.n_descsz + 3u) & ~3u);
+    }
+  }
+  return probes;
+}
+
+TEST(trace, probes) {
+  // Links the probes of crypto.cpp and entropy.cpp into the executable.
+  sha256_digest digest;
+  ::crypto::digest(buffer_view::make_const(std::string("probe")), digest);
+  std::uint32_t seed;
+  detail::system_entropy(&seed, 1u);
+  const auto probes = usdt_probes();
+  for (auto probe : {
+           "digest_entry", "digest_return", "zeroize_entry", "zeroize_return",
+           "system_entropy_entry", "system_entropy_return"}) {
+    EXPECT_EQ(1u, probes.count(std::string("crypto:") + probe)) << probe;
+  }
+}
+
+#endif // CRYPTO_ENABLE_TRACE && __linux__
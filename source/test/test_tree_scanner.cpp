@@ -0,0 +1,205 @@
+#include "crypto/tree_scanner.h"
+#include "crypto/output.h"
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace crypto;
+
+/// Temporary directory removed with everything in it.
+class temporary_tree {
+public:
+
+  temporary_tree() {
+    char path[] = "/tmp/crypto_tree_XXXXXX";
+    if (mkdtemp(path) == nullptr) {
+      throw std::runtime_error("cannot create temporary directory");
+    }
+    _root = path;
+  }
+
+  ~temporary_tree() {
+    nftw(_root.c_str(), [](const char *path, const struct stat *, int, struct FTW *) {
+      return std::remove(path);
+    }, 16, FTW_DEPTH | FTW_PHYS);
+  }
+
+  const std::string &root() const {
+    return _root;
+  }
+
+  void make_directory(const std::string &path) const {
+    ASSERT_EQ(0, mkdir((_root + "/" + path).c_str(), 0700));
+  }
+
+  void write(const std::string &path, const std::vector<byte> &data) const {
+    std::ofstream file(_root + "/" + path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+  }
+
+private:
+
+  std::string _root;
+};
+
+static std::vector<byte> random_data(std::size_t size, std::uint64_t seed) {
+  crypto::xoshiro256starstar rng(seed);
+  std::vector<byte> data(size);
+  rng.uniform_n(array_view::make_mutable(data), byte(0u), byte(255u));
+  return data;
+}
+
+/// A tree with files of sizes around the block size, and their digests by
+/// path.
+static std::vector<file_digest> make_tree(const temporary_tree &tree) {
+  for (auto directory : {"a", "a/b", "a/b/c", "empty"}) {
+    tree.make_directory(directory);
+  }
+  const std::vector<std::pair<std::string, std::size_t>> files = {
+      {"zero", 0u},
+      {"one", 1u},
+      {"a/block", 4096u},
+      {"a/block+1", 4097u},
+      {"a/b/large", 300000u},
+      {"a/b/c/d", 12345u}};
+  std::vector<file_digest> expected;
+  auto seed = 0u;
+  for (const auto &file : files) {
+    const auto data = random_data(file.second, ++seed);
+    tree.write(file.first, data);
+    sha256_digest digest;
+    crypto::digest(buffer_view::make_const(data), digest);
+    expected.push_back(file_digest{file.first, file.second, digest});
+  }
+  EXPECT_EQ(0, symlink("one", (tree.root() + "/link").c_str()));
+  std::sort(expected.begin(), expected.end(), [](const file_digest &lhs, const file_digest &rhs) {
+    return lhs.path < rhs.path;
+  });
+  return expected;
+}
+
+TEST(tree_scanner, digests) {
+  const temporary_tree tree;
+  const auto expected = make_tree(tree);
+  for (auto use_io_uring : {true, false}) {
+    for (auto threads : {1u, 3u}) {
+      for (auto queue_depth : {1u, 2u, 64u}) {
+        const tree_scanner scanner(threads, queue_depth, 4096u, use_io_uring);
+        const auto result = scanner(tree.root());
+        EXPECT_EQ(expected, result.files) << use_io_uring << " " << threads << " " << queue_depth;
+        EXPECT_EQ(0u, result.cache_hits);
+        if (!use_io_uring) {
+          EXPECT_FALSE(result.io_uring);
+        }
+      }
+    }
+  }
+}
+
+TEST(tree_scanner, cache) {
+  const temporary_tree tree;
+  const auto expected = make_tree(tree);
+  const tree_scanner scanner(2u, 8u, 4096u);
+  tree_digest_cache cache;
+  EXPECT_EQ(expected, scanner(tree.root(), &cache).files);
+  EXPECT_EQ(expected.size(), cache.size());
+  const auto rescan = scanner(tree.root(), &cache);
+  EXPECT_EQ(expected, rescan.files);
+  EXPECT_EQ(expected.size(), rescan.cache_hits);
+  // A file of another size misses, and a removed one leaves the cache.
+  const auto data = random_data(5000u, 99u);
+  tree.write("a/b/c/d", data);
+  ASSERT_EQ(0, unlink((tree.root() + "/zero").c_str()));
+  const auto modified = scanner(tree.root(), &cache);
+  EXPECT_EQ(expected.size() - 2u, modified.cache_hits);
+  EXPECT_EQ(expected.size() - 1u, cache.size());
+  sha256_digest digest;
+  crypto::digest(buffer_view::make_const(data), digest);
+  ASSERT_EQ(expected.size() - 1u, modified.files.size());
+  EXPECT_EQ((file_digest{"a/b/c/d", 5000u, digest}), modified.files[0u]);
+}
+
+TEST(tree_scanner, manifest) {
+  const temporary_tree tree;
+  const auto expected = make_tree(tree);
+  std::string manifest;
+  for (const auto &file : expected) {
+    manifest += to_hex_string(buffer_view::make_const(file.digest)) + "  " + file.path + "\n";
+  }
+  sha256_digest digest;
+  crypto::digest(buffer_view::make_const(manifest), digest);
+  EXPECT_EQ(digest, manifest_digest(tree_scanner(2u)(tree.root()).files));
+  auto files = expected;
+  files[0u].digest[0u] ^= 1u;
+  EXPECT_NE(digest, manifest_digest(files));
+}
+
+static std::size_t open_files() {
+  std::size_t count = 0u;
+  if (auto *dir = opendir("/proc/self/fd")) {
+    while (readdir(dir) != nullptr) {
+      ++count;
+    }
+    closedir(dir);
+  }
+  return count;
+}
+
+TEST(tree_scanner, error_with_reads_in_flight) {
+  const temporary_tree tree;
+  for (auto i = 0u; i < 24u; ++i) {
+    tree.write("file" + std::to_string(i), random_data(1u << 20, i));
+  }
+  // The walk opens directories by path and stats files relative to them, but
+  // the full path of the last file is too long to open, failing it after the
+  // other files sorted before it are being read.
+  const std::string directory(240u, 'z');
+  auto fd = open(tree.root().c_str(), O_RDONLY | O_DIRECTORY);
+  for (auto i = 0u; i < 16u; ++i) {
+    ASSERT_EQ(0, mkdirat(fd, directory.c_str(), 0700));
+    const auto next = openat(fd, directory.c_str(), O_RDONLY | O_DIRECTORY);
+    close(fd);
+    fd = next;
+  }
+  const std::string name(250u, 'z');
+  const auto file = openat(fd, name.c_str(), O_WRONLY | O_CREAT, 0600);
+  ASSERT_LE(0, file);
+  ASSERT_EQ(1, write(file, "z", 1u));
+  close(file);
+
+  const auto files = open_files();
+  for (auto use_io_uring : {true, false}) {
+    for (auto threads : {1u, 3u}) {
+      const tree_scanner scanner(threads, 16u, 4096u, use_io_uring);
+      try {
+        scanner(tree.root());
+        ADD_FAILURE() << "no error, " << use_io_uring << " " << threads;
+      } catch (const std::runtime_error &e) {
+        EXPECT_EQ(0, std::string(e.what()).find("cannot open file")) << e.what();
+      }
+      EXPECT_EQ(files, open_files());
+    }
+  }
+  EXPECT_EQ(0, unlinkat(fd, name.c_str(), 0));
+  close(fd);
+}
+
+TEST(tree_scanner, errors) {
+  EXPECT_THROW(tree_scanner(1u, 0u), std::invalid_argument);
+  EXPECT_THROW(tree_scanner(1u, 8u, 100u), std::invalid_argument);
+  EXPECT_THROW(tree_scanner()("/nonexistent/crypto_tree"), std::runtime_error);
+}
@@ -0,0 +1,120 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+using namespace crypto;
+
+// Computes the characteristic polynomial of the engine's linear transition
+// with Berlekamp-Massey, then x^(2^power) modulo it. The result must match
+// the engine's jump polynomial.
+template <typename ENGINE, std::size_t DEGREE>
+static std::bitset<DEGREE> jump_polynomial(unsigned power) {
+  ENGINE engine(12345u);
+  std::vector<int> s;
+  for (auto i = 0u; i < 2u * DEGREE; ++i) {
+    s.push_back(static_cast<int>(engine.state()[0u] & 1u));
+    engine();
+  }
+  // Berlekamp-Massey over GF(2).
+  std::vector<int> c(s.size() + 1u, 0), b(s.size() + 1u, 0);
+  c[0u] = b[0u] = 1;
+  std::size_t l = 0u, m = 1u;
+  for (std::size_t n = 0u; n < s.size(); ++n) {
+    int d = s[n];
+    for (std::size_t i = 1u; i <= l; ++i)
+      d ^= c[i] & s[n - i];
+    if (d == 0) {
+      ++m;
+    } else if (2u * l <= n) {
+      auto t = c;
+      for (std::size_t i = 0u; i + m < c.size(); ++i)
+        c[i + m] ^= b[i];
+      l = n + 1u - l;
+      b = t;
+      m = 1u;
+    } else {
+      for (std::size_t i = 0u; i + m < c.size(); ++i)
+        c[i + m] ^= b[i];
+      ++m;
+    }
+  }
+  EXPECT_EQ(l, DEGREE);
+  // Characteristic polynomial p(x) = x^L + c1 x^(L-1) + ... + cL.
+  std::bitset<2u * DEGREE> p;
+  for (std::size_t i = 0u; i <= l; ++i)
+    p[l - i] = c[i];
+  std::bitset<2u * DEGREE> x;
+  x[1u] = 1;
+  for (auto k = 0u; k < power; ++k) {
+    std::bitset<2u * DEGREE> square;
+    for (std::size_t i = 0u; i < DEGREE; ++i)
+      square[2u * i] = x[i];
+    for (std::size_t i = 2u * DEGREE - 1u; i >= DEGREE; --i)
+      if (square[i])
+        square ^= (p << (i - DEGREE));
+    x = square;
+  }
+  std::bitset<DEGREE> result;
+  for (std::size_t i = 0u; i < DEGREE; ++i)
+    result[i] = x[i];
+  return result;
+}
+
+template <std::size_t DEGREE, std::size_t N>
+static std::bitset<DEGREE> to_bitset(const std::array<std::uint64_t, N> &words) {
+  std::bitset<DEGREE> result;
+  for (std::size_t i = 0u; i < DEGREE; ++i)
+    result[i] = (words[i / 64u] >> (i % 64u)) & 1u;
+  return result;
+}
+
+TEST(xoshiro, reference) {
+  xoshiro256starstar_engine engine(xoshiro256starstar_engine::state_type{{1u, 2u, 3u, 4u}});
+  EXPECT_EQ(engine(), 11520u);
+  EXPECT_EQ(engine(), 0u);
+  EXPECT_EQ(engine(), 1509978240u);
+  EXPECT_EQ(engine(), 1215971899390074240u);
+  xoroshiro128plus_engine engine2(xoroshiro128plus_engine::state_type{{1u, 2u}});
+  EXPECT_EQ(engine2(), 3u);
+}
+
+TEST(xoshiro, jump_polynomials) {
+  using namespace crypto::detail;
+  EXPECT_EQ(
+      (jump_polynomial<xoshiro256starstar_engine, 256u>(128u)),
+      to_bitset<256u>(xoshiro256starstar_generator::jump_polynomial()));
+  EXPECT_EQ(
+      (jump_polynomial<xoshiro256starstar_engine, 256u>(192u)),
+      to_bitset<256u>(xoshiro256starstar_generator::long_jump_polynomial()));
+  EXPECT_EQ(
+      (jump_polynomial<xoroshiro128plus_engine, 128u>(64u)),
+      to_bitset<128u>(xoroshiro128plus_generator::jump_polynomial()));
+  EXPECT_EQ(
+      (jump_polynomial<xoroshiro128plus_engine, 128u>(96u)),
+      to_bitset<128u>(xoroshiro128plus_generator::long_jump_polynomial()));
+}
+
+TEST(xoshiro, jump) {
+  crypto::xoshiro256starstar rng0;
+  auto rng1 = rng0;
+  rng1.jump();
+  EXPECT_NE(rng0.engine().engine(), rng1.engine().engine());
+  auto rng2 = rng1;
+  rng2.long_jump();
+  EXPECT_NE(rng1.engine().engine(), rng2.engine().engine());
+  xoroshiro128plus_engine engine0(7u);
+  auto engine1 = engine0;
+  engine1.discard(1000u);
+  for (auto i = 0u; i < 1000u; ++i)
+    engine0();
+  EXPECT_EQ(engine0, engine1);
+}
+
+TEST(xoshiro, zero_state) {
+  xoshiro256starstar_engine engine(xoshiro256starstar_engine::state_type{{0u, 0u, 0u, 0u}});
+  EXPECT_EQ(engine, xoshiro256starstar_engine());
+}
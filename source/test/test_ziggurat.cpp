@@ -0,0 +1,131 @@
+#include "crypto/random.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace crypto;
+
+static void check_table(const detail::ziggurat_table &table, double area, double (*f)(double)) {
+  constexpr double scale = 4503599627370496.0;
+  // The recursion of the layers must close at the top, the last layer has
+  // the same area as every other.
+  const auto x1 = table.w[1u] * scale;
+  EXPECT_NEAR(x1 * (1.0 - f(x1)), area, 1e-9);
+  EXPECT_DOUBLE_EQ(table.w[255u] * scale, table.r);
+  for (auto i = 2u; i < 256u; ++i) {
+    ASSERT_LT(table.w[i - 1u], table.w[i]);
+    ASSERT_GT(table.f[i - 1u], table.f[i]);
+    ASSERT_LT(table.k[i], std::uint64_t(1u) << 52);
+  }
+}
+
+TEST(ziggurat, tables) {
+  check_table(detail::normal_ziggurat(), 0.00492867323399, [](double x) { return std::exp(-0.5 * x * x); });
+  check_table(detail::exponential_ziggurat(), 0.0039496598225815571993, [](double x) { return std::exp(-x); });
+}
+
+template <typename T>
+static void moments(const std::vector<T> &values, double &mean, double &variance) {
+  mean = 0.0;
+  for (auto value : values)
+    mean += value;
+  mean /= values.size();
+  variance = 0.0;
+  for (auto value : values)
+    variance += (value - mean) * (value - mean);
+  variance /= values.size() - 1u;
+}
+
+TEST(ziggurat, normal_distribution) {
+  crypto::xoshiro256starstar rng;
+  std::vector<double> values(2000000u);
+  rng.normal_n(array_view::make_mutable(values));
+  double mean, variance;
+  moments(values, mean, variance);
+  EXPECT_NEAR(mean, 0.0, 0.005);
+  EXPECT_NEAR(variance, 1.0, 0.005);
+  // Compare the histogram with the cumulative distribution function, the
+  // tails included.
+  const double edges[] = {-4.0, -3.0, -2.0, -1.0, -0.5, 0.0, 0.5, 1.0, 2.0, 3.0, 4.0};
+  auto cdf = [](double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+  for (auto i = 0u; i + 1u < sizeof(edges) / sizeof(edges[0u]); ++i) {
+    std::size_t count = 0u;
+    for (auto value : values)
+      count += (value >= edges[i] && value < edges[i + 1u]) ? 1u : 0u;
+    const auto p = cdf(edges[i + 1u]) - cdf(edges[i]);
+    const auto sigma = std::sqrt(values.size() * p * (1.0 - p));
+    EXPECT_NEAR(count, values.size() * p, 5.0 * sigma) << "at " << edges[i];
+  }
+  std::size_t tail = 0u;
+  for (auto value : values)
+    tail += std::abs(value) > 4.0 ? 1u : 0u;
+  const auto p = 2.0 * cdf(-4.0);
+  EXPECT_NEAR(tail, values.size() * p, 5.0 * std::sqrt(values.size() * p));
+}
+
+TEST(ziggurat, exponential_distribution) {
+  crypto::pcg64 rng;
+  std::vector<double> values(2000000u);
+  rng.exponential_n(array_view::make_mutable(values), 2.0);
+  double mean, variance;
+  moments(values, mean, variance);
+  EXPECT_NEAR(mean, 0.5, 0.002);
+  EXPECT_NEAR(variance, 0.25, 0.002);
+  const double edges[] = {0.0, 0.25, 0.5, 1.0, 2.0, 3.0, 4.0, 8.0};
+  for (auto i = 0u; i + 1u < sizeof(edges) / sizeof(edges[0u]); ++i) {
+    std::size_t count = 0u;
+    for (auto value : values)
+      count += (value >= edges[i] && value < edges[i + 1u]) ? 1u : 0u;
+    const auto p = std::exp(-2.0 * edges[i]) - std::exp(-2.0 * edges[i + 1u]);
+    const auto sigma = std::sqrt(values.size() * p * (1.0 - p));
+    EXPECT_NEAR(count, values.size() * p, 5.0 * sigma + 1.0) << "at " << edges[i];
+  }
+}
+
+template <typename RNG>
+static void check_batch() {
+  std::seed_seq seed{1, 2, 3};
+  RNG rng0(seed);
+  RNG rng1(seed);
+  std::vector<double> values(5001u);
+  rng0.normal_n(array_view::make_mutable(values), 1.0, 3.0);
+  for (auto value : values)
+    ASSERT_EQ(value, rng1.normal(1.0, 3.0));
+  rng0.exponential_n(array_view::make_mutable(values), 0.5);
+  for (auto value : values)
+    ASSERT_EQ(value, rng1.exponential(0.5));
+  std::vector<float> floats(999u);
+  rng0.normal_n(array_view::make_mutable(floats));
+  for (auto value : floats)
+    ASSERT_EQ(value, rng1.template normal<float>());
+  ASSERT_EQ(rng0(), rng1());
+}
+
+TEST(ziggurat, batch_matches_scalar) {
+  check_batch<crypto::mt19937>();
+  check_batch<crypto::xoshiro256starstar>();
+  check_batch<crypto::chacha8>();
+  check_batch<crypto::random_engine_adaptor<std::ranlux48>>();
+}
+
+template <typename SAMPLER>
+static void check_moments(SAMPLER sampler, double mean, double variance, double tolerance) {
+  crypto::xoroshiro128plus rng;
+  std::vector<typename SAMPLER::result_type> values(1000000u);
+  sampler.generate(rng, array_view::make_mutable(values));
+  double m, v;
+  moments(values, m, v);
+  EXPECT_NEAR(m, mean, tolerance * std::sqrt(variance));
+  EXPECT_NEAR(v, variance, 5.0 * tolerance * variance);
+}
+
+TEST(ziggurat, derived_distributions) {
+  check_moments(gamma_sampler<>(3.0, 0.5), 1.5, 0.75, 0.01);
+  check_moments(gamma_sampler<>(0.4, 2.0), 0.8, 1.6, 0.01);
+  check_moments(chi_squared_sampler<>(7.0), 7.0, 14.0, 0.01);
+  check_moments(student_t_sampler<>(10.0), 0.0, 1.25, 0.01);
+  check_moments(lognormal_sampler<>(0.5, 0.25), std::exp(0.5 + 0.03125), (std::exp(0.0625) - 1.0) * std::exp(1.0 + 0.0625), 0.01);
+  check_moments(exponential_sampler<float>(4.0f), 0.25, 0.0625, 0.01);
+}
@@ -0,0 +1,366 @@
+#include "crypto/random.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#  include <fcntl.h>
+#  include <io.h>
+#endif
+
+// Writes the raw output of an engine to stdout, for piping it into external
+// test batteries (e.g. `crypto_rngstream xoshiro256starstar | RNG_test stdin64`)
+// or measuring its throughput (`crypto_rngstream chacha8 --bytes 10G > /dev/null`).
+//
+// Values are written as native-endian 32 or 64-bit words, as wide as the
+// output of the engine.
+// With several threads every thread generates its own substream and blocks
+// are written in round-robin order, so the output only depends on the
+// engine, the seed, the number of threads and the block size.
+
+namespace {
+
+  const char *const usage =
+      "usage: crypto_rngstream <engine> [options]\n"
+      "\n"
+      "Writes the raw output of <engine> to stdout and its throughput to stderr.\n"
+      "\n"
+      "  --seed N      seed, expanded with SplitMix64 (default 0)\n"
+      "  --threads N   threads generating independent substreams (default 1)\n"
+      "  --bytes N     stop after N bytes, with an optional K, M, G or T suffix\n"
+      "                (default: until stdout is closed)\n"
+      "  --block N     bytes per block (default 1M)\n"
+      "  --report S    report the throughput every S seconds (default: at exit)\n"
+      "  --list        list the engines\n";
+
+  struct options {
+    std::string engine;
+    std::uint64_t seed = 0u;
+    unsigned threads = 1u;
+    std::uint64_t bytes = 0u;
+    std::size_t block = 1u << 20;
+    double report = 0.0;
+  };
+
+  std::uint64_t parse_size(const std::string &text) {
+    std::size_t end = 0u;
+    auto value = std::stoull(text, &end, 0);
+    if (end + 1u == text.size()) {
+      const auto shift = std::string("KMGT").find(static_cast<char>(std::toupper(text[end])));
+      if (shift == std::string::npos) {
+        throw std::invalid_argument("invalid size " + text);
+      }
+      const auto bits = 10u * (shift + 1u);
+      if (value > (std::numeric_limits<std::uint64_t>::max() >> bits)) {
+        throw std::invalid_argument("size too large " + text);
+      }
+      value <<= bits;
+    } else if (end != text.size()) {
+      throw std::invalid_argument("invalid size " + text);
+    }
+    return value;
+  }
+
+  // -- Substreams --------------------------------------------------------------
+
+  template <typename ENGINE, typename = void>
+  struct has_set_stream : std::false_type {};
+
+  template <typename ENGINE>
+  struct has_set_stream<ENGINE, decltype(std::declval<ENGINE &>().set_stream(0u))> : std::true_type {};
+
+  template <typename ENGINE, typename = void>
+  struct has_jump : std::false_type {};
+
+  template <typename ENGINE>
+  struct has_jump<ENGINE, decltype(std::declval<ENGINE &>().jump())> : std::true_type {};
+
+  /// Stream @a index of counter-based engines, e.g. chacha8_engine.
+  template <typename ENGINE>
+  ENGINE make_substream(std::uint64_t seed, unsigned index, std::true_type, std::false_type) {
+    crypto::detail::splitmix_seed_seq seq(seed);
+    ENGINE engine(seq);
+    engine.set_stream(index);
+    return engine;
+  }
+
+  /// @a index jumps ahead for jumpable engines, e.g. xoshiro256starstar_engine.
+  template <typename ENGINE>
+  ENGINE make_substream(std::uint64_t seed, unsigned index, std::false_type, std::true_type) {
+    crypto::detail::splitmix_seed_seq seq(seed);
+    ENGINE engine(seq);
+    for (auto i = 0u; i < index; ++i) {
+      engine.jump();
+    }
+    return engine;
+  }
+
+  /// Independent seeds for the rest, e.g. std::mt19937.
+  template <typename ENGINE>
+  ENGINE make_substream(std::uint64_t seed, unsigned index, std::false_type, std::false_type) {
+    crypto::detail::splitmix_seed_seq seq(seed + index);
+    return ENGINE(seq);
+  }
+
+  template <typename ENGINE>
+  ENGINE make_substream(std::uint64_t seed, unsigned index) {
+    return make_substream<ENGINE>(seed, index, has_set_stream<ENGINE>{},
+        std::integral_constant<bool, has_jump<ENGINE>::value && !has_set_stream<ENGINE>::value>{});
+  }
+
+  // -- Generation --------------------------------------------------------------
+
+  /// Word written for every value, e.g. 32 bits for std::mt19937 whose
+  /// result_type is wider than its output.
+  template <typename ENGINE>
+  using word_type = std::conditional_t<ENGINE::max() == 0xffffffffu, std::uint32_t, std::uint64_t>;
+
+  template <typename ENGINE, typename WORD>
+  void fill(ENGINE &engine, WORD *first, WORD *last, std::true_type) {
+    engine.generate(first, last);
+  }
+
+  template <typename ENGINE, typename WORD>
+  void fill(ENGINE &engine, WORD *first, WORD *last, std::false_type) {
+    for (; first != last; ++first) {
+      *first = static_cast<WORD>(engine());
+    }
+  }
+
+  /// A block of every thread, written in turn. Two slots per thread let the
+  /// threads fill the next block while the current one is written.
+  struct slot {
+    std::vector<unsigned char> data;
+    bool ready = false;
+  };
+
+  struct pipeline {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<slot> slots;
+    bool stop = false;
+  };
+
+  template <typename ENGINE>
+  void generate(pipeline &p, const options &opt, unsigned index) {
+    using word = word_type<ENGINE>;
+    using bulk = std::integral_constant<bool,
+        crypto::detail::has_bulk_generate<ENGINE>::value && std::is_same<typename ENGINE::result_type, word>::value>;
+    auto engine = make_substream<ENGINE>(opt.seed, index);
+    for (std::size_t round = 0u;; ++round) {
+      auto &s = p.slots[2u * index + round % 2u];
+      {
+        std::unique_lock<std::mutex> lock(p.mutex);
+        p.changed.wait(lock, [&]() { return p.stop || !s.ready; });
+        if (p.stop) {
+          return;
+        }
+      }
+      auto *first = reinterpret_cast<word *>(s.data.data());
+      fill(engine, first, first + s.data.size() / sizeof(word), bulk{});
+      {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        s.ready = true;
+      }
+      p.changed.notify_all();
+    }
+  }
+
+  class throughput {
+  public:
+
+    using clock = std::chrono::steady_clock;
+
+    explicit throughput(const options &opt)
+      : _opt(opt),
+        _start(clock::now()),
+        _last(_start) {}
+
+    void add(std::uint64_t bytes) {
+      _bytes += bytes;
+      if (_opt.report > 0.0) {
+        const auto now = clock::now();
+        if (std::chrono::duration<double>(now - _last).count() >= _opt.report) {
+          print(now);
+          _last = now;
+        }
+      }
+    }
+
+    void print(clock::time_point now = clock::now()) const {
+      const auto seconds = std::chrono::duration<double>(now - _start).count();
+      std::fprintf(stderr, "crypto_rngstream: %s, %u thread%s: %llu bytes in %.3f s, %.3f GB/s\n",
+          _opt.engine.c_str(), _opt.threads, (_opt.threads == 1u) ? "" : "s",
+          static_cast<unsigned long long>(_bytes), seconds,
+          (seconds > 0.0) ? static_cast<double>(_bytes) / seconds / 1e9 : 0.0);
+    }
+
+  private:
+
+    const options &_opt;
+
+    clock::time_point _start;
+
+    clock::time_point _last;
+
+    std::uint64_t _bytes = 0u;
+  };
+
+  template <typename ENGINE>
+  int run(const options &opt) {
+    using word = word_type<ENGINE>;
+    static_assert(ENGINE::min() == 0u && ENGINE::max() == std::numeric_limits<word>::max(),
+        "the raw output of the engine must be 32 or 64 random bits");
+    pipeline p;
+    p.slots.resize(2u * opt.threads);
+    const auto block = std::max<std::size_t>(opt.block / sizeof(word), 1u) * sizeof(word);
+    for (auto &s : p.slots) {
+      s.data.resize(block);
+    }
+    std::vector<std::thread> threads;
+    for (auto i = 0u; i < opt.threads; ++i) {
+      threads.emplace_back(generate<ENGINE>, std::ref(p), std::cref(opt), i);
+    }
+    throughput meter(opt);
+    std::uint64_t written = 0u;
+    bool closed = false;
+    for (std::size_t round = 0u; !closed && (opt.bytes == 0u || written < opt.bytes); ++round) {
+      // Round k of thread t is block k * threads + t.
+      auto &s = p.slots[2u * (round % opt.threads) + (round / opt.threads) % 2u];
+      {
+        std::unique_lock<std::mutex> lock(p.mutex);
+        p.changed.wait(lock, [&]() { return s.ready; });
+      }
+      auto size = s.data.size();
+      if (opt.bytes != 0u && opt.bytes - written < size) {
+        size = static_cast<std::size_t>(opt.bytes - written);
+      }
+      const auto n = std::fwrite(s.data.data(), 1u, size, stdout);
+      closed = (n != size) || (std::fflush(stdout) != 0);
+      written += n;
+      meter.add(n);
+      {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        s.ready = false;
+      }
+      p.changed.notify_all();
+    }
+    {
+      std::lock_guard<std::mutex> lock(p.mutex);
+      p.stop = true;
+    }
+    p.changed.notify_all();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    meter.print();
+    // A closed pipe is the normal end of a test battery.
+    return 0;
+  }
+
+  using runner = std::function<int(const options &)>;
+
+  const std::map<std::string, runner> &engines() {
+    static const std::map<std::string, runner> result = {
+      {"mt19937",            run<std::mt19937>},
+      {"mt19937_64",         run<std::mt19937_64>},
+      {"xoshiro256starstar", run<crypto::xoshiro256starstar_engine>},
+      {"xoroshiro128plus",   run<crypto::xoroshiro128plus_engine>},
+      {"pcg64",              run<crypto::pcg64_engine>},
+      {"chacha8",            run<crypto::chacha8_engine>},
+      {"chacha12",           run<crypto::chacha12_engine>},
+      {"chacha20",           run<crypto::chacha20_engine>},
+      {"philox4x32",         run<crypto::philox4x32_engine>},
+      {"threefry4x64",       run<crypto::threefry4x64_engine>},
+      {"sfmt19937",          run<crypto::sfmt19937_engine>},
+      {"dsfmt19937",         run<crypto::dsfmt19937_engine>},
+    };
+    return result;
+  }
+
+  options parse(int argc, char *argv[]) {
+    options opt;
+    for (auto i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      auto value = [&]() -> std::string {
+        if (i + 1 >= argc) {
+          throw std::invalid_argument("missing value of " + arg);
+        }
+        return argv[++i];
+      };
+      if (arg == "--seed") {
+        opt.seed = std::stoull(value(), nullptr, 0);
+      } else if (arg == "--threads") {
+        opt.threads = static_cast<unsigned>(std::stoul(value()));
+        if (opt.threads == 0u) {
+          throw std::invalid_argument("at least one thread is needed");
+        }
+      } else if (arg == "--bytes") {
+        opt.bytes = parse_size(value());
+      } else if (arg == "--block") {
+        opt.block = static_cast<std::size_t>(parse_size(value()));
+      } else if (arg == "--report") {
+        opt.report = std::stod(value());
+      } else if (arg.compare(0u, 2u, "--") == 0 || !opt.engine.empty()) {
+        throw std::invalid_argument("unexpected argument " + arg);
+      } else {
+        opt.engine = arg;
+      }
+    }
+    return opt;
+  }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  for (auto i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--list") == 0) {
+      for (const auto &engine : engines()) {
+        std::printf("%s\n", engine.first.c_str());
+      }
+      return 0;
+    }
+    if (std::strcmp(argv[i], "--help") == 0) {
+      std::printf("%s", usage);
+      return 0;
+    }
+  }
+  options opt;
+  try {
+    opt = parse(argc, argv);
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "crypto_rngstream: %s\n\n%s", e.what(), usage);
+    return 2;
+  }
+  const auto engine = engines().find(opt.engine);
+  if (engine == engines().end()) {
+    std::fprintf(stderr, "crypto_rngstream: unknown engine \"%s\", see --list\n", opt.engine.c_str());
+    return 2;
+  }
+#ifdef SIGPIPE
+  // Test batteries close the pipe when they are done; fwrite fails instead.
+  std::signal(SIGPIPE, SIG_IGN);
+#endif
+#ifdef _WIN32
+  _setmode(_fileno(stdout), _O_BINARY);
+#endif
+  return engine->second(opt);
+}